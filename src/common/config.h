@@ -32,8 +32,19 @@ static constexpr int INVALID_TIMESTAMP = -1;                                  //
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
-static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
+static constexpr int BUFFER_POOL_SIZE = 65536;                                // default size of buffer pool 256MB, rmdb -b overrides it
+static constexpr bool BUFFER_POOL_HUGE_PAGES = true;                          // back buffer pool frames with huge pages if possible
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;                     // size of a huge page 2MB
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
+static constexpr int BUFFER_POOL_SHARDS = 16;                                 // number of buffer pool shards
+static constexpr int BUFFER_SCAN_RING_SIZE = 32;                              // ring size of sequential scans 128KB
+static constexpr int BUFFER_BULK_RING_SIZE = 2048;                            // ring size of bulk loads 8MB
+static constexpr int READ_AHEAD_PAGES = 32;                                   // pages read ahead by sequential scans
+static constexpr size_t PREFETCH_QUEUE_SIZE = 64;                             // max pending prefetch requests
+static constexpr double BUFFER_FLUSH_CLEAN_RATIO = 0.1;                       // fraction of frames kept clean by the flusher
+static constexpr int BUFFER_FLUSH_INTERVAL_MS = 100;                          // flusher wakes up at least this often
+static constexpr size_t BUFFER_DIRTY_VICTIM_SKIP = 8;                         // dirty victims skipped before writing inline
+static constexpr int COMPRESSED_SECTOR_SIZE = 256;                            // space of compressed pages is allocated in sectors
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
 
@@ -48,7 +59,17 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
 
-// replacer
+// replacer: "LRU", "CLOCK" or "LRU-K"
 static const std::string REPLACER_TYPE = "LRU";
+static constexpr size_t LRUK_REPLACER_K = 2;
+
+// 缓冲池缺页读和脏页写回使用的异步I/O: "NONE"(同步读写), "IO_URING" 或 "THREAD_POOL"
+// 编译时没有找到liburing则"IO_URING"退化为"THREAD_POOL"
+static constexpr char ASYNC_IO_TYPE[] = "NONE";  // constexpr: DiskManager may be constructed during static initialization
+static constexpr size_t ASYNC_IO_THREADS = 8;                                 // I/O threads of the thread pool backend
+static constexpr unsigned IO_URING_QUEUE_DEPTH = 256;                         // max in-flight io_uring requests
+
+// page map of a compressed data file, named after the data file
+static const std::string COMPRESSED_PAGE_MAP_SUFFIX = ".pmap";
 
 static const std::string DB_META_NAME = "db.meta";
@@ -13,6 +13,9 @@ public:
     // Acquire a read latch.
     void RLock() { mutex_.lock_shared(); }
 
+    // Try to acquire a read latch without blocking.
+    bool TryRLock() { return mutex_.try_lock_shared(); }
+
     // Release a read latch.
     void RUnlock() { mutex_.unlock_shared(); }
 
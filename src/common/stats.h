@@ -0,0 +1,113 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @description: 统计计数器，多个线程可以无锁地并发累加，读取到的是某一时刻的近似值
+ */
+class StatCounter {
+   public:
+    StatCounter() = default;
+
+    StatCounter(const StatCounter &other) : value_(other.get()) {}
+
+    StatCounter &operator=(const StatCounter &other) {
+        value_.store(other.get(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    inline void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+    inline uint64_t get() const { return value_.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @description: 延迟直方图，第i个桶统计落在[2^i, 2^(i+1))纳秒内的样本，可以被多个线程无锁地并发记录
+ */
+class LatencyHistogram {
+   public:
+    static constexpr int NUM_BUCKETS = 40;
+
+    /**
+     * @description: 记录一个样本
+     * @param {uint64_t} ns 延迟，单位纳秒
+     */
+    void record(uint64_t ns) {
+        int bucket = 63 - __builtin_clzll(ns | 1);
+        buckets_[bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    uint64_t average() const {
+        uint64_t count = this->count();
+        return count == 0 ? 0 : sum_ns_.load(std::memory_order_relaxed) / count;
+    }
+
+    /**
+     * @description: 估计分位数
+     * @return {uint64_t} 分位数所在桶的上界，单位纳秒，没有样本时返回0
+     * @param {double} p 分位数，取值(0, 1]
+     */
+    uint64_t percentile(double p) const {
+        uint64_t total = 0;
+        for (auto &bucket : buckets_) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p * total + 0.5);
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank && seen > 0) {
+                return (static_cast<uint64_t>(1) << (i + 1)) - 1;
+            }
+        }
+        return (static_cast<uint64_t>(1) << NUM_BUCKETS) - 1;
+    }
+
+   private:
+    std::atomic<uint64_t> buckets_[NUM_BUCKETS]{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+};
+
+/**
+ * @description: 在作用域结束时把经过的时间记录到直方图中
+ */
+class LatencyTimer {
+   public:
+    explicit LatencyTimer(LatencyHistogram &histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~LatencyTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        histogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    LatencyTimer(const LatencyTimer &) = delete;
+    LatencyTimer &operator=(const LatencyTimer &) = delete;
+
+   private:
+    LatencyHistogram &histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
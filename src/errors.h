@@ -71,6 +71,23 @@ class InvalidRecordSizeError : public RMDBError {
     InvalidRecordSizeError(int record_size) : RMDBError("Invalid record size: " + std::to_string(record_size)) {}
 };
 
+class InvalidTableFormatError : public RMDBError {
+   public:
+    InvalidTableFormatError(const std::string &format) : RMDBError("Invalid table format: " + format) {}
+};
+
+class InvalidTableCompressionError : public RMDBError {
+   public:
+    InvalidTableCompressionError(const std::string &compression)
+        : RMDBError("Invalid table compression: " + compression) {}
+};
+
+class InvalidFillFactorError : public RMDBError {
+   public:
+    InvalidFillFactorError(int fill_factor)
+        : RMDBError("Invalid index fill factor: " + std::to_string(fill_factor) + ", expecting 1 to 100") {}
+};
+
 // IX errors
 class InvalidColLengthError : public RMDBError {
    public:
@@ -149,6 +166,15 @@ class IncompatibleTypeError : public RMDBError {
         : RMDBError("Incompatible type error: lhs " + lhs + ", rhs " + rhs) {}
 };
 
+class LoadDataError : public RMDBError {
+   public:
+    LoadDataError(const std::string &file_name, const std::string &msg)
+        : RMDBError("Load data failed: " + file_name + ": " + msg) {}
+
+    LoadDataError(const std::string &file_name, int line_no, const std::string &msg)
+        : RMDBError("Load data failed: " + file_name + ":" + std::to_string(line_no) + ": " + msg) {}
+};
+
 class AmbiguousColumnError : public RMDBError {
    public:
     AmbiguousColumnError(const std::string &col_name) : RMDBError("Ambiguous column: " + col_name) {}
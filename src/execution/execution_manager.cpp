@@ -24,13 +24,16 @@ See the Mulan PSL v2 for more details. */
 const char *help_info = "Supported SQL syntax:\n"
                    "  command ;\n"
                    "command:\n"
-                   "  CREATE TABLE table_name (column_name type [, column_name type ...])\n"
+                   "  CREATE TABLE table_name (column_name type [, column_name type ...]) [FORMAT = {FIXED | SLOTTED | PAX}]\n"
+                   "      [COMPRESSION = {NONE | LZ}]\n"
                    "  SHOW TABLES\n"
                    "  DROP TABLE table_name\n"
                    "  SHOW INDEX FROM table_name\n"
+                   "  SHOW BUFFER STATS\n"
                    "  CREATE INDEX table_name (column_name)\n"
                    "  DROP INDEX table_name (column_name)\n"
                    "  INSERT INTO table_name VALUES (value [, value ...])\n"
+                   "  LOAD 'file_name' INTO table_name\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
@@ -47,13 +50,13 @@ const char *help_info = "Supported SQL syntax:\n"
                    "selector:\n"
                    "  {* | column [, column ...]}\n";
 
-// 主要负责执行DDL语句
+// 主要负责执行DDL语句和load语句
 void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
     if (auto x = std::dynamic_pointer_cast<DDLPlan>(plan)) {
         switch(x->tag) {
             case T_CreateTable:
             {
-                sm_manager_->create_table(x->tab_name_, x->cols_, context);
+                sm_manager_->create_table(x->tab_name_, x->cols_, context, x->format_, x->compressed_);
                 break;
             }
             case T_DropTable:
@@ -63,7 +66,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
             }
             case T_CreateIndex:
             {
-                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context);
+                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context, x->fill_factor_);
                 break;
             }
             case T_DropIndex:
@@ -75,10 +78,12 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
                 throw InternalError("Unexpected field type");
                 break;  
         }
+    } else if (auto x = std::dynamic_pointer_cast<LoadPlan>(plan)) {
+        sm_manager_->load_data(x->file_name_, x->tab_name_, context);
     }
 }
 
-// 执行help; show tables; show index; desc table; begin; commit; abort;语句
+// 执行help; show tables; show index; show buffer stats; desc table; begin; commit; abort;语句
 void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Context *context) {
     if (auto x = std::dynamic_pointer_cast<OtherPlan>(plan)) {
         switch(x->tag) {
@@ -100,6 +105,11 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->show_index(x->tab_name_, context);
                 break;
             }
+            case T_ShowBufferStats:
+            {
+                sm_manager_->show_buffer_stats(context);
+                break;
+            }
             case T_Transaction_begin:
             {
                 // 显示开启一个事务
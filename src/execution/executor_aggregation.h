@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
+#include "executor_seq_scan.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
@@ -24,8 +25,11 @@ private:
     std::vector<AggType> types_;                // 聚合类型
     bool end_;
     size_t len_;
-    std::vector<RmRecord> recs_;
-    int cnt_max_; // count(*) 缓存
+    std::vector<std::vector<char>> values_;     // SUM/MAX/MIN的当前值
+    std::vector<int> counts_;                   // COUNT(col)的当前值
+    // 输入的记录数，即count(*)。字符串列为空的记录也计入，与原来按各列非空值个数取最大值的结果相同：
+    // 原来按列的定长构造字符串，每一列都不为空
+    int num_rows_;
 
 public:
     AggregationExecutor(std::unique_ptr<AbstractExecutor> prev, std::vector<TabCol> sel_cols, std::vector<AggType> types) {
@@ -35,22 +39,34 @@ public:
         types_ = std::move(types);
         end_ = false;
         // len_ = prev_->tupleLen();
+        len_ = 0;
         for (size_t i = 0; i < sel_cols_.size(); ++i) {
             if (types_[i] == T_COUNT) {
                 len_ += sizeof(int);
             } else {
                 len_ += sel_cols_[i].len;
             }
+            // MIN初始化为最大值
+            values_.emplace_back(sel_cols_[i].len, types_[i] == T_MIN ? 127 : 0);
         }
-        cnt_max_ = -1;
+        counts_.assign(sel_cols_.size(), 0);
+        num_rows_ = 0;
     }
 
     void beginTuple() override {
-        // get all rec.
+        // 边读边聚合，不缓存输入的记录
+        if (scan_pax_columns()) {
+            return;
+        }
         prev_->beginTuple();
         while (!prev_->is_end()) {
             auto tuple = prev_->Next();
-            recs_.emplace_back(*tuple);
+            num_rows_++;
+            for (size_t i = 0; i < sel_cols_.size(); ++i) {
+                if (!is_count_star(i)) {
+                    accumulate(i, tuple->data + sel_cols_[i].offset);
+                }
+            }
             prev_->nextTuple();
         }
     }
@@ -65,138 +81,17 @@ public:
         RmRecord rec(len_);
         size_t offset = 0;
         for (size_t i = 0; i < sel_cols_.size(); ++i) {
-            switch (types_[i]) {
-                case T_SUM: {
-                    auto &col_len = sel_cols_[i].len;
-                    auto &col_type = sel_cols_[i].type;
-                    char* sum = new char[col_len];
-                    char* tmp = new char[col_len];
-                    memset(sum, 0, col_len);
-                    // 只涉及int, float.
-                    for (auto &rec_ : recs_) {
-                        memcpy(tmp, rec_.data + sel_cols_[i].offset, col_len);
-                        if (col_type == TYPE_INT) {
-                            *(int*)sum += *(int*)tmp;
-                        } else if (col_type == TYPE_FLOAT) {
-                            *(double*)sum += *(double*)(tmp);
-                        }
-                    }
-                    memcpy(rec.data + offset, sum, col_len);
-                    sel_cols_[i].offset = offset;
-                    offset += col_len;
-                    delete[] sum;
-                    delete[] tmp;
-                    break;
-                }
-                case T_MAX: {
-                    auto &col_len = sel_cols_[i].len;
-                    auto &col_type = sel_cols_[i].type;
-                    char* value = new char[col_len];
-                    memset(value, 0, col_len);
-                    char* tmp = new char[col_len];
-                    // 只涉及int, float, char
-                    for (auto &rec_ : recs_) {
-                        memcpy(tmp, rec_.data + sel_cols_[i].offset, col_len);
-                        if (col_type == TYPE_INT && *(int*)value < *(int*)tmp) {
-                            *(int*)value = *(int*)tmp;
-                        } else if (col_type == TYPE_FLOAT && *(double*)value < *(double*)tmp) {
-                            *(double*)value = *(double*)(tmp);
-                        } else if (col_type == TYPE_STRING && memcmp(value, tmp, col_len) < 0) {
-                            memcpy(value, tmp, col_len);
-                        }
-                    }
-                    memcpy(rec.data + offset, value, col_len);
-                    sel_cols_[i].offset = offset;
-                    offset += col_len;
-                    delete[] value;
-                    delete[] tmp;
-                    break;
-                }
-                case T_MIN: {
-                    auto &col_len = sel_cols_[i].len;
-                    auto &col_type = sel_cols_[i].type;
-                    char* value = new char[col_len];
-                    // 初始化为最大值
-                    memset(value, 127, col_len);
-                    char* tmp = new char[col_len];
-                    // 只涉及int, float, char
-                    for (auto &rec_ : recs_) {
-                        memcpy(tmp, rec_.data + sel_cols_[i].offset, col_len);
-                        if (col_type == TYPE_INT && *(int*)value > *(int*)tmp) {
-                            *(int*)value = *(int*)tmp;
-                        } else if (col_type == TYPE_FLOAT && *(double*)value > *(double*)tmp) {
-                            *(double*)value = *(double*)(tmp);
-                        } else if (col_type == TYPE_STRING && memcmp(value, tmp, col_len) > 0) {
-                            memcpy(value, tmp, col_len);
-                        }
-                    }
-                    memcpy(rec.data + offset, value, col_len);
-                    sel_cols_[i].offset = offset;
-                    offset += col_len;
-                    delete[] value;
-                    delete[] tmp;
-                    break;
-                }
-                case T_COUNT: {
-                    // count 列，都用 int 类型存
-                    // 2. count(*)
-                    if (sel_cols_[i].tab_name.empty() && sel_cols_[i].name.empty()) {
-                        if (cnt_max_ != -1) break;
-                        // count所有列，找到最大值
-                        for (auto &col_ : cols_) {
-                            int cnt = 0;
-                            auto &col_len = col_.len;
-                            auto &col_type = col_.type;
-                            char *tmp = new char[col_len];
-                            // 只涉及int, float, char
-                            for (auto &rec_: recs_) {
-                                memcpy(tmp, rec_.data + col_.offset, col_len);
-                                // int, float 不存在空的值，只需要特判string == ""
-                                if (col_type != TYPE_STRING) {
-                                    cnt++;
-                                } else {
-                                    std::string str(tmp, col_len);
-                                    if (!str.empty()) {
-                                        cnt++;
-                                    }
-                                }
-                            }
-                            if (cnt_max_ < cnt) {
-                                cnt_max_ = cnt;
-                            }
-                            delete[] tmp;
-                        }
-                        memcpy(rec.data + offset, &cnt_max_, sizeof(int));
-                        sel_cols_[i].offset = offset;
-                        offset += sizeof(int);
-                        sel_cols_[i].type = TYPE_INT;
-                        break;
-                    }
-                    // 1. count(col)
-                    auto &col_len = sel_cols_[i].len;
-                    auto &col_type = sel_cols_[i].type;
-                    int cnt = 0;
-                    char* tmp = new char[col_len];
-                    // 只涉及int, float, char
-                    for (auto &rec_ : recs_) {
-                        memcpy(tmp, rec_.data + sel_cols_[i].offset, col_len);
-                        // int, float 不存在空的值，只需要特判string == ""
-                        if (col_type != TYPE_STRING) {
-                            cnt++;
-                        } else {
-                            std::string str(tmp);
-                            if (!str.empty()) {
-                                cnt++;
-                            }
-                        }
-                    }
-                    memcpy(rec.data + offset, &cnt, sizeof(int));
-                    sel_cols_[i].offset = offset;
-                    offset += sizeof(int);
-                    sel_cols_[i].type = TYPE_INT;
-                    delete[] tmp;
-                    break;
-                }
+            if (types_[i] == T_COUNT) {
+                // count 列，都用 int 类型存
+                int cnt = is_count_star(i) ? num_rows_ : counts_[i];
+                memcpy(rec.data + offset, &cnt, sizeof(int));
+                sel_cols_[i].offset = offset;
+                offset += sizeof(int);
+                sel_cols_[i].type = TYPE_INT;
+            } else {
+                memcpy(rec.data + offset, values_[i].data(), sel_cols_[i].len);
+                sel_cols_[i].offset = offset;
+                offset += sel_cols_[i].len;
             }
         }
         return std::make_unique<RmRecord>(rec);
@@ -219,4 +114,79 @@ public:
         }
         return cols_meta;
     }
+
+private:
+    bool is_count_star(size_t i) const {
+        return types_[i] == T_COUNT && sel_cols_[i].tab_name.empty() && sel_cols_[i].name.empty();
+    }
+
+    // 把一个输入值计入第i个聚合，val指向该列的值
+    void accumulate(size_t i, const char *val) {
+        auto &col_len = sel_cols_[i].len;
+        auto &col_type = sel_cols_[i].type;
+        char *value = values_[i].data();
+        switch (types_[i]) {
+            case T_SUM:
+                // 只涉及int, float.
+                if (col_type == TYPE_INT) {
+                    *(int *)value += *(const int *)val;
+                } else if (col_type == TYPE_FLOAT) {
+                    *(double *)value += *(const double *)val;
+                }
+                break;
+            case T_MAX:
+                // 只涉及int, float, char
+                if (col_type == TYPE_INT && *(int *)value < *(const int *)val) {
+                    *(int *)value = *(const int *)val;
+                } else if (col_type == TYPE_FLOAT && *(double *)value < *(const double *)val) {
+                    *(double *)value = *(const double *)val;
+                } else if (col_type == TYPE_STRING && memcmp(value, val, col_len) < 0) {
+                    memcpy(value, val, col_len);
+                }
+                break;
+            case T_MIN:
+                if (col_type == TYPE_INT && *(int *)value > *(const int *)val) {
+                    *(int *)value = *(const int *)val;
+                } else if (col_type == TYPE_FLOAT && *(double *)value > *(const double *)val) {
+                    *(double *)value = *(const double *)val;
+                } else if (col_type == TYPE_STRING && memcmp(value, val, col_len) > 0) {
+                    memcpy(value, val, col_len);
+                }
+                break;
+            case T_COUNT:
+                // int, float 不存在空的值，只需要特判string == ""
+                if (col_type != TYPE_STRING || val[0] != '\0') {
+                    counts_[i]++;
+                }
+                break;
+        }
+    }
+
+    /**
+     * @description: 输入是PAX格式的表上没有谓词的全表扫描时，逐页只读取聚合涉及的列的minipage，
+     * 不拼出完整的记录。表级读锁已经在构造SeqScanExecutor时加上
+     * @return {bool} 不满足条件时返回false，由调用者按记录聚合
+     */
+    bool scan_pax_columns() {
+        auto seq_scan = dynamic_cast<SeqScanExecutor *>(prev_.get());
+        if (seq_scan == nullptr || !seq_scan->conds().empty() ||
+            seq_scan->file_handle()->get_file_hdr().format != RM_FORMAT_PAX) {
+            return false;
+        }
+        BufferAccessStrategy strategy(BUFFER_SCAN_RING_SIZE);
+        seq_scan->file_handle()->scan_pax_pages(&strategy, [&](const RmPaxPage &page) {
+            num_rows_ += Bitmap::count(page.bitmap(), page.max_slots());
+            for (size_t i = 0; i < sel_cols_.size(); ++i) {
+                if (is_count_star(i)) {
+                    continue;
+                }
+                // 一次处理一列，顺序读取连续的minipage
+                const char *column = page.column(sel_cols_[i].offset);
+                int col_len = sel_cols_[i].len;
+                Bitmap::for_each_set(page.bitmap(), page.max_slots(),
+                                     [&](int slot_no) { accumulate(i, column + slot_no * col_len); });
+            }
+        });
+        return true;
+    }
 };
@@ -39,33 +39,38 @@ class DeleteExecutor : public AbstractExecutor {
     }
 
     std::unique_ptr<RmRecord> Next() override {
-        int idx = -1;
-        for (auto& rid : rids_) {
-            auto rm_record = fh_->get_record(rid, context_);
-            char* prev_delete_rec = rm_record->data;
+        // 按页批量读出所有要删除的记录，每个页面只pin一次
+        auto records = fh_->get_records(rids_, context_);
+        char key[IX_MAX_COL_LEN];
+        for (size_t i = 0; i < rids_.size(); ++i) {
             for (auto& index : tab_.indexes) {
-                char* delete_rec = new char[index.col_tot_len + 4];
-                memcpy(delete_rec + index.col_tot_len, &idx, 4);
                 auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
                 auto ih = sm_manager_->ihs_.at(index_name).get();
-                int offset = 0;
-                for (auto& index_col : index.cols) {
-                    memcpy(delete_rec + offset, prev_delete_rec + index_col.offset, index_col.len);
-                    offset += index_col.len;
-                }
-                if (!ih->delete_entry(delete_rec, context_->txn_)) {
+                index.get_key(records[i]->data, key);
+                if (!ih->delete_entry(key, context_->txn_)) {
                     throw IndexEntryNotFoundError();
                 }
-                RmRecord rm(index.col_tot_len + 4, delete_rec);
-                WriteRecord* wr = new WriteRecord(WType::DELETE_TUPLE, rid, rm, index_name);
+                RmRecord rm(index.col_tot_len, key);
+                WriteRecord* wr = new WriteRecord(WType::DELETE_TUPLE, rids_[i], rm, index_name);
+                context_->txn_->append_write_record(wr);
+            }
+        }
+        // delete_records中途抛出异常时，已经删除的记录也要写入写集合，事务回滚时才能恢复
+        std::vector<size_t> deleted;
+        auto append_deleted = [&]() {
+            for (size_t i : deleted) {
+                RmRecord delete_rec(records[i]->size, records[i]->data);
+                WriteRecord* wr = new WriteRecord(WType::DELETE_TUPLE, tab_name_, rids_[i], delete_rec);
                 context_->txn_->append_write_record(wr);
-                delete[] delete_rec;
             }
-            fh_->delete_record(rid, context_);
-            RmRecord delete_rec(rm_record->size, rm_record->data);
-            WriteRecord* wr = new WriteRecord(WType::DELETE_TUPLE, tab_name_, rid, delete_rec);
-            context_->txn_->append_write_record(wr);
+        };
+        try {
+            fh_->delete_records(rids_, context_, &deleted);
+        } catch (...) {
+            append_deleted();
+            throw;
         }
+        append_deleted();
         return nullptr;
     }
 
@@ -31,6 +31,11 @@ class IndexScanExecutor : public AbstractExecutor {
 
     Rid rid_;
     std::unique_ptr<RecScan> scan_;
+    // 从索引中成批取出rid，按页批量读出记录，同一页面上的记录只pin一次
+    static constexpr size_t BATCH_SIZE = 64;
+    std::vector<Rid> batch_rids_;
+    std::vector<std::unique_ptr<RmRecord>> batch_recs_;
+    size_t batch_pos_ = 0;              // rid_在当前批次中的位置
 
     SmManager *sm_manager_;
 
@@ -73,8 +78,7 @@ class IndexScanExecutor : public AbstractExecutor {
         auto ih = sm_manager_->ihs_[index_name].get();
         Iid lower = ih->leaf_begin(), upper = ih->leaf_end();
         // 构造索引key
-        char* key = new char[index_meta_.col_tot_len + 4];
-        char* last_eq_key = new char[index_meta_.col_tot_len + 4];
+        char key[IX_MAX_COL_LEN];
         int offset = 0;
         int idx = 0;
         for (; idx < index_meta_.cols.size(); ++idx) {
@@ -87,23 +91,18 @@ class IndexScanExecutor : public AbstractExecutor {
             }
         }
         idx--;
-        memcpy(key + index_meta_.col_tot_len, &idx, 4);
-        // 对于多列索引，需要考虑最后一个等号的位置 要么为idx，要么idx - 1
-        if (idx > 0 && conds_[idx].op != OP_EQ) {
-            memcpy(last_eq_key, key, index_meta_.col_tot_len);
-            int tmp = idx - 1;
-            memcpy(last_eq_key + index_meta_.col_tot_len, &tmp, 4);
-        }
+        // key给出了前idx + 1个字段；对于多列索引，前idx个等号条件构成的最左前缀确定了另一侧的界限
+        int num_cols = idx + 1, eq_cols = idx;
         // 只有最左叶子节点，需要考虑最小值大于等于小于key，其他节点都小于等于key
         if (conds_[idx].op == OP_EQ) {
-            lower = ih->lower_bound(key, context_->txn_);
-            upper = ih->upper_bound(key, context_->txn_);
+            lower = ih->lower_bound(key, num_cols, context_->txn_);
+            upper = ih->upper_bound(key, num_cols, context_->txn_);
         }
         else if (conds_[idx].op == OP_GE) {
-            lower = ih->lower_bound(key, context_->txn_);
+            lower = ih->lower_bound(key, num_cols, context_->txn_);
             // 对于多列索引，需要考虑新的上下限
             // 找满足第一个不满足多列等号条件的位置
-            if (idx) upper = ih->upper_bound(last_eq_key, context_->txn_);
+            if (idx) upper = ih->upper_bound(key, eq_cols, context_->txn_);
         }
         else if (conds_[idx].op == OP_LE) {
             // 找第一个大于key的位置，最终落在如果是中间或者最右叶子节点上的最小值必定小于等于key
@@ -112,8 +111,8 @@ class IndexScanExecutor : public AbstractExecutor {
             // 如果key_head > key, upper_bound = 0
             // 对于中间和最右叶子节点，正常处理
             // 对于多列索引，需要考虑新的上下限
-            if (idx) lower = ih->lower_bound(last_eq_key, context_->txn_);
-            upper = ih->upper_bound(key, context_->txn_);
+            if (idx) lower = ih->lower_bound(key, eq_cols, context_->txn_);
+            upper = ih->upper_bound(key, num_cols, context_->txn_);
         }
         else if (conds_[idx].op == OP_GT) {
             // 找第一个比key大的作为下限
@@ -123,9 +122,9 @@ class IndexScanExecutor : public AbstractExecutor {
             // 最大值如果大于key，正常找
             // 如果在最右叶子节点 最大值小于等于key，则pos = size，找不到; 如果小于最大值，正常找
             // 如果在中间叶子节点 与最右叶子节点相同
-            lower = ih->upper_bound(key, context_->txn_);
+            lower = ih->upper_bound(key, num_cols, context_->txn_);
             // 对于多列索引，需要考虑新的上下限
-            if (idx) upper = ih->upper_bound(last_eq_key, context_->txn_);
+            if (idx) upper = ih->upper_bound(key, eq_cols, context_->txn_);
         }
         else if (conds_[idx].op == OP_LT) {
             // 找第一个大于等于key的作为上界
@@ -134,44 +133,35 @@ class IndexScanExecutor : public AbstractExecutor {
             // 如果最大值小于key pos = size；大于等于key，正常找
             // 最右叶子节点 最大值小于key pos = size; 大于等于key，正常找
             // 中间叶子节点 与最右叶子节点相同
-            upper = ih->lower_bound(key, context_->txn_);
+            upper = ih->lower_bound(key, num_cols, context_->txn_);
             // 对于多列索引，需要考虑新的上下限
-            if (idx) lower = ih->lower_bound(last_eq_key, context_->txn_);
+            if (idx) lower = ih->lower_bound(key, eq_cols, context_->txn_);
         }
-        delete[] key;
-        delete[] last_eq_key;
         scan_ = std::make_unique<IxScan>(ih, lower, upper, sm_manager_->get_bpm());
-        while (!scan_->is_end()) {
-            rid_ = scan_->rid();
-            auto rec = fh_->get_record(rid_, context_);
-            if (cmp_conds(rec.get(), fed_conds_, cols_)) {
-                break;
-            }
-            scan_->next();
-        }
+        batch_rids_.clear();
+        batch_recs_.clear();
+        batch_pos_ = 0;
+        seek();
     }
 
     void nextTuple() override {
-        scan_->next();
-        while (!scan_->is_end()) {
-            rid_ = scan_->rid();
-            auto rec = fh_->get_record(rid_, context_);
-            if (cmp_conds(rec.get(), fed_conds_, cols_)) {
-                break;
-            }
-            scan_->next();
-        }
+        batch_pos_++;
+        seek();
     }
 
     std::unique_ptr<RmRecord> Next() override {
-        return fh_->get_record(rid_, context_);
+        // 批量读出的记录直接交给上层，同一位置再次取记录时重新读取
+        if (batch_recs_[batch_pos_] == nullptr) {
+            return fh_->get_record(rid_, context_);
+        }
+        return std::move(batch_recs_[batch_pos_]);
     }
 
     Rid &rid() override { return rid_; }
 
     const std::vector<ColMeta> &cols() const override { return cols_; }
 
-    bool is_end() const override { return scan_->is_end(); }
+    bool is_end() const override { return batch_pos_ >= batch_rids_.size(); }
 
     size_t tupleLen() const override { return len_; }
 
@@ -207,11 +197,11 @@ class IndexScanExecutor : public AbstractExecutor {
     }
 
     // 判断是否满足单个谓词条件
-    bool cmp_cond(const RmRecord* rec, const Condition& cond,  const std::vector<ColMeta>& rec_cols) {
+    bool cmp_cond(const char* rec, const Condition& cond,  const std::vector<ColMeta>& rec_cols) {
         // 提取左值与右值的数据和类型
         auto lhs_col_meta = get_col(rec_cols, cond.lhs_col);
-        char* lhs_data = rec->data + lhs_col_meta->offset;
-        char* rhs_data;
+        const char* lhs_data = rec + lhs_col_meta->offset;
+        const char* rhs_data;
         ColType rhs_type;
 
         // rhs is val
@@ -223,7 +213,7 @@ class IndexScanExecutor : public AbstractExecutor {
             // rhs is col
             auto rhs_col_meta = get_col(rec_cols, cond.rhs_col);
             rhs_type = rhs_col_meta->type;
-            rhs_data = rec->data + rhs_col_meta->offset;
+            rhs_data = rec + rhs_col_meta->offset;
         }
         // 判断左右值数据类型是否相同
         if (lhs_col_meta->type != rhs_type) {
@@ -243,9 +233,37 @@ class IndexScanExecutor : public AbstractExecutor {
     }
 
     // 判断是否满足所有谓词条件
-    bool cmp_conds(const RmRecord* rec, const std::vector<Condition>& conds, const std::vector<ColMeta>& rec_cols) {
+    bool cmp_conds(const char* rec, const std::vector<Condition>& conds, const std::vector<ColMeta>& rec_cols) {
         return std::all_of(conds.begin(), conds.end(), [&](const Condition &cond) {
             return cmp_cond(rec, cond, rec_cols);
         });
     }
-};
\ No newline at end of file
+
+   private:
+    // 从索引中取出下一批rid并按页批量读出记录，索引已扫描完时返回false
+    bool fill_batch() {
+        batch_rids_.clear();
+        while (!scan_->is_end() && batch_rids_.size() < BATCH_SIZE) {
+            batch_rids_.push_back(scan_->rid());
+            scan_->next();
+        }
+        batch_recs_ = fh_->get_records(batch_rids_, context_);
+        batch_pos_ = 0;
+        return !batch_rids_.empty();
+    }
+
+    // 从batch_pos_开始找到下一条满足条件的记录，找不到时is_end()为真
+    void seek() {
+        while (true) {
+            for (; batch_pos_ < batch_rids_.size(); batch_pos_++) {
+                if (cmp_conds(batch_recs_[batch_pos_]->data, fed_conds_, cols_)) {
+                    rid_ = batch_rids_[batch_pos_];
+                    return;
+                }
+            }
+            if (!fill_batch()) {
+                return;
+            }
+        }
+    }
+};
@@ -65,21 +65,14 @@ class InsertExecutor : public AbstractExecutor {
         }
 
         // 唯一性检查
-        int idx = -1;
         std::vector<Rid> rid;
+        char key[IX_MAX_COL_LEN];
         for (auto &index: tab_.indexes) {
             auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char *insert_data = new char[index.col_tot_len + 4];
-            memcpy(insert_data + index.col_tot_len, &idx, 4);
-            int offset = 0;
-            for (auto &col: index.cols) {
-                memcpy(insert_data + offset, rec.data + col.offset, col.len);
-                offset += col.len;
-            }
-            if (ih->get_value(insert_data, &rid, context_->txn_)) {
+            index.get_key(rec.data, key);
+            if (ih->get_value(key, &rid, context_->txn_)) {
                 throw InternalError("Non-Unique Index!");
             }
-            delete[] insert_data;
         }
 
         // Insert into record file
@@ -88,18 +81,11 @@ class InsertExecutor : public AbstractExecutor {
         for (auto& index : tab_.indexes) {
             auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
             auto ih = sm_manager_->ihs_.at(index_name).get();
-            char* key = new char[index.col_tot_len + 4];
-            memcpy(key + index.col_tot_len, &idx, 4);
-            int offset = 0;
-            for (size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
-            }
+            index.get_key(rec.data, key);
             ih->insert_entry(key, rid_, context_->txn_);
-            RmRecord rm(index.col_tot_len + 4, key);
+            RmRecord rm(index.col_tot_len, key);
             WriteRecord* wr = new WriteRecord(WType::INSERT_TUPLE, rid_, rm, index_name);
             context_->txn_->append_write_record(wr);
-            delete[] key;
         }
         // 因为插入操作只有插入后才能得到rid信息，所以事务只需要存rid，在事务提交时不用再进行写操作
         WriteRecord* wr = new WriteRecord(WType::INSERT_TUPLE, tab_name_, rid_);
@@ -26,7 +26,8 @@ class SeqScanExecutor : public AbstractExecutor {
     std::vector<Condition> fed_conds_;  // 同conds_，两个字段相同
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;     // table_iterator
+    std::unique_ptr<BufferAccessStrategy> strategy_;    // 全表扫描使用私有的帧环，避免冲刷缓冲池
+    std::unique_ptr<RmScan> scan_;      // table_iterator，按页扫描，持有的页面须先于strategy_释放
 
     SmManager *sm_manager_;
 
@@ -41,6 +42,7 @@ class SeqScanExecutor : public AbstractExecutor {
         len_ = cols_.back().offset + cols_.back().len;
         context_ = context;
         fed_conds_ = conds_;
+        strategy_ = std::make_unique<BufferAccessStrategy>(BUFFER_SCAN_RING_SIZE);
         // 加表级读锁
         context_->lock_mgr_->lock_shared_on_table(context->txn_, fh_->GetFd());
     }
@@ -53,12 +55,12 @@ class SeqScanExecutor : public AbstractExecutor {
         // select * from table
         // select id from grade where name = 'Data';
         // 表迭代器
-        scan_ = std::make_unique<RmScan>(fh_);
+        // 按页扫描，每个页面只与缓冲池交互一次；表级读锁已覆盖所有记录，不再逐条申请行锁
+        scan_ = std::make_unique<RmScan>(fh_, strategy_.get(), READ_AHEAD_PAGES, true, zone_ranges());
         while (!scan_->is_end()) {
             // 得到当前 rid
             rid_ = scan_->rid();
-            auto rec = fh_->get_record(rid_, context_);
-            if (cmp_conds(rec.get(), conds_, cols_)) {
+            if (cmp_conds(scan_->tuple(), conds_, cols_)) {
                 break;
             }
             scan_->next();
@@ -75,8 +77,7 @@ class SeqScanExecutor : public AbstractExecutor {
         }
         for (scan_->next(); !scan_->is_end(); scan_->next()) {
             rid_ = scan_->rid();
-            auto rec = fh_->get_record(rid_, context_);
-            if (cmp_conds(rec.get(), conds_, cols_)) {
+            if (cmp_conds(scan_->tuple(), conds_, cols_)) {
                 break;
             }
         }
@@ -88,7 +89,11 @@ class SeqScanExecutor : public AbstractExecutor {
     * @return std::unique_ptr<RmRecord>
     */
     std::unique_ptr<RmRecord> Next() override {
-        return fh_->get_record(rid_, context_);
+        if (scan_ == nullptr || scan_->is_end()) {
+            return fh_->get_record(rid_, context_);
+        }
+        // 只在上层真正取走记录时才拷贝
+        return std::make_unique<RmRecord>(static_cast<int>(len_), const_cast<char *>(scan_->tuple()));
     }
 
     Rid &rid() override { return rid_; }
@@ -99,6 +104,61 @@ class SeqScanExecutor : public AbstractExecutor {
 
     size_t tupleLen() const override { return len_; }
 
+    RmFileHandle *file_handle() const { return fh_; }
+
+    const std::vector<Condition> &conds() const { return conds_; }
+
+    /**
+    * @description: 把"列 op 常量"形式的条件转换为区域映射上的范围，扫描时跳过没有满足条件的记录的页面；
+    * 其他条件和类型不一致的条件不转换，仍逐条判断
+    */
+    std::vector<RmZoneRange> zone_ranges() {
+        std::vector<RmZoneRange> ranges;
+        const RmZoneMap &zone_map = fh_->zone_map();
+        for (auto &cond : conds_) {
+            if (!cond.is_rhs_val || cond.op == OP_NE || cond.rhs_val.raw == nullptr) {
+                continue;
+            }
+            auto col = get_col(cols_, cond.lhs_col);
+            int idx = zone_map.col_index(col->offset, col->type);
+            if (idx == -1 || cond.rhs_val.type != col->type) {
+                continue;
+            }
+            RmZoneRange range{idx};
+            int64_t key = RmZoneMap::key(col->type, cond.rhs_val.raw->data);
+            switch (cond.op) {
+                case OP_EQ:
+                    range.lo = range.hi = key;
+                    break;
+                // 键都是整数，严格不等转换为闭区间；没有更小或更大的键时范围为空
+                case OP_LT:
+                    if (key == INT64_MIN) {
+                        range.lo = INT64_MAX;
+                    } else {
+                        range.hi = key - 1;
+                    }
+                    break;
+                case OP_GT:
+                    if (key == INT64_MAX) {
+                        range.hi = INT64_MIN;
+                    } else {
+                        range.lo = key + 1;
+                    }
+                    break;
+                case OP_LE:
+                    range.hi = key;
+                    break;
+                case OP_GE:
+                    range.lo = key;
+                    break;
+                default:
+                    break;
+            }
+            ranges.push_back(range);
+        }
+        return ranges;
+    }
+
     /**
     * @description: 比较数据数值
     *
@@ -131,11 +191,11 @@ class SeqScanExecutor : public AbstractExecutor {
     }
 
     // 判断是否满足单个谓词条件
-    bool cmp_cond(const RmRecord* rec, const Condition& cond,  const std::vector<ColMeta>& rec_cols) {
+    bool cmp_cond(const char* rec, const Condition& cond,  const std::vector<ColMeta>& rec_cols) {
         // 提取左值与右值的数据和类型
         auto lhs_col_meta = get_col(rec_cols, cond.lhs_col);
-        char* lhs_data = rec->data + lhs_col_meta->offset;
-        char* rhs_data;
+        const char* lhs_data = rec + lhs_col_meta->offset;
+        const char* rhs_data;
         ColType rhs_type;
 
         // rhs is val
@@ -147,7 +207,7 @@ class SeqScanExecutor : public AbstractExecutor {
             // rhs is col
             auto rhs_col_meta = get_col(rec_cols, cond.rhs_col);
             rhs_type = rhs_col_meta->type;
-            rhs_data = rec->data + rhs_col_meta->offset;
+            rhs_data = rec + rhs_col_meta->offset;
         }
         // 判断左右值数据类型是否相同
         if (lhs_col_meta->type != rhs_type) {
@@ -167,7 +227,7 @@ class SeqScanExecutor : public AbstractExecutor {
     }
 
     // 判断是否满足所有谓词条件
-    bool cmp_conds(const RmRecord* rec, const std::vector<Condition>& conds,  const std::vector<ColMeta>& rec_cols) {
+    bool cmp_conds(const char* rec, const std::vector<Condition>& conds,  const std::vector<ColMeta>& rec_cols) {
         return std::all_of(conds.begin(), conds.end(), [&](const Condition &cond) {
             return cmp_cond(rec, cond, rec_cols);
         });
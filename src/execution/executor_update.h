@@ -46,13 +46,21 @@ public:
 
         // 如果满足谓词条件的记录有多条，则更新的字段必须不是索引
         // 因为会对所有满足谓词条件的记录执行一样的更新操作
-        int idx = -1;
         std::vector<RmRecord> old_records, new_records;
-        std::vector<char*> old_datas[rids_.size()], new_datas[rids_.size()];
         std::vector<Rid> old_rids;
+        // 每条记录在各个索引上的旧键、新键依次存放在连续的内存中，唯一性检查失败时用来恢复已经更新的索引
+        std::vector<int> key_offsets;
+        int keys_len = 0;
+        for (auto &index: tab_.indexes) {
+            key_offsets.push_back(keys_len);
+            keys_len += index.col_tot_len;
+        }
+        std::vector<char> old_keys(rids_.size() * keys_len), new_keys(rids_.size() * keys_len);
 
+        // 按页批量读出所有要更新的记录，每个页面只pin一次
+        auto records = fh_->get_records(rids_, context_);
         for (size_t i = 0; i < rids_.size(); ++i) {
-            auto old_record = fh_->get_record(rids_[i], context_);
+            auto &old_record = records[i];
             old_records.emplace_back(*old_record.get());
             RmRecord update_record = *old_record.get();
             for (auto &clause: set_clauses_) {
@@ -91,57 +99,42 @@ public:
             }
 
             std::vector<Rid> rid_;
-            for (auto &index: tab_.indexes) {
+            for (size_t k = 0; k < tab_.indexes.size(); ++k) {
                 // 进行唯一性检查
+                auto &index = tab_.indexes[k];
                 auto ih = sm_manager_->ihs_.at(
                         sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-                char *update_data = new char[index.col_tot_len + 4];
-                memcpy(update_data + index.col_tot_len, &idx, 4);
-                int offset = 0;
-                for (auto &col: index.cols) {
-                    memcpy(update_data + offset, update_record.data + col.offset, col.len);
-                    offset += col.len;
-                }
-                if (ih->get_value(update_data, &rid_, context_->txn_)) {
+                char *new_key = &new_keys[i * keys_len + key_offsets[k]];
+                index.get_key(update_record.data, new_key);
+                if (ih->get_value(new_key, &rid_, context_->txn_)) {
                     if (rid_.back() != rids_[i]) {
                         // 恢复
                         for (size_t j = 0; j < i; ++j) { // rid
-                            for (size_t k = 0; k < tab_.indexes.size(); ++k) { // index
+                            for (size_t l = 0; l < tab_.indexes.size(); ++l) { // index
                                 auto recover_ih = sm_manager_->ihs_.at(
-                                        sm_manager_->get_ix_manager()->get_index_name(tab_name_, tab_.indexes[k].cols)).get();
-                                recover_ih->delete_entry(new_datas[j][k], context_->txn_);
-                                recover_ih->insert_entry(old_datas[j][k], rids_[j], context_->txn_);
-                                delete[] new_datas[j][k];
-                                delete[] old_datas[j][k];
+                                        sm_manager_->get_ix_manager()->get_index_name(tab_name_, tab_.indexes[l].cols)).get();
+                                recover_ih->delete_entry(&new_keys[j * keys_len + key_offsets[l]], context_->txn_);
+                                recover_ih->insert_entry(&old_keys[j * keys_len + key_offsets[l]], rids_[j], context_->txn_);
                             }
                         }
                         throw InternalError("Non-Unique Index!");
                     }
                 }
-                delete[] update_data;
             }
             // 通过检查，更新索引
-            for (auto &index: tab_.indexes) {
+            for (size_t k = 0; k < tab_.indexes.size(); ++k) {
+                auto &index = tab_.indexes[k];
                 auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
                 auto ih = sm_manager_->ihs_.at(index_name).get();
-                char *update_data = new char[index.col_tot_len + 4];
-                char *old_data = new char[index.col_tot_len + 4];
-                memcpy(update_data + index.col_tot_len, &idx, 4);
-                memcpy(old_data + index.col_tot_len, &idx, 4);
-                int offset = 0;
-                for (auto &col: index.cols) {
-                    memcpy(update_data + offset, update_record.data + col.offset, col.len);
-                    memcpy(old_data + offset, old_record->data + col.offset, col.len);
-                    offset += col.len;
-                }
-                ih->delete_entry(old_data, context_->txn_);
-                ih->insert_entry(update_data, rids_[i], context_->txn_);
-                RmRecord rm_old(index.col_tot_len + 4, old_data);
-                RmRecord rm_update(index.col_tot_len + 4, update_data);
+                char *new_key = &new_keys[i * keys_len + key_offsets[k]];
+                char *old_key = &old_keys[i * keys_len + key_offsets[k]];
+                index.get_key(old_record->data, old_key);
+                ih->delete_entry(old_key, context_->txn_);
+                ih->insert_entry(new_key, rids_[i], context_->txn_);
+                RmRecord rm_old(index.col_tot_len, old_key);
+                RmRecord rm_update(index.col_tot_len, new_key);
                 WriteRecord* wr = new WriteRecord(WType::UPDATE_TUPLE, rids_[i], rm_old, rm_update, index_name);
                 context_->txn_->append_write_record(wr);
-                old_datas[i].emplace_back(old_data);
-                new_datas[i].emplace_back(update_data);
             }
             // old_rids.emplace_back(rid_[i]);
             new_records.emplace_back(update_record);
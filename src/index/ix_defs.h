@@ -21,6 +21,9 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+constexpr int IX_BULK_LOAD_FILL_PERCENT = 90;   // 自底向上建树时结点的填充率，留出空位以免之后的插入立即分裂
+constexpr size_t IX_SORT_MEMORY_LIMIT = 64 << 20;    // 建立索引时外部排序在内存中存放的键值对的字节数上限
+constexpr char IX_SORT_RUN_SUFFIX[] = ".sort";       // 外部排序的有序段文件名的后缀，后面再接段号
 
 class IxFileHdr {
 public: 
@@ -135,6 +138,10 @@ public:
     bool is_leaf;                   // 是否为叶节点
     page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
     page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
+    page_id_t right_link;           // 同一层右兄弟结点的页面号，最右的结点为IX_NO_PAGE；被合并掉的结点指向接收其键值对的结点
+    bool has_low_key;               // 是否有低键，每一层最左的结点没有低键
+    bool is_deleted;                // 结点已经被合并掉或者不再是根，只保留right_link供并发的读者跳转
+    int prefix_len;                 // 叶子结点的键都省略掉的公共前缀的长度，前缀与低键的相同；内部结点和最左的叶子为0
 };
 
 class Iid {
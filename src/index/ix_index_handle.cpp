@@ -11,6 +11,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_index_handle.h"
 
+#include <thread>
+
 #include "ix_scan.h"
 
 void IxIndexHandle::unlock_page_set(Transaction* transaction) {
@@ -41,31 +43,42 @@ inline bool IxNodeHandle::is_safe(Operation operation) {
     return true;
 }
 
+/**
+ * @brief key是否落在结点范围的左边，即键值对可能已经被并发的重分配移到了左边的结点
+ * @note 与internal_lookup一致，查找时等于分隔键的key属于左边的结点，插入、删除时属于右边的结点
+ */
+bool IxNodeHandle::below_low_key(const char *key, int num_cols, Operation operation) const {
+    const char *low_key = get_low_key();
+    if (low_key == nullptr) {
+        return false;
+    }
+    int cmp = ix_compare(low_key, key, file_hdr->col_types_, file_hdr->col_lens_, num_cols);
+    return operation == Operation::FIND || operation == Operation::FIND_LOWER ? cmp >= 0 : cmp > 0;
+}
+
+/**
+ * @brief key是否落在结点范围的右边，即结点已经被并发地分裂，需要沿right_link向右查找
+ */
+bool IxNodeHandle::beyond_high_key(const char *key, int num_cols, Operation operation) const {
+    const char *high_key = get_high_key();
+    if (high_key == nullptr) {
+        return false;
+    }
+    int cmp = ix_compare(high_key, key, file_hdr->col_types_, file_hdr->col_lens_, num_cols);
+    return operation == Operation::FIND || operation == Operation::FIND_LOWER ? cmp < 0 : cmp <= 0;
+}
+
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
  *
  * @return key_idx，范围为[0,num_key)，如果返回的key_idx=num_key，则表示target大于最后一个key
  * @note 返回key index（同时也是rid index），作为slot no
  */
-int IxNodeHandle::lower_bound(const char *target) const {
+int IxNodeHandle::lower_bound(const char *target, int num_cols) const {
     // Todo:
     // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
     // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
-
-    int left = 0, right = page_hdr->num_key - 1;
-    while (left <= right) {
-        int mid = (left + right) >> 1;
-        char* key = get_key(mid);
-        int cmp = ix_compare(key, target, file_hdr->col_types_, file_hdr->col_lens_);
-        if (cmp < 0) {
-            left = mid + 1;
-        }
-        else {
-            right = mid - 1;
-        }
-    }
-    // left > right 退出，查找位置即为 left
-    return left;
+    return search(target, num_cols, 0, false);
 }
 
 /**
@@ -74,17 +87,52 @@ int IxNodeHandle::lower_bound(const char *target) const {
  * @return key_idx，范围为[1,num_key)，如果返回的key_idx=num_key，则表示target大于等于最后一个key
  * @note 注意此处的范围从1开始
  */
-int IxNodeHandle::upper_bound(const char *target) const {
+int IxNodeHandle::upper_bound(const char *target, int num_cols) const {
     // Todo:
     // 查找当前节点中第一个大于target的key，并返回key的位置给上层
     // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
     // 直接和最小值比较，比最小小则为0
-    int left = 1, right = page_hdr->num_key - 1;
+    return search(target, num_cols, 1, true);
+}
+
+/**
+ * @brief 在[begin,num_key)中查找第一个>=target的key_idx，upper为true时查找第一个>target的
+ *
+ * @return key_idx，num_key不大于begin时返回begin
+ * @note 单个INT、BIGINT字段的索引直接在键数组上用IxSearch查找；
+ * 省略了前缀的叶子结点先比较一次前缀，前缀不同时target在所有键的一侧，相同时二分查找只比较后缀
+ */
+int IxNodeHandle::search(const char *target, int num_cols, int begin, bool upper) const {
+    int num_key = page_hdr->num_key;
+    if (num_key <= begin) {
+        return begin;
+    }
+    if (file_hdr->col_num_ == 1) {
+        ColType type = file_hdr->col_types_[0];
+        if (type == TYPE_INT && file_hdr->col_tot_len_ == sizeof(int)) {
+            return begin + IxSearch::count_less(reinterpret_cast<const int *>(get_key(begin)), num_key - begin,
+                                                *reinterpret_cast<const int *>(target), upper);
+        }
+        if (type == TYPE_BIGINT && file_hdr->col_tot_len_ == sizeof(long long)) {
+            return begin + IxSearch::count_less(reinterpret_cast<const long long *>(get_key(begin)), num_key - begin,
+                                                *reinterpret_cast<const long long *>(target), upper);
+        }
+    }
+    int prefix_len = page_hdr->prefix_len;
+    if (prefix_len > 0) {
+        int res = memcmp(bound_keys, target, prefix_len);
+        if (res != 0) {
+            return res > 0 ? begin : num_key;
+        }
+    }
+    int left = begin, right = num_key - 1;
     while (left <= right) {
         int mid = (left + right) >> 1;
-        const char* key = get_key(mid);
-        int cmp = ix_compare(key, target, file_hdr->col_types_, file_hdr->col_lens_);
-        if (cmp <= 0) {
+        const char *key = get_key(mid);
+        int cmp = prefix_len == 0
+                      ? ix_compare(key, target, file_hdr->col_types_, file_hdr->col_lens_, num_cols)
+                      : ix_compare_suffix(key, target, file_hdr->col_types_, file_hdr->col_lens_, prefix_len, num_cols);
+        if (upper ? cmp <= 0 : cmp < 0) {
             left = mid + 1;
         }
         else {
@@ -95,6 +143,58 @@ int IxNodeHandle::upper_bound(const char *target) const {
     return left;
 }
 
+/**
+ * @brief 比较第key_idx个键与target的前num_cols个字段，结果与ix_compare(完整的键, target, num_cols)相同
+ */
+int IxNodeHandle::compare_key(int key_idx, const char *target, int num_cols) const {
+    int prefix_len = page_hdr->prefix_len;
+    if (prefix_len == 0) {
+        return ix_compare(get_key(key_idx), target, file_hdr->col_types_, file_hdr->col_lens_, num_cols);
+    }
+    int res = memcmp(bound_keys, target, prefix_len);
+    if (res != 0) {
+        return res;
+    }
+    return ix_compare_suffix(get_key(key_idx), target, file_hdr->col_types_, file_hdr->col_lens_, prefix_len, num_cols);
+}
+
+/**
+ * @brief 键都在[low_key, high_key)中时共同的前缀长度。只压缩第一个字段是字符串的叶子结点，前缀不超出第一个字段；
+ * 没有低键或高键的叶子结点的范围没有界限，不压缩
+ */
+int IxNodeHandle::common_prefix_len(const char *low_key, const char *high_key) const {
+    if (!page_hdr->is_leaf || low_key == nullptr || high_key == nullptr || file_hdr->col_types_[0] != TYPE_STRING) {
+        return 0;
+    }
+    int len = 0;
+    while (len < file_hdr->col_lens_[0] && low_key[len] == high_key[len]) {
+        len++;
+    }
+    return len;
+}
+
+/**
+ * @brief 改变叶子结点省略的前缀长度，按新的布局重新存放键值对
+ * @note 前缀从低键中取，低键的前prefix_len个字节必须与所有键的相同。结点的范围扩大之前先解压(prefix_len为0)，
+ * 放入范围外的键并更新低键、高键之后再重新压缩
+ */
+void IxNodeHandle::set_prefix_len(int prefix_len) {
+    if (prefix_len == page_hdr->prefix_len) {
+        return;
+    }
+    int num_key = page_hdr->num_key;
+    assert(num_key <= max_size(prefix_len));
+    int col_tot_len = file_hdr->col_tot_len_;
+    std::vector<char> full_keys(static_cast<size_t>(num_key) * col_tot_len);
+    for (int i = 0; i < num_key; i++) {
+        copy_key(i, &full_keys[static_cast<size_t>(i) * col_tot_len]);
+    }
+    std::vector<Rid> old_rids(get_rids(), get_rids() + num_key);
+    page_hdr->prefix_len = prefix_len;
+    page_hdr->num_key = 0;
+    insert_pairs(0, full_keys.data(), old_rids.data(), num_key);
+}
+
 /**
  * @brief 用于叶子结点根据key来查找该结点中的键值对
  * 值value作为传出参数，函数返回是否查找成功
@@ -109,9 +209,9 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
     // 2. 判断目标key是否存在
     // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
     // 提示：可以调用lower_bound()和get_rid()函数。
-    int pos = lower_bound(key);
+    int pos = lower_bound(key, file_hdr->col_num_);
     // key 不存在
-    if (pos == page_hdr->num_key || ix_compare(get_key(pos), key, file_hdr->col_types_, file_hdr->col_lens_)) return false;
+    if (pos == page_hdr->num_key || compare_key(pos, key, file_hdr->col_num_)) return false;
     *value = get_rid(pos);
     return true;
 }
@@ -119,9 +219,10 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
 /**
  * 用于内部结点（非叶子节点）查找目标key所在的孩子结点（子树）
  * @param key 目标key
+ * @param num_cols key参与比较的字段数量，查找时可以只给出前几个字段
  * @return page_id_t 目标key所在的孩子节点（子树）的存储页面编号
  */
-page_id_t IxNodeHandle::internal_lookup(const char *key, Operation operation) {
+page_id_t IxNodeHandle::internal_lookup(const char *key, int num_cols, Operation operation) {
     // Todo:
     // 1. 查找当前非叶子节点中目标key所在孩子节点（子树）的位置
     // 2. 获取该孩子节点（子树）所在页面的编号
@@ -132,12 +233,12 @@ page_id_t IxNodeHandle::internal_lookup(const char *key, Operation operation) {
     int pos = -1;
     // for lower_bound and get_value
     if (operation == Operation::FIND_LOWER || operation == Operation::FIND) {
-        pos = lower_bound(key);
+        pos = lower_bound(key, num_cols);
         if (pos > 0) pos--;
     }
     // for insert, delete and find_upper
     else {
-        pos = upper_bound(key) - 1;
+        pos = upper_bound(key, num_cols) - 1;
     }
     return value_at(pos);
 }
@@ -166,15 +267,42 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
     if (pos < 0 || pos > page_hdr->num_key) {
         throw IndexEntryNotFoundError();
     }
+    int key_size = key_len();
+    int prefix_len = page_hdr->prefix_len;
+    Rid *rids = get_rids();
     // pos上所有num-pos个元素后移n个单位
-    memmove(keys + (pos + n) * file_hdr->col_tot_len_, keys + pos * file_hdr->col_tot_len_, (page_hdr->num_key - pos) * file_hdr->col_tot_len_);
+    memmove(keys + (pos + n) * key_size, keys + pos * key_size, (page_hdr->num_key - pos) * key_size);
     memmove(rids + pos + n, rids + pos, (page_hdr->num_key - pos) * sizeof(Rid));
-    // 在pos上插入 n 个元素
-    memcpy(keys + pos * file_hdr->col_tot_len_, key, n * file_hdr->col_tot_len_);
+    // 在pos上插入 n 个元素，省略了前缀的叶子结点只存放后缀
+    if (prefix_len == 0) {
+        memcpy(keys + pos * key_size, key, n * key_size);
+    } else {
+        for (int i = 0; i < n; i++) {
+            const char *full_key = key + i * file_hdr->col_tot_len_;
+            assert(memcmp(full_key, bound_keys, prefix_len) == 0);
+            memcpy(keys + (pos + i) * key_size, full_key + prefix_len, key_size);
+        }
+    }
     memcpy(rids + pos, rid, n * sizeof(Rid));
     page_hdr->num_key += n;
 }
 
+/**
+ * @brief 把src结点中从begin开始的n个键值对插入到pos位置，两个结点省略的前缀长度可以不同
+ */
+void IxNodeHandle::insert_pairs(int pos, const IxNodeHandle *src, int begin, int n) {
+    if (src->page_hdr->prefix_len == 0) {
+        insert_pairs(pos, src->get_key(begin), src->get_rid(begin), n);
+        return;
+    }
+    // 逐个还原出完整的键再插入
+    char key[IX_MAX_COL_LEN];
+    for (int i = 0; i < n; i++) {
+        src->copy_key(begin + i, key);
+        insert_pairs(pos + i, key, src->get_rid(begin + i), 1);
+    }
+}
+
 /**
  * @brief 用于在结点中插入单个键值对。
  * 函数返回插入后的键值对数量
@@ -189,12 +317,9 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
     // 3. 如果key不重复则插入键值对
     // 4. 返回完成插入操作之后的键值对数量
 
-    int pos = lower_bound(key);
+    int pos = lower_bound(key, file_hdr->col_num_);
     // 如果key重复则不插入，返回之前的 num_key
-    // Final bug! ix_compare的参数顺序!
-    // 只有key带有fed_size，应该作为第二个参数!
-    // 对单索引不影响，多索引影响重大
-    if (pos >= page_hdr->num_key || ix_compare(get_key(pos), key, file_hdr->col_types_, file_hdr->col_lens_)) {
+    if (pos >= page_hdr->num_key || compare_key(pos, key, file_hdr->col_num_)) {
         insert_pairs(pos, key, &value, 1);
     }
     return page_hdr->num_key;
@@ -210,7 +335,9 @@ void IxNodeHandle::erase_pair(int pos) {
     // 1. 删除该位置的key
     // 2. 删除该位置的rid
     // 3. 更新结点的键值对数量
-    memmove(keys + pos * file_hdr->col_tot_len_, keys + (pos + 1) * file_hdr->col_tot_len_, (page_hdr->num_key - pos - 1) * file_hdr->col_tot_len_);
+    int key_size = key_len();
+    Rid *rids = get_rids();
+    memmove(keys + pos * key_size, keys + (pos + 1) * key_size, (page_hdr->num_key - pos - 1) * key_size);
     memmove(rids + pos, rids + pos + 1, (page_hdr->num_key - pos - 1) * sizeof(Rid));
     page_hdr->num_key--;
 }
@@ -226,8 +353,8 @@ int IxNodeHandle::remove(const char *key) {
     // 1. 查找要删除键值对的位置
     // 2. 如果要删除的键值对存在，删除键值对
     // 3. 返回完成删除操作后的键值对数量
-    int pos = lower_bound(key);
-    if (pos < page_hdr->num_key && ix_compare(get_key(pos), key, file_hdr->col_types_, file_hdr->col_lens_) == 0) {
+    int pos = lower_bound(key, file_hdr->col_num_);
+    if (pos < page_hdr->num_key && compare_key(pos, key, file_hdr->col_num_) == 0) {
         erase_pair(pos);
     }
     return page_hdr->num_key;
@@ -243,9 +370,12 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
     
-    // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    // disk_manager管理的fd对应的文件中，从文件中已有的页面之后开始分配page_no。
+    // file_hdr_->num_pages_在删除结点时会减少，不能作为分配的起点；
+    // 重新打开的文件得到的fd也可能与建立索引时不同，不能沿用fd原有的计数
+    int file_size = disk_manager_->get_file_size(disk_manager_->get_file_name(fd));
+    int num_pages = (file_size + PAGE_SIZE - 1) / PAGE_SIZE;
+    disk_manager_->set_fd2pageno(fd, std::max(num_pages, IX_INIT_NUM_PAGES));
 }
 
 /**
@@ -257,7 +387,7 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
  * @note need to Unlatch and unpin the leaf node outside!
  * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
  */
-std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
+std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, int num_cols, Operation operation,
                                                             Transaction *transaction, bool find_first) {
     // Todo:
     // 1. 获取根节点
@@ -295,7 +425,7 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
 
     while (!cur_nodeHandle->is_leaf_page()) {
         auto cur_parent = cur_nodeHandle;
-        cur_nodeHandle = fetch_node(find_first ? cur_nodeHandle->value_at(0) : cur_nodeHandle->internal_lookup(key, operation));
+        cur_nodeHandle = fetch_node(find_first ? cur_nodeHandle->value_at(0) : cur_nodeHandle->internal_lookup(key, num_cols, operation));
 
         // 对于插入和删除操作，进入树的每一层结点都是先在当前结点获取写锁，如果当前结点“安全”才释放所有祖先节点的写锁
         if (operation == Operation::INSERT || operation == Operation::DELETE) {
@@ -320,6 +450,138 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
     return std::make_pair(cur_nodeHandle, root_is_latched);
 }
 
+/**
+ * @brief B-link查找：不加根锁，每次只对一个结点加读锁，释放当前结点后再锁下一个结点。
+ * 结点在读者离开父结点之后被并发地分裂时key超过其高键，沿right_link向右；结点被合并掉时沿right_link找到接收其键值对的结点
+ * @param key 要查找的目标key值
+ * @param operation FIND、FIND_LOWER或FIND_UPPER
+ * @return 加了读锁的叶子结点；树为空，或者键值对被并发的重分配移到了左边时返回nullptr
+ * @note need to RUnlatch and unpin the leaf node outside!
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_page_blink(const char *key, int num_cols, Operation operation) {
+    page_id_t page_no = get_root_page_no();
+    while (page_no != IX_NO_PAGE) {
+        auto node = fetch_node(page_no);
+        node->page->RLatch();
+        if (node->is_deleted()) {
+            page_no = node->get_right_link();
+        } else if (node->below_low_key(key, num_cols, operation)) {
+            // 没有向左的链接，交给调用者从根结点开始加锁重新查找
+            page_no = IX_NO_PAGE;
+        } else if (node->beyond_high_key(key, num_cols, operation)) {
+            page_no = node->get_right_link();
+        } else if (node->is_leaf_page()) {
+            return node;
+        } else {
+            page_no = node->internal_lookup(key, num_cols, operation);
+        }
+        node->page->RUnlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 查找操作的目标叶子结点：先做B-link查找，失败时从根结点开始逐层加读锁查找
+ * @return 加了读锁的叶子结点，树为空时返回nullptr
+ * @note need to RUnlatch and unpin the leaf node outside!
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_page_for_read(const char *key, int num_cols, Operation operation,
+                                                    Transaction *transaction) {
+    if (blink_read_) {
+        if (auto leaf = find_leaf_page_blink(key, num_cols, operation)) {
+            return leaf;
+        }
+    }
+    if (is_empty()) {
+        return nullptr;
+    }
+    return find_leaf_page(key, num_cols, operation, transaction, false).first;
+}
+
+/**
+ * @brief 乐观地查找插入、删除的目标叶子结点：与查找一样逐层对内部结点加读锁并释放父结点的读锁，只对叶子结点加写锁
+ * @param key 要查找的目标key值
+ * @param operation 查找到目标键值对后要进行的操作类型，INSERT或DELETE
+ * @return 加了写锁的叶子结点，其祖先结点的锁都已释放
+ * @note 持有父结点的读锁时孩子结点不会被分裂、合并或删除，是否为叶子结点不会改变，可以在加锁之前判断
+ * need to WUnlatch and unpin the leaf node outside!
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_page_optimistic(const char *key, Operation operation) {
+    assert(!is_empty());
+
+    // 根锁只保护根结点的page_no，对根结点加锁后即可释放
+    root_latch_.lock();
+    auto cur_node = fetch_node(file_hdr_->root_page_);
+    if (cur_node->is_leaf_page()) {
+        cur_node->page->WLatch();
+    } else {
+        cur_node->page->RLatch();
+    }
+    root_latch_.unlock();
+
+    while (!cur_node->is_leaf_page()) {
+        auto parent = cur_node;
+        cur_node = fetch_node(parent->internal_lookup(key, file_hdr_->col_num_, operation));
+        if (cur_node->is_leaf_page()) {
+            cur_node->page->WLatch();
+        } else {
+            cur_node->page->RLatch();
+        }
+        parent->page->RUnlatch();
+        buffer_pool_manager_->unpin_page(parent->get_page_id(), false);
+        delete parent;
+    }
+    return cur_node;
+}
+
+/**
+ * @brief 乐观地插入：叶子结点插入后不会分裂、也不用更新祖先结点的键时，只在叶子结点的写锁下完成插入
+ * @param (key, value) 要插入的键值对
+ * @param[out] leaf_page_no 插入到的叶结点的page_no，key重复时为-1
+ * @return 是否完成了插入；返回false时没有做任何修改，需要从根结点开始加写锁重新插入
+ */
+bool IxIndexHandle::try_insert_optimistic(const char *key, const Rid &value, page_id_t *leaf_page_no) {
+    auto leaf = find_leaf_page_optimistic(key, Operation::INSERT);
+    int pos = leaf->lower_bound(key, file_hdr_->col_num_);
+    bool duplicate = pos < leaf->get_size() &&
+                     leaf->compare_key(pos, key, file_hdr_->col_num_) == 0;
+    // 插在第0个位置时祖先结点的键也要修改
+    bool done = duplicate || (pos > 0 && leaf->is_safe(Operation::INSERT));
+    if (done && !duplicate) {
+        leaf->insert_pair(pos, key, value);
+    }
+    *leaf_page_no = duplicate ? -1 : leaf->get_page_no();
+    leaf->page->WUnlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), done && !duplicate);
+    delete leaf;
+    return done;
+}
+
+/**
+ * @brief 乐观地删除：叶子结点删除后不会少于半满时，只在叶子结点的写锁下完成删除
+ * @param key 要删除的key值
+ * @param[out] deleted 是否删除了键值对
+ * @return 是否完成了删除；返回false时没有做任何修改，需要从根结点开始加写锁重新删除
+ */
+bool IxIndexHandle::try_delete_optimistic(const char *key, bool *deleted) {
+    auto leaf = find_leaf_page_optimistic(key, Operation::DELETE);
+    int pos = leaf->lower_bound(key, file_hdr_->col_num_);
+    bool found = pos < leaf->get_size() &&
+                 leaf->compare_key(pos, key, file_hdr_->col_num_) == 0;
+    // 少于半满时要合并或重分配
+    bool done = !found || leaf->is_safe(Operation::DELETE);
+    if (done && found) {
+        leaf->erase_pair(pos);
+    }
+    *deleted = found;
+    leaf->page->WUnlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), done && found);
+    delete leaf;
+    return done;
+}
+
 /**
  * @brief 用于查找指定键在叶子结点中的对应的值result
  *
@@ -335,34 +597,46 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
     // 3. 把rid存入result参数中
     // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
 
-    if (is_empty()) {
-        return false;
-    }
-    auto [leaf_node, is_root_latched] = find_leaf_page(key, Operation::FIND, transaction, false);
+    while (true) {
+        if (is_empty()) {
+            return false;
+        }
+        auto leaf_node = find_leaf_page_for_read(key, file_hdr_->col_num_, Operation::FIND, transaction);
+        if (leaf_node == nullptr) {
+            return false;
+        }
 
-    Rid* rid;
-    if (leaf_node->leaf_lookup(key, &rid)) {
-        result->emplace_back(*rid);
+        Rid* rid;
+        bool found = leaf_node->leaf_lookup(key, &rid);
+        bool retry = false;
+        if (found) {
+            result->emplace_back(*rid);
+        } else if (leaf_node->get_page_no() != file_hdr_->last_leaf_) {
+            // key等于分隔键时落在左边的叶子，目标可能是下一个叶子的第一个键。
+            // 持有当前叶子的读锁时从左向右锁下一个叶子，下一个叶子不会被合并掉；
+            // 删除时会先锁右边的结点再锁左兄弟，这里只尝试加锁，失败时放开当前叶子重新查找
+            auto next_leaf = fetch_node(leaf_node->get_next_leaf());
+            if (next_leaf->page->TryRLatch()) {
+                found = next_leaf->get_size() > 0 && next_leaf->compare_key(0, key, file_hdr_->col_num_) == 0;
+                if (found) {
+                    result->emplace_back(*next_leaf->get_rid(0));
+                }
+                next_leaf->page->RUnlatch();
+            } else {
+                retry = true;
+            }
+            buffer_pool_manager_->unpin_page(next_leaf->get_page_id(), false);
+            delete next_leaf;
+        }
         // 先释放读锁再unpin!
         leaf_node->page->RUnlatch();
         buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), false);
-        return true;
-    }
-    else if (leaf_node->get_page_no() != file_hdr_->last_leaf_) {
-        auto next_leaf = fetch_node(leaf_node->get_next_leaf());
-        buffer_pool_manager_->unpin_page(next_leaf->get_page_id(), false);
-        if (ix_compare(next_leaf->get_key(0), key, file_hdr_->col_types_, file_hdr_->col_lens_) == 0) {
-            result->emplace_back(*next_leaf->get_rid(0));
-            // 先释放读锁再unpin!
-            leaf_node->page->RUnlatch();
-            buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), false);
-            return true;
+        delete leaf_node;
+        if (!retry) {
+            return found;
         }
+        std::this_thread::yield();
     }
-    // 先释放读锁再unpin!
-    leaf_node->page->RUnlatch();
-    buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), false);
-    return false;
 }
 
 /**
@@ -385,8 +659,8 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
     // 申请新的页面 id
     auto new_NodeHandle = create_node();
     new_NodeHandle->page->WLatch();
-    // 拆分点
-    int split_point = node->get_min_size();
+    // 拆分点，压缩了前缀的叶子装满时的键值对数量多于不压缩的
+    int split_point = node->get_size() / 2;
     // 初始化新节点页头信息
     new_NodeHandle->page_hdr->is_leaf = node->page_hdr->is_leaf;
     new_NodeHandle->page_hdr->parent = node->page_hdr->parent;
@@ -403,14 +677,17 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
         next_NodeHandle->page->WUnlatch();
         assert(buffer_pool_manager_->unpin_page(next_NodeHandle->get_page_id(), true));
     }
+    // 新结点接在node的右边，以拆分点的键为分界；两个结点的范围都缩小，先确定新结点的范围和前缀再放入键值对
+    char split_key[IX_MAX_COL_LEN];
+    node->copy_key(split_point, split_key);
+    new_NodeHandle->set_low_key(split_key);
+    new_NodeHandle->set_high_key(node->get_high_key(), node->get_right_link());
+    update_prefix(new_NodeHandle);
     // 为新节点分配键值对，更新旧节点的键值对数记录
-    new_NodeHandle->insert_pairs(0, node->keys + split_point * file_hdr_->col_tot_len_, node->rids + split_point, node->get_size() - split_point);
-    // int oo = new_NodeHandle->key_at(0);
-    auto node_size = node->get_size();
-    for (int idx = node_size - 1; idx >= split_point; --idx) {
-        node->erase_pair(idx);
-    }
-    node->page_hdr->num_key = split_point;
+    new_NodeHandle->insert_pairs(0, node, split_point, node->get_size() - split_point);
+    node->set_size(split_point);
+    node->set_high_key(split_key, new_NodeHandle->get_page_no());
+    update_prefix(node);
     if (!new_NodeHandle->is_leaf_page()) {
         for (int child_idx = 0; child_idx < new_NodeHandle->get_size(); ++child_idx) {
             maintain_child(new_NodeHandle, child_idx);
@@ -451,10 +728,13 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
         old_node->set_parent_page_no(new_root_node->get_page_no());
         new_node->set_parent_page_no(new_root_node->get_page_no());
 
-        file_hdr_->root_page_ = new_root_node->get_page_no();
         // k个键对应k个个节点，内部节点第一个键存储第一个孩子节点的第一个键盘，保证存的是子树的最小键
-        new_root_node->insert_pair(0, old_node->get_key(0), {old_node->get_page_no()});
+        char first_key[IX_MAX_COL_LEN];
+        old_node->copy_key(0, first_key);
+        new_root_node->insert_pair(0, first_key, {old_node->get_page_no()});
         new_root_node->insert_pair(1, key, {new_node->get_page_no()});
+        // 读者不加根锁，初始化完毕后才能发布新的根；还停在旧的根上的读者沿right_link找到分裂出的结点
+        update_root_page_no(new_root_node->get_page_no());
         assert(buffer_pool_manager_->unpin_page(new_root_node->get_page_id(), true));
     }
     else {
@@ -469,7 +749,7 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
             auto new_parent_node = split(parent_node);
             BufferPoolManager::mark_dirty(new_parent_node->page);
             transaction->append_index_latch_page_set(new_parent_node->page);
-            insert_into_parent(parent_node, new_parent_node->get_key(0), new_parent_node, transaction);
+            insert_into_parent(parent_node, new_parent_node->get_low_key(), new_parent_node, transaction);
             // assert(buffer_pool_manager_->unpin_page(new_parent_node->get_page_id(), true));
         }
         // unpin pages !
@@ -504,8 +784,8 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     auto first_leaf = fetch_node(file_hdr_->first_leaf_);
     // 加读锁锁住再比较
     first_leaf->page->RLatch();
-    // 如果第一个叶子节点的最小值比key大，说明要插在第一个位置
-    int cmp = ix_compare(first_leaf->get_key(0), key, file_hdr_->col_types_, file_hdr_->col_lens_);
+    // 如果第一个叶子节点的最小值比key大，说明要插在第一个位置；新建的索引的根是没有键的叶子，也插在第一个位置
+    int cmp = first_leaf->get_size() == 0 ? 1 : first_leaf->compare_key(0, key, file_hdr_->col_num_);
     first_leaf->page->RUnlatch();
     buffer_pool_manager_->unpin_page(first_leaf->get_page_id(), false);
 
@@ -513,7 +793,15 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     if (cmp == 0) return -1;
     bool find_first = cmp > 0;
 
-    auto [leaf_node, is_root_latched] = find_leaf_page(key, Operation::INSERT, transaction, find_first);
+    // 大多数插入不会分裂叶子结点，先只对叶子结点加写锁尝试插入，避免所有插入都在根结点上串行
+    if (optimistic_latch_ && !find_first) {
+        page_id_t leaf_page_no;
+        if (try_insert_optimistic(key, value, &leaf_page_no)) {
+            return leaf_page_no;
+        }
+    }
+
+    auto [leaf_node, is_root_latched] = find_leaf_page(key, file_hdr_->col_num_, Operation::INSERT, transaction, find_first);
     int sz = leaf_node->get_size();
     // 如果插入重复值，直接结束
     if (leaf_node->insert(key, value) == sz) {
@@ -526,7 +814,10 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
         }
         return -1;
     }
-    maintain_parent(leaf_node);
+    // 只有插在第一个叶子的最前面时叶子的第一个键才会改变，此时祖先结点都加了写锁；其余情况祖先结点可能已经解锁，不能访问
+    if (find_first) {
+        maintain_parent(leaf_node);
+    }
 
     if (leaf_node->is_full()) {
         auto new_leaf_node = split(leaf_node);
@@ -534,7 +825,8 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
         transaction->append_index_latch_page_set(new_leaf_node->page);
         // unpin outside!
         // buffer_pool_manager_->unpin_page(new_leaf_node->get_page_id(), true);
-        insert_into_parent(leaf_node, new_leaf_node->get_key(0), new_leaf_node, transaction);
+        // 新叶子可能省略了前缀，分隔键取其低键
+        insert_into_parent(leaf_node, new_leaf_node->get_low_key(), new_leaf_node, transaction);
         if (new_leaf_node->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
             file_hdr_->last_leaf_ = new_leaf_node->get_page_no();
         }
@@ -552,6 +844,193 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     return leaf_node->get_page_no();
 }
 
+/**
+ * @brief 判断树中是否没有任何键值对：没有根结点，或者根结点是没有键的叶子结点
+ */
+bool IxIndexHandle::is_empty_tree() {
+    std::scoped_lock lock{root_latch_};
+    if (is_empty()) {
+        return true;
+    }
+    Page *root_page = buffer_pool_manager_->fetch_page(PageId{fd_, file_hdr_->root_page_});
+    IxNodeHandle root(file_hdr_, root_page);
+    bool empty = root.is_leaf_page() && root.get_size() == 0;
+    buffer_pool_manager_->unpin_page(root_page->get_page_id(), false);
+    return empty;
+}
+
+/**
+ * @brief 自底向上建树：已排序的键值对依次装满叶子结点，再用每个结点的最小键逐层建立内部结点，
+ * 每个结点只写一次，不需要逐条insert_entry时的查找和分裂。只能用于空树
+ *
+ * @param keys 按升序排列且互不相同的n个键，每个键长col_tot_len
+ * @param rids 与keys一一对应的记录号
+ * @param n 键值对的数量
+ * @param fill_percent 结点的填充率
+ * @return bool 树不为空时不做任何修改，返回false
+ */
+bool IxIndexHandle::bulk_load(const char *keys, const Rid *rids, int n, int fill_percent) {
+    auto loader = begin_bulk_load(n, fill_percent);
+    if (loader == nullptr) {
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        loader->append(keys + static_cast<size_t>(i) * file_hdr_->col_tot_len_, rids[i]);
+    }
+    loader->finish();
+    return true;
+}
+
+/**
+ * @brief 开始自底向上建树，键值对由调用者按升序逐个追加，不必一次放在内存中
+ *
+ * @param n 键值对的数量，键值对据此平均分到各个叶子
+ * @param fill_percent 结点的填充率，取值(0, 100]，结点至少半满
+ * @return std::unique_ptr<IxBulkLoader> 树不为空时返回nullptr
+ */
+std::unique_ptr<IxBulkLoader> IxIndexHandle::begin_bulk_load(size_t n, int fill_percent) {
+    std::unique_lock lock{root_latch_};
+    // 新建的索引的根是没有键的叶子结点，复用为第一个叶子；树被删空后没有根，第一个叶子需要新建
+    Page *first_page = nullptr;
+    if (!is_empty()) {
+        first_page = buffer_pool_manager_->fetch_page(PageId{fd_, file_hdr_->root_page_});
+        IxNodeHandle root(file_hdr_, first_page);
+        if (!root.is_leaf_page() || root.get_size() != 0) {
+            buffer_pool_manager_->unpin_page(first_page->get_page_id(), false);
+            return nullptr;
+        }
+    }
+    int fill = std::clamp(file_hdr_->btree_order_ * fill_percent / 100, get_min_size(), file_hdr_->btree_order_);
+    return std::unique_ptr<IxBulkLoader>(new IxBulkLoader(this, std::move(lock), first_page, n, fill));
+}
+
+IxBulkLoader::IxBulkLoader(IxIndexHandle *ih, std::unique_lock<std::mutex> lock, Page *first_page, size_t n,
+                           int fill)
+    : ih_(ih), lock_(std::move(lock)), first_page_(first_page), n_(n), fill_(fill) {
+    num_leaves_ = (n_ + fill_ - 1) / fill_;
+    level_pages_.reserve(num_leaves_);
+    level_keys_.reserve(num_leaves_ * ih_->file_hdr_->col_tot_len_);
+}
+
+/**
+ * @brief 追加一个键值对，当前叶子装满时换一个新的叶子
+ *
+ * @param key 键，长度为col_tot_len，须大于之前追加的键
+ * @param rid 键对应的记录号
+ */
+void IxBulkLoader::append(const char *key, const Rid &rid) {
+    assert(!finished_ && count_ < n_);
+    if (count_ == leaf_end_) {
+        start_leaf(key);
+    }
+    IxNodeHandle leaf(ih_->file_hdr_, leaf_);
+    leaf.insert_pair(leaf.get_size(), key, rid);
+    count_++;
+}
+
+/**
+ * @brief 开始下一个叶子，并与前一个叶子链接起来；键值对平均分到各个叶子，最后一个叶子不会过空
+ */
+void IxBulkLoader::start_leaf(const char *first_key) {
+    auto file_hdr = ih_->file_hdr_;
+    size_t i = level_pages_.size();
+    leaf_end_ = n_ * (i + 1) / num_leaves_;
+    Page *page = i == 0 && first_page_ != nullptr ? first_page_ : new_node_page();
+    IxNodeHandle leaf(file_hdr, page);
+    leaf.page_hdr->next_free_page_no = IX_NO_PAGE;
+    leaf.page_hdr->parent = IX_NO_PAGE;
+    leaf.page_hdr->is_leaf = true;
+    leaf.page_hdr->prev_leaf = leaf_ == nullptr ? IX_LEAF_HEADER_PAGE : leaf_->get_page_id().page_no;
+    leaf.page_hdr->next_leaf = IX_LEAF_HEADER_PAGE;
+    leaf.page_hdr->is_deleted = false;
+    leaf.page_hdr->prefix_len = 0;
+    leaf.set_low_key(leaf_ == nullptr ? nullptr : first_key);
+    leaf.set_high_key(nullptr, IX_NO_PAGE);
+    leaf.set_size(0);
+    if (leaf_ != nullptr) {
+        IxNodeHandle prev(file_hdr, leaf_);
+        prev.set_next_leaf(leaf.get_page_no());
+        prev.set_high_key(first_key, leaf.get_page_no());
+        ih_->update_prefix(&prev);
+        ih_->buffer_pool_manager_->unpin_page(leaf_->get_page_id(), true);
+    }
+    leaf_ = page;
+    level_pages_.push_back(leaf.get_page_no());
+    level_keys_.insert(level_keys_.end(), first_key, first_key + file_hdr->col_tot_len_);
+}
+
+/**
+ * @brief 结束叶子层，逐层向上建立内部结点，直到只剩一个结点作为根，然后释放根结点锁
+ */
+void IxBulkLoader::finish() {
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+    auto file_hdr = ih_->file_hdr_;
+    auto buffer_pool_manager = ih_->buffer_pool_manager_;
+    int key_len = file_hdr->col_tot_len_;
+    if (leaf_ == nullptr) {
+        if (first_page_ != nullptr) {
+            buffer_pool_manager->unpin_page(first_page_->get_page_id(), false);
+        }
+        lock_.unlock();
+        return;
+    }
+    buffer_pool_manager->unpin_page(leaf_->get_page_id(), true);
+    leaf_ = nullptr;
+    file_hdr->first_leaf_ = level_pages_.front();
+    file_hdr->last_leaf_ = level_pages_.back();
+    Page *leaf_header = buffer_pool_manager->fetch_page(PageId{ih_->fd_, IX_LEAF_HEADER_PAGE});
+    IxNodeHandle header(file_hdr, leaf_header);
+    header.set_next_leaf(file_hdr->first_leaf_);
+    header.set_prev_leaf(file_hdr->last_leaf_);
+    buffer_pool_manager->unpin_page(leaf_header->get_page_id(), true);
+
+    while (level_pages_.size() > 1) {
+        std::vector<page_id_t> upper_pages;
+        std::vector<char> upper_keys;
+        size_t num_children = level_pages_.size();
+        size_t num_nodes = (num_children + fill_ - 1) / fill_;
+        upper_pages.reserve(num_nodes);
+        upper_keys.reserve(num_nodes * key_len);
+        // 同一层的结点先全部分配好，每个结点写入时就能指向右兄弟
+        std::vector<Page *> pages(num_nodes);
+        for (size_t i = 0; i < num_nodes; i++) {
+            pages[i] = new_node_page();
+            upper_pages.push_back(pages[i]->get_page_id().page_no);
+        }
+        for (size_t i = 0; i < num_nodes; i++) {
+            size_t begin = num_children * i / num_nodes;
+            size_t end = num_children * (i + 1) / num_nodes;
+            IxNodeHandle node(file_hdr, pages[i]);
+            node.set_low_key(i == 0 ? nullptr : level_keys_.data() + begin * key_len);
+            node.set_high_key(level_keys_.data() + end * key_len, i + 1 < num_nodes ? upper_pages[i + 1] : IX_NO_PAGE);
+            node.page_hdr->next_free_page_no = IX_NO_PAGE;
+            node.page_hdr->parent = IX_NO_PAGE;
+            node.page_hdr->is_leaf = false;
+            node.page_hdr->prev_leaf = IX_NO_PAGE;
+            node.page_hdr->next_leaf = IX_NO_PAGE;
+            for (size_t j = begin; j < end; j++) {
+                node.set_key(j - begin, &level_keys_[j * key_len]);
+                node.set_rid(j - begin, {level_pages_[j], 0});
+                Page *child = buffer_pool_manager->fetch_page(PageId{ih_->fd_, level_pages_[j]});
+                IxNodeHandle(file_hdr, child).set_parent_page_no(node.get_page_no());
+                buffer_pool_manager->unpin_page(child->get_page_id(), true);
+            }
+            node.set_size(end - begin);
+            upper_keys.insert(upper_keys.end(), &level_keys_[begin * key_len], &level_keys_[(begin + 1) * key_len]);
+            buffer_pool_manager->unpin_page(node.get_page_id(), true);
+        }
+        level_pages_ = std::move(upper_pages);
+        level_keys_ = std::move(upper_keys);
+    }
+    ih_->update_root_page_no(level_pages_.front());
+    lock_.unlock();
+}
+
+Page *IxBulkLoader::new_node_page() { return std::unique_ptr<IxNodeHandle>(ih_->create_node())->page; }
+
 /**
  * @brief 用于删除B+树中含有指定key的键值对
  * @param key 要删除的key值
@@ -573,15 +1052,21 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
     auto first_leaf = fetch_node(file_hdr_->first_leaf_);
     // 加读锁锁住再比较
     first_leaf->page->RLatch();
-    // 如果第一个叶子节点的最小值比key大，说明要插在第一个位置
-    int cmp = ix_compare(first_leaf->get_key(0), key, file_hdr_->col_types_, file_hdr_->col_lens_);
+    // 如果第一个叶子节点的最小值比key大，说明key不存在；没有键的叶子中也不存在
+    int cmp = first_leaf->get_size() == 0 ? 1 : first_leaf->compare_key(0, key, file_hdr_->col_num_);
     first_leaf->page->RUnlatch();
     buffer_pool_manager_->unpin_page(first_leaf->get_page_id(), false);
 
     if (cmp > 0) return false;
-    bool find_first = cmp == 0;
 
-    auto [leaf_node, is_root_latched] = find_leaf_page(key, Operation::DELETE, transaction, find_first);
+    if (optimistic_latch_) {
+        bool deleted;
+        if (try_delete_optimistic(key, &deleted)) {
+            return deleted;
+        }
+    }
+
+    auto [leaf_node, is_root_latched] = find_leaf_page(key, file_hdr_->col_num_, Operation::DELETE, transaction, false);
     int pre = leaf_node->page_hdr->num_key;
     // 删除失败 找不到
     if (pre == leaf_node->remove(key)) {
@@ -591,15 +1076,10 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
         }
         return false;
     }
-    // 维护父节点第一个键为其第一个孩子节点的第一个键
-    maintain_parent(leaf_node);
+    // 删除叶子的第一个键时不修改父结点中的分隔键：分隔键是孩子结点的低键，也是左兄弟的高键，必须保持不变
     coalesce_or_redistribute(leaf_node, transaction, &is_root_latched);
+    // 被合并掉的结点留在文件中供并发的读者跳转，不从缓冲池中删除；页面号本来就不会复用
     unlock_page_set(transaction);
-    for (auto& page : *transaction->get_index_deleted_page_set()) {
-        // assert(buffer_pool_manager_->delete_page(page->get_page_id()));
-        buffer_pool_manager_->delete_page(page->get_page_id());
-    }
-    transaction->get_index_deleted_page_set()->clear();
     if (is_root_latched) {
         root_latch_.unlock();
     }
@@ -629,11 +1109,7 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
     // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
 
     if (node->is_root_page()) {
-        bool is_delete = adjust_root(node);
-        if (is_delete) {
-            transaction->append_index_deleted_page(node->page);
-        }
-        return is_delete;
+        return adjust_root(node);
     }
     // 大于等于半满，不需要合并或重分配
     if (node->get_size() >= node->get_min_size()) {
@@ -681,13 +1157,18 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
     if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {
         auto new_root = fetch_node(old_root_node->remove_and_return_only_child());
         new_root->set_parent_page_no(IX_NO_PAGE);
-        file_hdr_->root_page_ = new_root->get_page_no();
+        update_root_page_no(new_root->get_page_no());
+        // 还停在旧的根上的读者跳转到新的根
+        old_root_node->mark_deleted(new_root->get_page_no());
+        BufferPoolManager::mark_dirty(old_root_node->page);
         release_node_handle(*old_root_node);
         buffer_pool_manager_->unpin_page(new_root->get_page_id(), true);
         return true;
     }
     else if (old_root_node->is_leaf_page() && old_root_node->get_size() == 0) {
         erase_leaf(old_root_node);
+        old_root_node->mark_deleted(IX_NO_PAGE);
+        BufferPoolManager::mark_dirty(old_root_node->page);
         release_node_handle(*old_root_node);
         update_root_page_no(IX_NO_PAGE);
         return true;
@@ -720,13 +1201,19 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
     // node(left)      neighbor(right)
     // move sibling page's first key* & value pair into end of input "node"
 
+    // node的范围扩大，先解压；node不到半满，解压后一定放得下
+    node->set_prefix_len(0);
+    char key[IX_MAX_COL_LEN];
     if (!index) {
-        node->insert_pair(node->get_size(), neighbor_node->keys, *neighbor_node->rids);
+        node->insert_pairs(node->get_size(), neighbor_node, 0, 1);
         neighbor_node->erase_pair(0);
         // 更新父节点index + 1对应为右兄弟节点的第一个
         // 以满足小于index + 1的key指向node，大于等于index的key指向右兄弟
         // 因为index + 1 > 0，不会改变父节点第一个键值，所以父节点的父节点不需要更新
-        parent->set_key(index + 1, neighbor_node->get_key(0));
+        neighbor_node->copy_key(0, key);
+        parent->set_key(index + 1, key);
+        node->set_high_key(key, neighbor_node->get_page_no());
+        neighbor_node->set_low_key(key);
         // 修改移动键值对的孩子节点的父节点信息
         maintain_child(node, node->get_size() - 1);
     }
@@ -734,15 +1221,20 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
     // move sibling page's last key* & value pair into head of input "node"
     else {
         int end_idx = neighbor_node->get_size() - 1;
-        node->insert_pair(0, neighbor_node->get_key(end_idx), *neighbor_node->get_rid(end_idx));
+        node->insert_pairs(0, neighbor_node, end_idx, 1);
         neighbor_node->erase_pair(end_idx);
         // 更新父节点index对应为node节点的第一个
         // 以满足小于index的key指向左兄弟，大于等于index的key指向node
         // 同理，因为index > 0，不会改变父节点第一个键值，所以父节点的父节点不需要更新
-        parent->set_key(index, node->get_key(0));
+        node->copy_key(0, key);
+        parent->set_key(index, key);
+        node->set_low_key(key);
+        neighbor_node->set_high_key(key, node->get_page_no());
         // 修改移动键值对的孩子节点的父节点信息
         maintain_child(node, 0);
     }
+    update_prefix(node);
+    update_prefix(neighbor_node);
 }
 
 /**
@@ -776,7 +1268,9 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
     }
 
     auto prev_idx = (*neighbor_node)->get_size();
-    (*neighbor_node)->insert_pairs((*neighbor_node)->get_size(), (*node)->keys, (*node)->rids, (*node)->get_size());
+    // 左结点的范围扩大，先解压；合并时两个结点的键值对少于不压缩时的容量
+    (*neighbor_node)->set_prefix_len(0);
+    (*neighbor_node)->insert_pairs((*neighbor_node)->get_size(), *node, 0, (*node)->get_size());
     for (int child_idx = prev_idx; child_idx < (*neighbor_node)->get_size(); ++child_idx) {
         maintain_child(*neighbor_node, child_idx);
     }
@@ -789,12 +1283,11 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
         file_hdr_->last_leaf_ = (*neighbor_node)->get_page_no();
     }
 
-    // ! important 同时删除缓冲区结点对应的页面
-    // 两种情况
-    // 未交换 node：删除之前unlatch&unpin，兄弟节点：刷脏&unlatch&unpin
-    // 交换了 node：刷脏&unlatch&unpin，兄弟节点：删除之前unlatch&unpin
-    // 被删除的页不用考虑刷脏，因为无论如何都会写回磁盘，被重置
-    transaction->append_index_deleted_page((*node)->page);
+    // 左结点接管node的范围；node留作标记，还停在node上的读者跳转到左结点
+    (*neighbor_node)->set_high_key((*node)->get_high_key(), (*node)->get_right_link());
+    update_prefix(*neighbor_node);
+    (*node)->mark_deleted((*neighbor_node)->get_page_no());
+    BufferPoolManager::mark_dirty((*node)->page);
     release_node_handle(**node);
     BufferPoolManager::mark_dirty((*neighbor_node)->page);
     (*parent)->erase_pair(index);
@@ -828,17 +1321,21 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * @brief FindLeafPage + lower_bound
  *
  * @param key
+ * @param num_cols key参与比较的字段数量，多列索引只比较前num_cols个字段，查找第一个前缀不小于key的位置
  * @return Iid
  * @note 上层传入的key本来是int类型，通过(const char *)&key进行了转换
  * 可用*(int *)key转换回去
  */
-Iid IxIndexHandle::lower_bound(const char *key, Transaction *transaction) {
+Iid IxIndexHandle::lower_bound(const char *key, int num_cols, Transaction *transaction) {
     if (is_empty()) {
         return Iid{-1, -1};
     }
-    auto [leaf, is_root_latched] = find_leaf_page(key, Operation::FIND_LOWER, transaction, false);
+    auto leaf = find_leaf_page_for_read(key, num_cols, Operation::FIND_LOWER, transaction);
+    if (leaf == nullptr) {
+        return Iid{-1, -1};
+    }
     Iid iid;
-    int pos = leaf->lower_bound(key);
+    int pos = leaf->lower_bound(key, num_cols);
     if (pos == leaf->get_size()) {
         if (file_hdr_->last_leaf_ == leaf->get_page_no()) {
             iid = leaf_end();
@@ -857,15 +1354,19 @@ Iid IxIndexHandle::lower_bound(const char *key, Transaction *transaction) {
  * @brief FindLeafPage + upper_bound
  *
  * @param key
+ * @param num_cols key参与比较的字段数量，查找第一个前缀大于key的位置
  * @return Iid
  */
-Iid IxIndexHandle::upper_bound(const char *key, Transaction *transaction) {
+Iid IxIndexHandle::upper_bound(const char *key, int num_cols, Transaction *transaction) {
     if (is_empty()) {
         return Iid{-1, -1};
     }
-    auto [leaf, is_root_latched] = find_leaf_page(key, Operation::FIND_UPPER, transaction, false);
-    int cmp = ix_compare(leaf->get_key(0), key, file_hdr_->col_types_, file_hdr_->col_lens_);
-    int pos = leaf->upper_bound(key);
+    auto leaf = find_leaf_page_for_read(key, num_cols, Operation::FIND_UPPER, transaction);
+    if (leaf == nullptr) {
+        return Iid{-1, -1};
+    }
+    int cmp = leaf->compare_key(0, key, num_cols);
+    int pos = leaf->upper_bound(key, num_cols);
     // 如果要找的key在叶子节点最右端，则pos = leaf_size，此时 iid{no, pos}
     // 如果key延续到最右段 则iid{no, pos}
     // 需要leaf_end，因为scan到不了size
@@ -941,6 +1442,10 @@ IxNodeHandle *IxIndexHandle::create_node() {
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
     Page *page = buffer_pool_manager_->new_page(&new_page_id);
     node = new IxNodeHandle(file_hdr_, page);
+    node->set_low_key(nullptr);
+    node->set_high_key(nullptr, IX_NO_PAGE);
+    node->page_hdr->is_deleted = false;
+    node->page_hdr->prefix_len = 0;
     return node;
 }
 
@@ -957,8 +1462,8 @@ void IxIndexHandle::create_new_tree(const char *key, const Rid &rid) {
     leaf_head->page_hdr->next_leaf = new_root->get_page_no();
     new_root->page_hdr->prev_leaf = leaf_head->get_page_no();
     new_root->page_hdr->next_leaf = leaf_head->get_page_no();
-    update_root_page_no(new_root->get_page_no());
     new_root->insert_pair(0, key, rid);
+    update_root_page_no(new_root->get_page_no());
     buffer_pool_manager_->unpin_page(leaf_head->get_page_id(), true);
     buffer_pool_manager_->unpin_page(new_root->get_page_id(), true);
 }
@@ -976,7 +1481,8 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
         IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
         int rank = parent->find_child(curr);
         char *parent_key = parent->get_key(rank);
-        char *child_first_key = curr->get_key(0);
+        char child_first_key[IX_MAX_COL_LEN];
+        curr->copy_key(0, child_first_key);
         if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
             assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
             break;
@@ -984,6 +1490,19 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
         memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
         curr = parent;
         assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        // 父结点的第一个键没有改变，更上层的结点不用修改，也可能已经解锁
+        if (rank != 0) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 叶子结点的范围缩小后，按低键和高键的公共前缀重新压缩；关闭前缀压缩时不再压缩，已经压缩的保持不变
+ */
+void IxIndexHandle::update_prefix(IxNodeHandle *node) {
+    if (prefix_compression_) {
+        node->set_prefix_len(node->common_prefix_len(node->get_low_key(), node->get_high_key()));
     }
 }
 
@@ -10,7 +10,11 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+
 #include "ix_defs.h"
+#include "ix_search.h"
 #include "transaction/transaction.h"
 #include "common/rwlatch.h"
 
@@ -45,49 +49,86 @@ inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
     }
 }
 
-inline int ix_compare(const char* a, const char* b, const std::vector<ColType>& col_types, const std::vector<int>& col_lens) {
+/**
+ * @description: 按字段类型逐个比较两个多列键的前num_cols个字段，前num_cols个字段都相同时认为相等，
+ * 即num_cols小于字段数时按最左前缀匹配，用于多列索引只给出前几个字段的范围查找
+ * @param {int} num_cols 参与比较的字段数量，范围为[1, col_types.size()]
+ */
+inline int ix_compare(const char *a, const char *b, const std::vector<ColType> &col_types,
+                      const std::vector<int> &col_lens, int num_cols) {
     int offset = 0;
-    int tot_col_lens = 0;
-    for (int col_len : col_lens) { tot_col_lens += col_len; }
-    int fed_size = *(int*)(b + tot_col_lens);
-    fed_size = fed_size < col_lens.size() - 1 ? fed_size : col_lens.size() - 1;
-    if (fed_size == -1) fed_size = col_lens.size() - 1;
-    for(size_t i = 0; i <= fed_size; ++i) {
+    for (int i = 0; i < num_cols; ++i) {
         int res = ix_compare(a + offset, b + offset, col_types[i], col_lens[i]);
-        if(res != 0) return res;
+        if (res != 0) return res;
+        offset += col_lens[i];
+    }
+    return 0;
+}
+
+/**
+ * @description: 比较叶子结点中省略了前缀的键a与完整的键b的前num_cols个字段，
+ * 前缀在第一个字段(字符串)之内，已经确定与b的前缀相同
+ * @param {int} prefix_len a省略的前缀长度，大于0
+ */
+inline int ix_compare_suffix(const char *a, const char *b, const std::vector<ColType> &col_types,
+                             const std::vector<int> &col_lens, int prefix_len, int num_cols) {
+    int res = memcmp(a, b + prefix_len, col_lens[0] - prefix_len);
+    if (res != 0) return res;
+    int offset = col_lens[0];
+    for (int i = 1; i < num_cols; ++i) {
+        res = ix_compare(a + offset - prefix_len, b + offset, col_types[i], col_lens[i]);
+        if (res != 0) return res;
         offset += col_lens[i];
     }
     return 0;
 }
 
+// 比较两个完整的键的全部字段
+inline int ix_compare_keys(const char *a, const char *b, const std::vector<ColType> &col_types,
+                           const std::vector<int> &col_lens) {
+    return ix_compare(a, b, col_types, col_lens, static_cast<int>(col_types.size()));
+}
+
 /* 管理B+树中的每个节点 */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
+    friend class IxBulkLoader;
 
    private:
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
     Page *page;                     // 存储节点的页面
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
-    char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
-    Rid *rids;                      // page->data的第三部分，指针指向首地址
+    char *bound_keys;               // page->data的第二部分，依次存放低键和高键，长度都为col_tot_len
+    char *keys;                     // page->data的第三部分，存放get_max_size()个键，每个key的长度为key_len()
+    // page->data的第四部分rids紧跟在keys之后，叶子结点省略的前缀长度改变时位置会变，由get_rids()计算
 
    public:
     IxNodeHandle() = default;
 
     IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
-        rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+        bound_keys = page->get_data() + sizeof(IxPageHdr);
+        keys = bound_keys + 2 * file_hdr->col_tot_len_;
     }
 
     int get_size() { return page_hdr->num_key; }
 
     void set_size(int size) { page_hdr->num_key = size; }
 
-    int get_max_size() { return file_hdr->btree_order_ + 1; }
+    int get_max_size() const { return max_size(page_hdr->prefix_len); }
 
-    int get_min_size() { return get_max_size() / 2; }
+    // 省略prefix_len个字节的前缀时结点能存放的键值对数量，不压缩时为btree_order + 1
+    int max_size(int prefix_len) const {
+        if (prefix_len == 0) {
+            return file_hdr->btree_order_ + 1;
+        }
+        return static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr) - 2 * file_hdr->col_tot_len_) /
+                                (file_hdr->col_tot_len_ - prefix_len + sizeof(Rid)));
+    }
+
+    // 压缩了前缀的叶子也按不压缩时的容量计算半满，两个结点合并前一定能解压放进一个结点
+    int get_min_size() { return (file_hdr->btree_order_ + 1) / 2; }
 
     bool is_full() { return get_size() >= get_max_size(); }
 
@@ -118,21 +159,80 @@ class IxNodeHandle {
 
     void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    /* B-link：结点的键都在[低键, 高键)中，高键等于右兄弟的低键；没有低键或右兄弟时对应的一侧没有界限 */
+    page_id_t get_right_link() { return page_hdr->right_link; }
+
+    bool is_deleted() { return page_hdr->is_deleted; }
+
+    const char *get_low_key() const { return page_hdr->has_low_key ? bound_keys : nullptr; }
+
+    const char *get_high_key() const { return page_hdr->right_link != IX_NO_PAGE ? bound_keys + file_hdr->col_tot_len_ : nullptr; }
+
+    // low_key为nullptr时结点没有低键
+    void set_low_key(const char *low_key) {
+        page_hdr->has_low_key = low_key != nullptr;
+        if (low_key != nullptr) {
+            memcpy(bound_keys, low_key, file_hdr->col_tot_len_);
+        }
+    }
+
+    // right_link为IX_NO_PAGE时结点没有高键
+    void set_high_key(const char *high_key, page_id_t right_link) {
+        page_hdr->right_link = right_link;
+        if (right_link != IX_NO_PAGE) {
+            memcpy(bound_keys + file_hdr->col_tot_len_, high_key, file_hdr->col_tot_len_);
+        }
+    }
+
+    // 合并掉结点，并发的读者从这里跳转到接收其键值对的结点
+    void mark_deleted(page_id_t link) {
+        page_hdr->is_deleted = true;
+        page_hdr->right_link = link;
+    }
+
+    // 查找用的key只有前num_cols个字段参与比较，插入、删除用的key是完整的键，num_cols为字段数量
+    bool below_low_key(const char *key, int num_cols, Operation operation) const;
+
+    bool beyond_high_key(const char *key, int num_cols, Operation operation) const;
+
+    // 结点中存放的每个键的长度，叶子结点省略了前缀
+    int key_len() const { return file_hdr->col_tot_len_ - page_hdr->prefix_len; }
+
+    // 叶子结点省略了前缀时得到的是键的后缀，完整的键用copy_key取出，用compare_key比较
+    char *get_key(int key_idx) const { return keys + key_idx * key_len(); }
+
+    Rid *get_rids() const { return reinterpret_cast<Rid *>(keys + get_max_size() * key_len()); }
+
+    Rid *get_rid(int rid_idx) const { return get_rids() + rid_idx; }
+
+    // key为完整的键
+    void set_key(int key_idx, const char *key) { memcpy(get_key(key_idx), key + page_hdr->prefix_len, key_len()); }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    void set_rid(int rid_idx, const Rid &rid) { *get_rid(rid_idx) = rid; }
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    // 把第key_idx个键还原成完整的键写入dest
+    void copy_key(int key_idx, char *dest) const {
+        memcpy(dest, bound_keys, page_hdr->prefix_len);
+        memcpy(dest + page_hdr->prefix_len, get_key(key_idx), key_len());
+    }
+
+    int compare_key(int key_idx, const char *target, int num_cols) const;
+
+    int common_prefix_len(const char *low_key, const char *high_key) const;
+
+    void set_prefix_len(int prefix_len);
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    int lower_bound(const char *target, int num_cols) const;
 
-    int lower_bound(const char *target) const;
+    int upper_bound(const char *target, int num_cols) const;
 
-    int upper_bound(const char *target) const;
+    int search(const char *target, int num_cols, int begin, bool upper) const;
 
     void insert_pairs(int pos, const char *key, const Rid *rid, int n);
 
-    page_id_t internal_lookup(const char *key, Operation operation);
+    void insert_pairs(int pos, const IxNodeHandle *src, int begin, int n);
+
+    page_id_t internal_lookup(const char *key, int num_cols, Operation operation);
 
     bool leaf_lookup(const char *key, Rid **value);
 
@@ -175,10 +275,13 @@ class IxNodeHandle {
     }
 };
 
+class IxBulkLoader;
+
 /* B+树 */
 class IxIndexHandle {
     friend class IxScan;
     friend class IxManager;
+    friend class IxBulkLoader;
 
    private:
     DiskManager *disk_manager_;
@@ -186,6 +289,9 @@ class IxIndexHandle {
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
     std::mutex root_latch_;
+    bool optimistic_latch_ = true;              // 插入、删除时先只对叶子结点加写锁，需要修改内部结点时再从根重新加锁
+    bool blink_read_ = true;                    // 查找时不加根锁，每次只锁一个结点，沿right_link追上并发的分裂
+    bool prefix_compression_ = true;            // 第一个字段是字符串时，叶子结点省略低键和高键的公共前缀
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
@@ -194,11 +300,17 @@ class IxIndexHandle {
 
     int get_min_size() { return get_max_size() / 2; }
 
+    void set_optimistic_latch(bool optimistic) { optimistic_latch_ = optimistic; }
+
+    void set_blink_read(bool blink) { blink_read_ = blink; }
+
+    void set_prefix_compression(bool compress) { prefix_compression_ = compress; }
+
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
-    std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
-                                                 bool find_first = false);
+    std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, int num_cols, Operation operation,
+                                                   Transaction *transaction, bool find_first = false);
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
@@ -207,6 +319,13 @@ class IxIndexHandle {
 
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
 
+    // for bulk load
+    bool is_empty_tree();
+
+    bool bulk_load(const char *keys, const Rid *rids, int n, int fill_percent = IX_BULK_LOAD_FILL_PERCENT);
+
+    std::unique_ptr<IxBulkLoader> begin_bulk_load(size_t n, int fill_percent = IX_BULK_LOAD_FILL_PERCENT);
+
     // for delete
     bool delete_entry(const char *key, Transaction *transaction);
 
@@ -219,9 +338,10 @@ class IxIndexHandle {
     bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                   Transaction *transaction, bool *root_is_latched);
 
-    Iid lower_bound(const char *key, Transaction *transaction);
+    // 多列索引按最左前缀查找：key只需给出前num_cols个字段
+    Iid lower_bound(const char *key, int num_cols, Transaction *transaction);
 
-    Iid upper_bound(const char *key, Transaction *transaction);
+    Iid upper_bound(const char *key, int num_cols, Transaction *transaction);
 
     Iid leaf_end() const;
 
@@ -229,7 +349,10 @@ class IxIndexHandle {
 
    private:
     // 辅助函数
-    void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
+    // 读者不加根锁读取根结点的页面号，新的根结点初始化完毕后才能发布
+    void update_root_page_no(page_id_t root) { __atomic_store_n(&file_hdr_->root_page_, root, __ATOMIC_RELEASE); }
+
+    page_id_t get_root_page_no() const { return __atomic_load_n(&file_hdr_->root_page_, __ATOMIC_ACQUIRE); }
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
@@ -237,6 +360,18 @@ class IxIndexHandle {
 
     void unlock_page_set(Transaction *transaction);
 
+    // for B-link read
+    IxNodeHandle *find_leaf_page_blink(const char *key, int num_cols, Operation operation);
+
+    IxNodeHandle *find_leaf_page_for_read(const char *key, int num_cols, Operation operation, Transaction *transaction);
+
+    // for optimistic latch coupling
+    IxNodeHandle *find_leaf_page_optimistic(const char *key, Operation operation);
+
+    bool try_insert_optimistic(const char *key, const Rid &value, page_id_t *leaf_page_no);
+
+    bool try_delete_optimistic(const char *key, bool *deleted);
+
     // for get/create node
     IxNodeHandle *fetch_node(int page_no) const;
 
@@ -245,6 +380,8 @@ class IxIndexHandle {
     // for maintain data structure
     void maintain_parent(IxNodeHandle *node);
 
+    void update_prefix(IxNodeHandle *node);
+
     void erase_leaf(IxNodeHandle *leaf);
 
     void release_node_handle(IxNodeHandle &node);
@@ -253,4 +390,42 @@ class IxIndexHandle {
 
     // for index test
     Rid get_rid(const Iid &iid) const;
-};
\ No newline at end of file
+};
+
+/**
+ * 自底向上建树：按升序逐个追加的键值对依次装满叶子结点，结束时用每个结点的最小键逐层建立内部结点，每个结点只写一次。
+ * 由IxIndexHandle::begin_bulk_load创建，存在期间持有根结点锁；析构时自动结束，未追加完的键值对不会出现在树中
+ */
+class IxBulkLoader {
+    friend class IxIndexHandle;
+
+   public:
+    IxBulkLoader(const IxBulkLoader &) = delete;
+    IxBulkLoader &operator=(const IxBulkLoader &) = delete;
+
+    ~IxBulkLoader() { finish(); }
+
+    void append(const char *key, const Rid &rid);
+
+    void finish();
+
+   private:
+    IxIndexHandle *ih_;
+    std::unique_lock<std::mutex> lock_;     // 根结点锁
+    Page *first_page_;                      // 复用为第一个叶子的空根结点，树被删空后没有根时为空
+    size_t n_;                              // 键值对的总数
+    int fill_;                              // 每个结点的键值对个数
+    size_t num_leaves_;
+    size_t count_ = 0;                      // 已经追加的键值对个数
+    size_t leaf_end_ = 0;                   // 当前叶子装到第几个键值对为止
+    Page *leaf_ = nullptr;                  // 正在装的叶子，一直pin住
+    std::vector<page_id_t> level_pages_;    // 当前层每个结点的页面号
+    std::vector<char> level_keys_;          // 当前层每个结点的子树的最小键
+    bool finished_ = false;
+
+    IxBulkLoader(IxIndexHandle *ih, std::unique_lock<std::mutex> lock, Page *first_page, size_t n, int fill);
+
+    void start_leaf(const char *first_key);
+
+    Page *new_node_page();
+};
@@ -27,6 +27,17 @@ void IxScan::next() {
         // go to next leaf
         iid_.slot_no = 0;
         iid_.page_no = node->get_next_leaf();
+        // 范围扫描沿叶子链表前进，预读之后的叶子结点
+        page_id_t end_page = end_.page_no;
+        read_ahead_.access_chain(iid_.page_no, [end_page](Page *leaf) {
+            if (leaf->get_page_id().page_no == end_page) {
+                return INVALID_PAGE_ID;
+            }
+            leaf->RLatch();
+            page_id_t next = reinterpret_cast<const IxPageHdr *>(leaf->get_data())->next_leaf;
+            leaf->RUnlatch();
+            return next == IX_LEAF_HEADER_PAGE ? INVALID_PAGE_ID : next;
+        });
     }
     bpm_->unpin_page(node->get_page_id(), false);
     page->RUnlatch();
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_defs.h"
 #include "ix_index_handle.h"
+#include "storage/read_ahead.h"
 
 // class IxIndexHandle;
 
@@ -23,10 +24,12 @@ class IxScan : public RecScan {
     Iid iid_;  // 初始为lower（用于遍历的指针）
     Iid end_;  // 初始为upper
     BufferPoolManager *bpm_;
+    ReadAhead read_ahead_;  // 沿叶子链表预读
 
    public:
-    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
-        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {}
+    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm,
+           int read_ahead_pages = READ_AHEAD_PAGES)
+        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm), read_ahead_(bpm, ih->fd_, read_ahead_pages) {}
 
     void next() override;
 
@@ -0,0 +1,122 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IX_SEARCH_AVX2 1
+#endif
+
+// 结点内查找最后线性扫描的字节数，两个cache line
+static constexpr size_t IX_SEARCH_LINEAR_BYTES = 128;
+
+/**
+ * 单个INT、BIGINT字段的索引在结点内查找用的专用函数：先做无分支的二分查找，把范围缩小到最后两个cache line，
+ * 再线性扫描统计其中小于key的个数。x86上AVX2的线性扫描按target("avx2")单独编译，运行时CPU支持AVX2才使用，
+ * 每次比较一个256位的向量；其他情况使用逐个比较的版本
+ */
+class IxSearch {
+   public:
+    /**
+     * @brief 统计有序数组keys[0,n)中小于key的元素个数，upper为true时统计小于等于key的个数
+     * 即std::lower_bound、std::upper_bound的下标。T为int或long long
+     */
+    template <typename T>
+    static size_t count_less(const T *keys, size_t n, T key, bool upper) {
+        size_t len = n;
+        const T *base = narrow(keys, &len, key, upper);
+        return base - keys + scan(base, len, key, upper);
+    }
+
+    // 运行时CPU是否支持AVX2，决定线性扫描使用的版本
+    static bool has_avx2() {
+#ifdef IX_SEARCH_AVX2
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+   private:
+    template <typename T>
+    static constexpr size_t linear_len() { return IX_SEARCH_LINEAR_BYTES / sizeof(T); }
+
+    /**
+     * @brief 无分支的二分查找，缩小后的范围为[base, base + *len)，其左边都小于(小于等于)key，右边都不是
+     * 每一轮都把范围减半，比较的结果只用来计算base的偏移，不产生难以预测的分支
+     */
+    template <typename T>
+    static const T *narrow(const T *keys, size_t *len, T key, bool upper) {
+        const T *base = keys;
+        while (*len > linear_len<T>()) {
+            size_t half = *len / 2;
+            bool less = upper ? base[half - 1] <= key : base[half - 1] < key;
+            base += half * less;
+            *len -= half;
+        }
+        return base;
+    }
+
+    template <typename T>
+    static size_t scan_scalar(const T *keys, size_t n, T key, bool upper) {
+        size_t count = 0;
+        for (size_t i = 0; i < n; i++) {
+            count += upper ? keys[i] <= key : keys[i] < key;
+        }
+        return count;
+    }
+
+    template <typename T>
+    static size_t scan(const T *keys, size_t n, T key, bool upper) {
+#ifdef IX_SEARCH_AVX2
+        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, long long>) {
+            if (has_avx2()) {
+                return scan_avx2(keys, n, key, upper);
+            }
+        }
+#endif
+        return scan_scalar(keys, n, key, upper);
+    }
+
+#ifdef IX_SEARCH_AVX2
+    // 有序数组中小于等于key的个数等于总数减去大于key的个数，都只用到大于比较
+    __attribute__((target("avx2"))) static size_t scan_avx2(const int *keys, size_t n, int key, bool upper) {
+        __m256i target = _mm256_set1_epi32(key);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+            __m256i mask = upper ? _mm256_cmpgt_epi32(v, target) : _mm256_cmpgt_epi32(target, v);
+            int bits = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+            count += upper ? 8 - bits : bits;
+        }
+        return count + scan_scalar(keys + i, n - i, key, upper);
+    }
+
+    __attribute__((target("avx2"))) static size_t scan_avx2(const long long *keys, size_t n, long long key,
+                                                            bool upper) {
+        __m256i target = _mm256_set1_epi64x(key);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+            __m256i mask = upper ? _mm256_cmpgt_epi64(v, target) : _mm256_cmpgt_epi64(target, v);
+            int bits = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+            count += upper ? 4 - bits : bits;
+        }
+        return count + scan_scalar(keys + i, n - i, key, upper);
+    }
+#endif
+};
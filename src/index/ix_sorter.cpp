@@ -0,0 +1,163 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_sorter.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "ix_index_handle.h"
+
+IxSorter::IxSorter(DiskManager *disk_manager, std::string prefix, std::vector<ColType> col_types,
+                   std::vector<int> col_lens, size_t memory_limit)
+    : disk_manager_(disk_manager),
+      prefix_(std::move(prefix)),
+      col_types_(std::move(col_types)),
+      col_lens_(std::move(col_lens)) {
+    key_len_ = std::accumulate(col_lens_.begin(), col_lens_.end(), 0);
+    entry_len_ = key_len_ + static_cast<int>(sizeof(Rid));
+    entries_per_page_ = PAGE_SIZE / entry_len_;
+    max_entries_ = std::max<size_t>(memory_limit / entry_len_, entries_per_page_);
+    cur_.resize(entry_len_);
+}
+
+IxSorter::~IxSorter() {
+    for (auto &run : runs_) {
+        if (run.fd != -1) {
+            disk_manager_->close_file(run.fd);
+        }
+        if (disk_manager_->is_file(run.path)) {
+            disk_manager_->destroy_file(run.path);
+        }
+    }
+}
+
+/**
+ * @description: 加入一个键值对，内存中的键值对达到上限时写出一个有序段
+ * @param {char*} key 键，长度为各字段长度之和
+ * @param {Rid&} rid 键对应的记录号
+ */
+void IxSorter::add(const char *key, const Rid &rid) {
+    assert(!finished_);
+    if (entries_.size() / entry_len_ >= max_entries_) {
+        write_run();
+    }
+    entries_.insert(entries_.end(), key, key + key_len_);
+    entries_.insert(entries_.end(), reinterpret_cast<const char *>(&rid),
+                    reinterpret_cast<const char *>(&rid) + sizeof(Rid));
+    num_entries_++;
+}
+
+/**
+ * @description: 结束输入。写出过有序段时把剩下的键值对也写成有序段，释放内存后准备归并
+ */
+void IxSorter::finish() {
+    assert(!finished_);
+    finished_ = true;
+    if (runs_.empty()) {
+        sort_entries();
+        return;
+    }
+    if (!entries_.empty()) {
+        write_run();
+    }
+    std::vector<char>().swap(entries_);
+    std::vector<size_t>().swap(order_);
+    for (size_t i = 0; i < runs_.size(); i++) {
+        Run &run = runs_[i];
+        run.fd = disk_manager_->open_file(run.path);
+        run.buf = std::make_unique<char[]>(PAGE_SIZE);
+        disk_manager_->read_page(run.fd, 0, run.buf.get(), PAGE_SIZE);
+        heap_.push_back(i);
+        std::push_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return run_greater(a, b); });
+    }
+}
+
+bool IxSorter::next(const char *&key, Rid &rid) {
+    assert(finished_);
+    if (runs_.empty()) {
+        if (pos_ >= order_.size()) {
+            return false;
+        }
+        const char *e = entry(order_[pos_++]);
+        key = e;
+        memcpy(&rid, e + key_len_, sizeof(Rid));
+        return true;
+    }
+    if (heap_.empty()) {
+        return false;
+    }
+    auto greater = [this](size_t a, size_t b) { return run_greater(a, b); };
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    Run &run = runs_[heap_.back()];
+    // 读入下一个页面会覆盖当前的键值对，先拷贝出来
+    memcpy(cur_.data(), run_entry(run), entry_len_);
+    advance(run);
+    if (run.pos < run.num_entries) {
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    } else {
+        heap_.pop_back();
+    }
+    key = cur_.data();
+    memcpy(&rid, cur_.data() + key_len_, sizeof(Rid));
+    return true;
+}
+
+bool IxSorter::run_greater(size_t a, size_t b) const {
+    return ix_compare_keys(run_entry(runs_[a]), run_entry(runs_[b]), col_types_, col_lens_) > 0;
+}
+
+/**
+ * @description: 按键排序内存中的键值对的下标
+ */
+void IxSorter::sort_entries() {
+    order_.resize(entries_.size() / entry_len_);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+        return ix_compare_keys(entry(a), entry(b), col_types_, col_lens_) < 0;
+    });
+}
+
+/**
+ * @description: 把内存中的键值对排序后写成一个有序段文件，然后清空内存
+ */
+void IxSorter::write_run() {
+    sort_entries();
+    Run run;
+    run.path = prefix_ + std::to_string(runs_.size());
+    run.num_entries = order_.size();
+    if (disk_manager_->is_file(run.path)) {
+        disk_manager_->destroy_file(run.path);
+    }
+    disk_manager_->create_file(run.path);
+    runs_.push_back(std::move(run));
+    int fd = disk_manager_->open_file(runs_.back().path);
+    char buf[PAGE_SIZE];
+    for (size_t i = 0; i < order_.size(); i++) {
+        memcpy(buf + (i % entries_per_page_) * entry_len_, entry(order_[i]), entry_len_);
+        if ((i + 1) % entries_per_page_ == 0 || i + 1 == order_.size()) {
+            disk_manager_->write_page(fd, static_cast<page_id_t>(i / entries_per_page_), buf, PAGE_SIZE);
+        }
+    }
+    disk_manager_->close_file(fd);
+    entries_.clear();
+    order_.clear();
+}
+
+/**
+ * @description: 有序段移动到下一个键值对，跨过页面边界时读入下一个页面
+ */
+void IxSorter::advance(Run &run) {
+    run.pos++;
+    if (run.pos < run.num_entries && run.pos % entries_per_page_ == 0) {
+        disk_manager_->read_page(run.fd, static_cast<page_id_t>(run.pos / entries_per_page_), run.buf.get(),
+                                 PAGE_SIZE);
+    }
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ix_defs.h"
+#include "storage/disk_manager.h"
+
+/**
+ * @description: 建立索引时对键值对排序的外部排序器。键值对先攒在内存中，超过内存上限时排好序写成一个有序段(run)，
+ * 输入结束后对所有有序段做一趟多路归并，按键的顺序依次输出；没有写出过有序段时直接在内存中排序。
+ * 有序段文件名为prefix加上段号，通过DiskManager按页面读写，每个页面存放整数个键值对，排序器析构时删除
+ */
+class IxSorter {
+   public:
+    /**
+     * @param {DiskManager*} disk_manager
+     * @param {string&} prefix 有序段文件名的前缀
+     * @param {vector<ColType>&} col_types 键中各字段的类型
+     * @param {vector<int>&} col_lens 键中各字段的长度
+     * @param {size_t} memory_limit 内存中最多存放的键值对的字节数
+     */
+    IxSorter(DiskManager *disk_manager, std::string prefix, std::vector<ColType> col_types, std::vector<int> col_lens,
+             size_t memory_limit = IX_SORT_MEMORY_LIMIT);
+
+    ~IxSorter();
+
+    IxSorter(const IxSorter &) = delete;
+    IxSorter &operator=(const IxSorter &) = delete;
+
+    void add(const char *key, const Rid &rid);
+
+    // 结束输入，之后只能调用next
+    void finish();
+
+    /**
+     * @description: 按键递增的顺序取出下一个键值对，键相同时顺序不确定
+     * @return {bool} 已经取完时返回false
+     * @param {char*&} key 指向排序器内部的键，下一次调用next后失效
+     * @param {Rid&} rid 键对应的记录号
+     */
+    bool next(const char *&key, Rid &rid);
+
+    // 输入的键值对个数
+    size_t size() const { return num_entries_; }
+
+    // 写出的有序段个数
+    size_t num_runs() const { return runs_.size(); }
+
+   private:
+    /* 一个有序段的读取位置，buf存放当前页面 */
+    struct Run {
+        std::string path;
+        int fd = -1;
+        size_t num_entries = 0;
+        size_t pos = 0;             // 下一个要读取的键值对
+        std::unique_ptr<char[]> buf;
+    };
+
+    DiskManager *disk_manager_;
+    std::string prefix_;
+    std::vector<ColType> col_types_;
+    std::vector<int> col_lens_;
+    int key_len_;
+    int entry_len_;                 // 键值对的长度，键后紧跟Rid
+    int entries_per_page_;
+    size_t max_entries_;            // 内存中最多存放的键值对个数
+    size_t num_entries_ = 0;
+
+    std::vector<char> entries_;     // 内存中还没有写出的键值对
+    std::vector<size_t> order_;     // 内存中的键值对排序后的下标
+    size_t pos_ = 0;                // 只在内存中排序时下一个要输出的位置
+    std::vector<Run> runs_;
+
+    std::vector<size_t> heap_;      // 归并时还没有取完的有序段，按当前键值对构成最小堆
+    std::vector<char> cur_;         // 归并时最近取出的键值对
+    bool finished_ = false;
+
+    const char *entry(size_t i) const { return entries_.data() + i * entry_len_; }
+
+    const char *run_entry(const Run &run) const {
+        return run.buf.get() + (run.pos % entries_per_page_) * entry_len_;
+    }
+
+    // 有序段a的当前键大于b的时返回true，用作std::push_heap的比较函数得到最小堆
+    bool run_greater(size_t a, size_t b) const;
+
+    void sort_entries();
+
+    void write_run();
+
+    void advance(Run &run);
+};
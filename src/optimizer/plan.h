@@ -18,6 +18,8 @@ See the Mulan PSL v2 for more details. */
 #include "parser/ast.h"
 
 #include "parser/parser.h"
+#include "index/ix_defs.h"
+#include "record/rm_defs.h"
 
 typedef enum PlanTag{
     T_Invalid = 1,
@@ -27,8 +29,10 @@ typedef enum PlanTag{
     T_CreateTable,
     T_DropTable,
     T_ShowIndex,
+    T_ShowBufferStats,
     T_CreateIndex,
     T_DropIndex,
+    T_LoadData,
     T_Insert,
     T_Update,
     T_Delete,
@@ -190,6 +194,24 @@ class DDLPlan : public Plan
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        RmPageFormat format_ = RM_FORMAT_FIXED;     // 建表时指定的页面格式
+        bool compressed_ = false;                   // 建表时指定是否压缩存放
+        int fill_factor_ = IX_BULK_LOAD_FILL_PERCENT;   // 建索引时结点的填充率
+};
+
+// load语句对应的plan
+class LoadPlan : public Plan
+{
+    public:
+        LoadPlan(PlanTag tag, std::string file_name, std::string tab_name)
+        {
+            Plan::tag = tag;
+            file_name_ = std::move(file_name);
+            tab_name_ = std::move(tab_name);
+        }
+        ~LoadPlan(){}
+        std::string file_name_;
+        std::string tab_name_;
 };
 
 // help; show tables; show index; desc tables; begin; abort; commit; rollback语句对应的plan
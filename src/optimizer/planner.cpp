@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "planner.h"
 
+#include <strings.h>
+
 #include <memory>
 
 #include "execution/executor_delete.h"
@@ -383,16 +385,43 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
                 throw InternalError("Unexpected field type");
             }
         }
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
+        auto plan = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
+        if (x->format.empty() || strcasecmp(x->format.c_str(), "fixed") == 0) {
+            plan->format_ = RM_FORMAT_FIXED;
+        } else if (strcasecmp(x->format.c_str(), "slotted") == 0) {
+            plan->format_ = RM_FORMAT_SLOTTED;
+        } else if (strcasecmp(x->format.c_str(), "pax") == 0) {
+            plan->format_ = RM_FORMAT_PAX;
+        } else {
+            throw InvalidTableFormatError(x->format);
+        }
+        if (x->compression.empty() || strcasecmp(x->compression.c_str(), "none") == 0) {
+            plan->compressed_ = false;
+        } else if (strcasecmp(x->compression.c_str(), "lz") == 0) {
+            plan->compressed_ = true;
+        } else {
+            throw InvalidTableCompressionError(x->compression);
+        }
+        plannerRoot = plan;
     } else if (auto x = std::dynamic_pointer_cast<ast::DropTable>(query->parse)) {
         // drop table;
         plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        auto plan = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        if (x->fill_factor != -1) {
+            if (x->fill_factor < 1 || x->fill_factor > 100) {
+                throw InvalidFillFactorError(x->fill_factor);
+            }
+            plan->fill_factor_ = x->fill_factor;
+        }
+        plannerRoot = plan;
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+    } else if (auto x = std::dynamic_pointer_cast<ast::LoadData>(query->parse)) {
+        // load
+        plannerRoot = std::make_shared<LoadPlan>(T_LoadData, x->file_name, x->tab_name);
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(query->parse)) {
         // insert;
         plannerRoot = std::make_shared<DMLPlan>(T_Insert, std::shared_ptr<Plan>(),  x->tab_name,  
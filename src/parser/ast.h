@@ -49,6 +49,9 @@ struct Help : public TreeNode {
 struct ShowTables : public TreeNode {
 };
 
+struct ShowBufferStats : public TreeNode {
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -82,9 +85,11 @@ struct ColDef : public Field {
 struct CreateTable : public TreeNode {
     std::string tab_name;
     std::vector<std::shared_ptr<Field>> fields;
+    std::string format;     // 页面格式，未指定时为空
+    std::string compression;    // 压缩方式，未指定时为空
 
-    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_) :
-            tab_name(std::move(tab_name_)), fields(std::move(fields_)) {}
+    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_, std::string format_ = "") :
+            tab_name(std::move(tab_name_)), fields(std::move(fields_)), format(std::move(format_)) {}
 };
 
 struct DropTable : public TreeNode {
@@ -108,6 +113,7 @@ struct ShowIndex : public TreeNode {
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    int fill_factor = -1;   // 建索引时结点的填充率（百分比），未指定时为-1
 
     CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
             tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
@@ -121,6 +127,14 @@ struct DropIndex : public TreeNode {
             tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
 };
 
+struct LoadData : public TreeNode {
+    std::string file_name;
+    std::string tab_name;
+
+    LoadData(std::string file_name_, std::string tab_name_) :
+            file_name(std::move(file_name_)), tab_name(std::move(tab_name_)) {}
+};
+
 struct Expr : public TreeNode {
 };
 
@@ -81,10 +81,18 @@ private:
             std::cout << "HELP\n";
         } else if (auto x = std::dynamic_pointer_cast<ShowTables>(node)) {
             std::cout << "SHOW_TABLES\n";
+        } else if (auto x = std::dynamic_pointer_cast<ShowBufferStats>(node)) {
+            std::cout << "SHOW_BUFFER_STATS\n";
         } else if (auto x = std::dynamic_pointer_cast<CreateTable>(node)) {
             std::cout << "CREATE_TABLE\n";
             print_val(x->tab_name, offset);
             print_node_list(x->fields, offset);
+            if (!x->format.empty()) {
+                print_val(x->format, offset);
+            }
+            if (!x->compression.empty()) {
+                print_val(x->compression, offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DropTable>(node)) {
             std::cout << "DROP_TABLE\n";
             print_val(x->tab_name, offset);
@@ -100,6 +108,9 @@ private:
             // print_val(x->col_name, offset);
             for(auto col_name: x->col_names)
                 print_val(col_name, offset);
+            if (x->fill_factor != -1) {
+                print_val(x->fill_factor, offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DropIndex>(node)) {
             std::cout << "DROP_INDEX\n";
             print_val(x->tab_name, offset);
@@ -146,6 +157,10 @@ private:
             std::cout << "INSERT\n";
             print_val(x->tab_name, offset);
             print_node_list(x->vals, offset);
+        } else if (auto x = std::dynamic_pointer_cast<LoadData>(node)) {
+            std::cout << "LOAD\n";
+            print_val(x->file_name, offset);
+            print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<DeleteStmt>(node)) {
             std::cout << "DELETE\n";
             print_val(x->tab_name, offset);
@@ -67,10 +67,11 @@
 
 
 /* First part of user prologue.  */
-#line 1 "yacc.y"
+#line 1 "/root/repo/src/parser/yacc.y"
 
 #include "ast.h"
 #include "yacc.tab.h"
+#include <strings.h>
 #include <iostream>
 #include <memory>
 
@@ -82,7 +83,7 @@ void yyerror(YYLTYPE *locp, const char* s) {
 
 using namespace ast;
 
-#line 86 "yacc.tab.cpp"
+#line 87 "/root/repo/src/parser/yacc.tab.cpp"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -105,7 +106,7 @@ using namespace ast;
 #  endif
 # endif
 
-#include "yacc.tab.hpp"
+#include "yacc.tab.h"
 /* Symbol kind.  */
 enum yysymbol_kind_t
 {
@@ -165,9 +166,9 @@ enum yysymbol_kind_t
   YYSYMBOL_52_ = 52,                       /* ';'  */
   YYSYMBOL_53_ = 53,                       /* '('  */
   YYSYMBOL_54_ = 54,                       /* ')'  */
-  YYSYMBOL_55_ = 55,                       /* ','  */
-  YYSYMBOL_56_ = 56,                       /* '.'  */
-  YYSYMBOL_57_ = 57,                       /* '='  */
+  YYSYMBOL_55_ = 55,                       /* '='  */
+  YYSYMBOL_56_ = 56,                       /* ','  */
+  YYSYMBOL_57_ = 57,                       /* '.'  */
   YYSYMBOL_58_ = 58,                       /* '<'  */
   YYSYMBOL_59_ = 59,                       /* '>'  */
   YYSYMBOL_60_ = 60,                       /* '*'  */
@@ -180,32 +181,33 @@ enum yysymbol_kind_t
   YYSYMBOL_dml = 67,                       /* dml  */
   YYSYMBOL_fieldList = 68,                 /* fieldList  */
   YYSYMBOL_colNameList = 69,               /* colNameList  */
-  YYSYMBOL_field = 70,                     /* field  */
-  YYSYMBOL_type = 71,                      /* type  */
-  YYSYMBOL_valueList = 72,                 /* valueList  */
-  YYSYMBOL_value = 73,                     /* value  */
-  YYSYMBOL_condition = 74,                 /* condition  */
-  YYSYMBOL_optWhereClause = 75,            /* optWhereClause  */
-  YYSYMBOL_whereClause = 76,               /* whereClause  */
-  YYSYMBOL_col = 77,                       /* col  */
-  YYSYMBOL_colList = 78,                   /* colList  */
-  YYSYMBOL_op = 79,                        /* op  */
-  YYSYMBOL_expr = 80,                      /* expr  */
-  YYSYMBOL_setClauses = 81,                /* setClauses  */
-  YYSYMBOL_setClause = 82,                 /* setClause  */
-  YYSYMBOL_selector = 83,                  /* selector  */
-  YYSYMBOL_asClause = 84,                  /* asClause  */
-  YYSYMBOL_aggClause = 85,                 /* aggClause  */
-  YYSYMBOL_aggClauses = 86,                /* aggClauses  */
-  YYSYMBOL_aggregator = 87,                /* aggregator  */
-  YYSYMBOL_tableList = 88,                 /* tableList  */
-  YYSYMBOL_opt_order_clause = 89,          /* opt_order_clause  */
-  YYSYMBOL_order = 90,                     /* order  */
-  YYSYMBOL_order_clause = 91,              /* order_clause  */
-  YYSYMBOL_opt_asc_desc = 92,              /* opt_asc_desc  */
-  YYSYMBOL_limit_clause = 93,              /* limit_clause  */
-  YYSYMBOL_tbName = 94,                    /* tbName  */
-  YYSYMBOL_colName = 95                    /* colName  */
+  YYSYMBOL_tableOptionList = 70,           /* tableOptionList  */
+  YYSYMBOL_field = 71,                     /* field  */
+  YYSYMBOL_type = 72,                      /* type  */
+  YYSYMBOL_valueList = 73,                 /* valueList  */
+  YYSYMBOL_value = 74,                     /* value  */
+  YYSYMBOL_condition = 75,                 /* condition  */
+  YYSYMBOL_optWhereClause = 76,            /* optWhereClause  */
+  YYSYMBOL_whereClause = 77,               /* whereClause  */
+  YYSYMBOL_col = 78,                       /* col  */
+  YYSYMBOL_colList = 79,                   /* colList  */
+  YYSYMBOL_op = 80,                        /* op  */
+  YYSYMBOL_expr = 81,                      /* expr  */
+  YYSYMBOL_setClauses = 82,                /* setClauses  */
+  YYSYMBOL_setClause = 83,                 /* setClause  */
+  YYSYMBOL_selector = 84,                  /* selector  */
+  YYSYMBOL_asClause = 85,                  /* asClause  */
+  YYSYMBOL_aggClause = 86,                 /* aggClause  */
+  YYSYMBOL_aggClauses = 87,                /* aggClauses  */
+  YYSYMBOL_aggregator = 88,                /* aggregator  */
+  YYSYMBOL_tableList = 89,                 /* tableList  */
+  YYSYMBOL_opt_order_clause = 90,          /* opt_order_clause  */
+  YYSYMBOL_order = 91,                     /* order  */
+  YYSYMBOL_order_clause = 92,              /* order_clause  */
+  YYSYMBOL_opt_asc_desc = 93,              /* opt_asc_desc  */
+  YYSYMBOL_limit_clause = 94,              /* limit_clause  */
+  YYSYMBOL_tbName = 95,                    /* tbName  */
+  YYSYMBOL_colName = 96                    /* colName  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -534,18 +536,18 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  47
+#define YYFINAL  50
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   165
+#define YYLAST   182
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  61
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  35
+#define YYNNTS  36
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  89
+#define YYNRULES  95
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  175
+#define YYNSTATES  191
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   306
@@ -566,9 +568,9 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      53,    54,    60,     2,    55,     2,    56,     2,     2,     2,
+      53,    54,    60,     2,    56,     2,    57,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,    52,
-      58,    57,    59,     2,     2,     2,     2,     2,     2,     2,
+      58,    55,    59,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -599,15 +601,16 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    65,    65,    70,    75,    80,    88,    89,    90,    91,
-      95,    99,   103,   107,   114,   118,   125,   129,   133,   137,
-     141,   148,   152,   156,   160,   164,   171,   175,   182,   186,
-     193,   200,   204,   208,   212,   216,   223,   227,   234,   238,
-     242,   246,   250,   257,   264,   265,   272,   276,   283,   287,
-     294,   298,   305,   309,   313,   317,   321,   325,   332,   336,
-     343,   347,   354,   361,   365,   369,   374,   380,   384,   388,
-     392,   396,   403,   407,   414,   421,   425,   429,   436,   440,
-     444,   451,   455,   462,   463,   464,   468,   472,   475,   477
+       0,    66,    66,    71,    76,    81,    89,    90,    91,    92,
+      96,   100,   104,   108,   115,   119,   123,   135,   139,   155,
+     159,   163,   167,   178,   185,   189,   193,   197,   201,   205,
+     217,   221,   228,   232,   239,   243,   251,   258,   262,   266,
+     270,   274,   281,   285,   292,   296,   300,   304,   308,   315,
+     322,   323,   330,   334,   341,   345,   352,   356,   363,   367,
+     371,   375,   379,   383,   390,   394,   401,   405,   412,   419,
+     423,   427,   432,   438,   442,   446,   450,   454,   461,   465,
+     472,   479,   483,   487,   494,   498,   502,   509,   513,   520,
+     521,   522,   526,   530,   533,   535
 };
 #endif
 
@@ -630,13 +633,13 @@ static const char *const yytname[] =
   "HELP", "TXN_BEGIN", "TXN_COMMIT", "TXN_ABORT", "TXN_ROLLBACK",
   "ORDER_BY", "LIMIT", "SUM", "MAX", "MIN", "COUNT", "AS", "LEQ", "NEQ",
   "GEQ", "T_EOF", "IDENTIFIER", "VALUE_STRING", "VALUE_INT", "VALUE_FLOAT",
-  "VALUE_BIGINT", "VALUE_DATETIME", "';'", "'('", "')'", "','", "'.'",
-  "'='", "'<'", "'>'", "'*'", "$accept", "start", "stmt", "txnStmt",
-  "dbStmt", "ddl", "dml", "fieldList", "colNameList", "field", "type",
-  "valueList", "value", "condition", "optWhereClause", "whereClause",
-  "col", "colList", "op", "expr", "setClauses", "setClause", "selector",
-  "asClause", "aggClause", "aggClauses", "aggregator", "tableList",
-  "opt_order_clause", "order", "order_clause", "opt_asc_desc",
+  "VALUE_BIGINT", "VALUE_DATETIME", "';'", "'('", "')'", "'='", "','",
+  "'.'", "'<'", "'>'", "'*'", "$accept", "start", "stmt", "txnStmt",
+  "dbStmt", "ddl", "dml", "fieldList", "colNameList", "tableOptionList",
+  "field", "type", "valueList", "value", "condition", "optWhereClause",
+  "whereClause", "col", "colList", "op", "expr", "setClauses", "setClause",
+  "selector", "asClause", "aggClause", "aggClauses", "aggregator",
+  "tableList", "opt_order_clause", "order", "order_clause", "opt_asc_desc",
   "limit_clause", "tbName", "colName", YY_NULLPTR
 };
 
@@ -647,12 +650,12 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-98)
+#define YYPACT_NINF (-105)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF (-89)
+#define YYTABLE_NINF (-95)
 
 #define yytable_value_is_error(Yyn) \
   0
@@ -661,24 +664,26 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-      61,     4,     3,     6,   -40,    48,    47,   -40,   -20,   -98,
-     -98,   -98,   -98,   -98,   -98,   -98,    10,    15,   -98,   -98,
-     -98,   -98,   -98,    49,   -40,   -40,   -40,   -40,   -98,   -98,
-     -40,   -40,    52,    21,    25,    27,    29,    32,   -98,   -98,
-      28,    76,   -98,    50,    94,    68,   -98,   -98,   -98,   -40,
-      73,    75,   -98,    77,   114,   112,    85,    86,    86,    86,
-     -21,    86,   -40,    -4,   -40,    85,   -98,    85,    85,    85,
-      80,    86,   -98,   -98,   -10,   -98,    78,    82,    83,    84,
-      87,    88,   -98,   -12,   -98,   -98,   -12,   -98,   -13,   -98,
-      93,    -7,   -98,     0,    72,   -98,   107,    43,    85,   -98,
-      72,    98,    98,    98,    98,    98,   -40,   -40,   125,   125,
-     -98,    85,   -98,    90,   -98,   -98,   -98,   -98,   -98,    85,
-     -98,   -98,   -98,   -98,   -98,   -98,    22,   -98,    86,   -98,
-     -98,   -98,   -98,   -98,   -98,    62,   -98,   -98,    85,   -98,
-     -98,   -98,   -98,   -98,   -98,   -98,   128,   109,   109,   -98,
-      99,   -98,   -98,    72,   -98,   -98,   -98,   -98,   -98,    86,
-     100,   -98,   -98,    92,   -98,    23,   -98,    95,   -98,   -98,
-     -98,   -98,   -98,    86,   -98
+      66,     2,     5,     7,   -37,     0,     1,   -37,    42,  -105,
+    -105,  -105,  -105,  -105,  -105,  -105,   -20,    38,    -1,  -105,
+    -105,  -105,  -105,  -105,    39,    -4,   -37,   -37,   -37,   -37,
+    -105,  -105,   -37,   -37,    51,     8,    19,    23,    24,    44,
+    -105,  -105,    52,   100,  -105,    63,   115,    72,  -105,   120,
+    -105,  -105,   -37,  -105,    78,    79,  -105,    81,   124,   119,
+      91,    92,    92,    92,   -38,    92,   -37,    83,   -37,    91,
+     -37,  -105,    91,    91,    91,    86,    92,  -105,  -105,   -12,
+    -105,    85,    87,    88,    89,    90,    93,  -105,   -10,  -105,
+    -105,   -10,  -105,  -105,   -15,  -105,    82,   -11,  -105,    10,
+      67,  -105,   118,   -23,    91,  -105,    67,   105,   105,   105,
+     105,   105,   -37,   -37,   133,   133,   103,    91,  -105,    97,
+    -105,  -105,  -105,  -105,   106,    91,  -105,  -105,  -105,  -105,
+    -105,  -105,    29,  -105,    92,  -105,  -105,  -105,  -105,  -105,
+    -105,    43,  -105,  -105,    91,  -105,  -105,  -105,  -105,  -105,
+    -105,  -105,   135,   117,   117,    99,   109,  -105,   108,   102,
+    -105,  -105,    67,  -105,  -105,  -105,  -105,  -105,    92,   110,
+    -105,  -105,   113,   107,   111,   116,  -105,    26,  -105,   112,
+    -105,  -105,   121,  -105,  -105,  -105,  -105,  -105,    92,  -105,
+    -105
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -687,41 +692,43 @@ static const yytype_int16 yypact[] =
 static const yytype_int8 yydefact[] =
 {
        0,     0,     0,     0,     0,     0,     0,     0,     0,     4,
-       3,    10,    11,    12,    13,     5,     0,     0,     9,     6,
-       7,     8,    14,     0,     0,     0,     0,     0,    88,    18,
-       0,     0,     0,     0,     0,     0,     0,    89,    63,    50,
-      64,     0,    72,    74,     0,     0,    49,     1,     2,     0,
-       0,     0,    17,     0,     0,    44,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,    15,     0,     0,     0,
-       0,     0,    22,    89,    44,    60,     0,     0,     0,     0,
-       0,     0,    51,    44,    75,    73,    44,    48,     0,    26,
-       0,     0,    28,     0,     0,    46,    45,     0,     0,    23,
-       0,    66,    66,    66,    66,    66,     0,     0,    79,    79,
-      16,     0,    31,     0,    33,    34,    35,    30,    19,     0,
-      20,    40,    38,    39,    41,    42,     0,    36,     0,    56,
-      55,    57,    52,    53,    54,     0,    61,    62,     0,    67,
-      68,    69,    70,    71,    77,    76,     0,    87,    87,    27,
-       0,    29,    21,     0,    47,    58,    59,    43,    65,     0,
-       0,    24,    25,     0,    37,    85,    81,    78,    86,    32,
-      84,    83,    80,     0,    82
+       3,    10,    11,    12,    13,     5,     0,     0,     0,     9,
+       6,     7,     8,    14,     0,     0,     0,     0,     0,     0,
+      94,    20,     0,     0,     0,     0,     0,     0,     0,    95,
+      69,    56,    70,     0,    78,    80,     0,     0,    55,     0,
+       1,     2,     0,    16,     0,     0,    19,     0,     0,    50,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    15,     0,     0,     0,     0,     0,    25,    95,    50,
+      66,     0,     0,     0,     0,     0,     0,    57,    50,    81,
+      79,    50,    54,    29,     0,    30,     0,     0,    32,     0,
+       0,    52,    51,     0,     0,    26,     0,    72,    72,    72,
+      72,    72,     0,     0,    85,    85,    17,     0,    37,     0,
+      39,    40,    41,    36,    21,     0,    23,    46,    44,    45,
+      47,    48,     0,    42,     0,    62,    61,    63,    58,    59,
+      60,     0,    67,    68,     0,    73,    74,    75,    76,    77,
+      83,    82,     0,    93,    93,     0,    18,    31,     0,     0,
+      33,    24,     0,    53,    64,    65,    49,    71,     0,     0,
+      27,    28,     0,     0,     0,     0,    43,    91,    87,    84,
+      92,    34,     0,    38,    22,    90,    89,    86,     0,    35,
+      88
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -98,   -98,   -98,   -98,   -98,   -98,   -98,   -98,    89,    38,
-     -98,   -98,   -97,    24,   -11,   -98,    -8,   -98,   -98,   -98,
-     -98,    55,   -98,    -6,    91,   -98,   -98,    96,    46,   -17,
-     -98,   -98,     9,    -3,   -54
+    -105,  -105,  -105,  -105,  -105,  -105,  -105,  -105,    95,  -105,
+      46,  -105,  -105,  -104,    27,   -29,  -105,    -8,  -105,  -105,
+    -105,  -105,    62,  -105,    16,   104,  -105,  -105,   114,    55,
+     -16,  -105,  -105,    20,    -3,   -57
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_uint8 yydefgoto[] =
 {
-       0,    16,    17,    18,    19,    20,    21,    88,    91,    89,
-     117,   126,   127,    95,    72,    96,    97,    40,   135,   157,
-      74,    75,    41,   139,    42,    43,    44,    83,   147,   166,
-     167,   172,   161,    45,    46
+       0,    17,    18,    19,    20,    21,    22,    94,    97,   156,
+      95,   123,   132,   133,   101,    77,   102,   103,    42,   141,
+     166,    79,    80,    43,   145,    44,    45,    46,    88,   153,
+     178,   179,   187,   170,    47,    48
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -729,44 +736,48 @@ static const yytype_uint8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
-      39,    29,    76,   137,    32,    71,    28,    71,    22,    24,
-      47,    87,    26,    90,    92,    92,   106,    33,    34,    35,
-      36,    50,    51,    52,    53,    37,    37,    54,    55,    25,
-      23,   170,    27,    33,    34,    35,    36,   171,   155,    80,
-      38,   110,   111,   107,    76,    98,    66,   118,   119,    77,
-      78,    79,    81,    82,   120,   119,   164,    90,    30,    84,
-      31,    84,    49,    99,     1,   151,     2,    48,     3,     4,
-       5,    56,   108,     6,    57,   109,   152,   153,    58,     7,
-      59,     8,    60,    61,   158,   129,   130,   131,   -88,    62,
-       9,    10,    11,    12,    13,    14,   140,   141,   142,   143,
-     132,   133,   134,   144,   145,    63,    15,    64,    37,   121,
-     122,   123,   124,   125,   112,   113,   114,   115,   116,   121,
-     122,   123,   124,   125,    65,    70,    67,   156,    68,    71,
-      69,    73,    37,    94,   128,   100,   101,   102,   103,   138,
-     146,   104,   105,   150,   159,   160,   169,   163,   168,   149,
-     173,   165,   154,   136,    85,   148,   174,   162,    93,     0,
-      86,     0,     0,     0,     0,   165
+      41,    31,   143,    81,    34,    76,    23,    76,    39,    30,
+      32,    26,    92,    28,    33,    96,    98,    98,   112,   135,
+     136,   137,    85,    54,    55,    56,    57,    49,    24,    58,
+      59,    27,   138,    29,   185,   139,   140,   164,    50,   116,
+     186,   117,    53,   124,   104,   125,   113,    81,    25,    71,
+     105,    51,    52,    82,    83,    84,    86,    87,   176,   114,
+      96,    61,   115,    89,   126,    89,   125,    93,   160,     1,
+      60,     2,    62,     3,     4,     5,    63,    64,     6,    35,
+      36,    37,    38,   161,     7,   162,     8,   167,    39,    39,
+     127,   128,   129,   130,   131,     9,    10,    11,    12,    13,
+      14,   -94,    40,   118,   119,   120,   121,   122,    65,   150,
+     151,    15,    16,    66,   127,   128,   129,   130,   131,    67,
+      35,    36,    37,    38,   146,   147,   148,   149,    68,    69,
+      70,    72,    73,   165,    74,    75,    76,    78,    39,   100,
+     106,   107,   108,   109,   110,   134,   144,   111,   152,   155,
+     158,   168,   159,   169,   172,   173,   174,   175,   180,   181,
+     177,   163,   182,   157,   184,   183,   142,   189,   188,    99,
+     154,    90,   190,     0,   171,     0,     0,     0,     0,     0,
+     177,     0,    91
 };
 
 static const yytype_int16 yycheck[] =
 {
-       8,     4,    56,   100,     7,    17,    46,    17,     4,     6,
-       0,    65,     6,    67,    68,    69,    28,    37,    38,    39,
-      40,    24,    25,    26,    27,    46,    46,    30,    31,    26,
-      26,     8,    26,    37,    38,    39,    40,    14,   135,    60,
-      60,    54,    55,    55,    98,    55,    49,    54,    55,    57,
-      58,    59,    60,    61,    54,    55,   153,   111,    10,    62,
-      13,    64,    13,    74,     3,   119,     5,    52,     7,     8,
-       9,    19,    83,    12,    53,    86,    54,    55,    53,    18,
-      53,    20,    53,    55,   138,    42,    43,    44,    56,    13,
-      29,    30,    31,    32,    33,    34,   102,   103,   104,   105,
-      57,    58,    59,   106,   107,    55,    45,    13,    46,    47,
-      48,    49,    50,    51,    21,    22,    23,    24,    25,    47,
-      48,    49,    50,    51,    56,    11,    53,   135,    53,    17,
-      53,    46,    46,    53,    27,    57,    54,    54,    54,    41,
-      15,    54,    54,    53,    16,    36,    54,    48,    48,   111,
-      55,   159,   128,    98,    63,   109,   173,   148,    69,    -1,
-      64,    -1,    -1,    -1,    -1,   173
+       8,     4,   106,    60,     7,    17,     4,    17,    46,    46,
+      10,     6,    69,     6,    13,    72,    73,    74,    28,    42,
+      43,    44,    60,    26,    27,    28,    29,    47,    26,    32,
+      33,    26,    55,    26,     8,    58,    59,   141,     0,    54,
+      14,    56,    46,    54,    56,    56,    56,   104,    46,    52,
+      79,    52,    13,    61,    62,    63,    64,    65,   162,    88,
+     117,    53,    91,    66,    54,    68,    56,    70,   125,     3,
+      19,     5,    53,     7,     8,     9,    53,    53,    12,    37,
+      38,    39,    40,    54,    18,    56,    20,   144,    46,    46,
+      47,    48,    49,    50,    51,    29,    30,    31,    32,    33,
+      34,    57,    60,    21,    22,    23,    24,    25,    56,   112,
+     113,    45,    46,    13,    47,    48,    49,    50,    51,    56,
+      37,    38,    39,    40,   108,   109,   110,   111,    13,    57,
+      10,    53,    53,   141,    53,    11,    17,    46,    46,    53,
+      55,    54,    54,    54,    54,    27,    41,    54,    15,    46,
+      53,    16,    46,    36,    55,    46,    48,    55,    48,    46,
+     168,   134,    55,   117,    48,    54,   104,    46,    56,    74,
+     115,    67,   188,    -1,   154,    -1,    -1,    -1,    -1,    -1,
+     188,    -1,    68
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
@@ -774,51 +785,55 @@ static const yytype_int16 yycheck[] =
 static const yytype_int8 yystos[] =
 {
        0,     3,     5,     7,     8,     9,    12,    18,    20,    29,
-      30,    31,    32,    33,    34,    45,    62,    63,    64,    65,
-      66,    67,     4,    26,     6,    26,     6,    26,    46,    94,
-      10,    13,    94,    37,    38,    39,    40,    46,    60,    77,
-      78,    83,    85,    86,    87,    94,    95,     0,    52,    13,
-      94,    94,    94,    94,    94,    94,    19,    53,    53,    53,
-      53,    55,    13,    55,    13,    56,    94,    53,    53,    53,
-      11,    17,    75,    46,    81,    82,    95,    77,    77,    77,
-      60,    77,    77,    88,    94,    85,    88,    95,    68,    70,
-      95,    69,    95,    69,    53,    74,    76,    77,    55,    75,
-      57,    54,    54,    54,    54,    54,    28,    55,    75,    75,
-      54,    55,    21,    22,    23,    24,    25,    71,    54,    55,
-      54,    47,    48,    49,    50,    51,    72,    73,    27,    42,
-      43,    44,    57,    58,    59,    79,    82,    73,    41,    84,
-      84,    84,    84,    84,    94,    94,    15,    89,    89,    70,
-      53,    95,    54,    55,    74,    73,    77,    80,    95,    16,
-      36,    93,    93,    48,    73,    77,    90,    91,    48,    54,
-       8,    14,    92,    55,    90
+      30,    31,    32,    33,    34,    45,    46,    62,    63,    64,
+      65,    66,    67,     4,    26,    46,     6,    26,     6,    26,
+      46,    95,    10,    13,    95,    37,    38,    39,    40,    46,
+      60,    78,    79,    84,    86,    87,    88,    95,    96,    47,
+       0,    52,    13,    46,    95,    95,    95,    95,    95,    95,
+      19,    53,    53,    53,    53,    56,    13,    56,    13,    57,
+      10,    95,    53,    53,    53,    11,    17,    76,    46,    82,
+      83,    96,    78,    78,    78,    60,    78,    78,    89,    95,
+      86,    89,    96,    95,    68,    71,    96,    69,    96,    69,
+      53,    75,    77,    78,    56,    76,    55,    54,    54,    54,
+      54,    54,    28,    56,    76,    76,    54,    56,    21,    22,
+      23,    24,    25,    72,    54,    56,    54,    47,    48,    49,
+      50,    51,    73,    74,    27,    42,    43,    44,    55,    58,
+      59,    80,    83,    74,    41,    85,    85,    85,    85,    85,
+      95,    95,    15,    90,    90,    46,    70,    71,    53,    46,
+      96,    54,    56,    75,    74,    78,    81,    96,    16,    36,
+      94,    94,    55,    46,    48,    55,    74,    78,    91,    92,
+      48,    46,    55,    54,    48,     8,    14,    93,    56,    46,
+      91
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
        0,    61,    62,    62,    62,    62,    63,    63,    63,    63,
-      64,    64,    64,    64,    65,    65,    66,    66,    66,    66,
-      66,    67,    67,    67,    67,    67,    68,    68,    69,    69,
-      70,    71,    71,    71,    71,    71,    72,    72,    73,    73,
-      73,    73,    73,    74,    75,    75,    76,    76,    77,    77,
-      78,    78,    79,    79,    79,    79,    79,    79,    80,    80,
-      81,    81,    82,    83,    83,    84,    84,    85,    85,    85,
-      85,    85,    86,    86,    87,    88,    88,    88,    89,    89,
-      90,    91,    91,    92,    92,    92,    93,    93,    94,    95
+      64,    64,    64,    64,    65,    65,    65,    66,    66,    66,
+      66,    66,    66,    66,    67,    67,    67,    67,    67,    67,
+      68,    68,    69,    69,    70,    70,    71,    72,    72,    72,
+      72,    72,    73,    73,    74,    74,    74,    74,    74,    75,
+      76,    76,    77,    77,    78,    78,    79,    79,    80,    80,
+      80,    80,    80,    80,    81,    81,    82,    82,    83,    84,
+      84,    85,    85,    86,    86,    86,    86,    86,    87,    87,
+      88,    89,    89,    89,    90,    90,    91,    92,    92,    93,
+      93,    93,    94,    94,    95,    96
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     2,     4,     6,     3,     2,     6,
-       6,     7,     4,     5,     7,     7,     1,     3,     1,     3,
-       2,     1,     4,     1,     1,     1,     1,     3,     1,     1,
-       1,     1,     1,     3,     0,     2,     1,     3,     3,     1,
-       1,     3,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     3,     3,     1,     1,     2,     0,     5,     5,     5,
-       5,     5,     1,     3,     1,     1,     3,     3,     3,     0,
-       2,     1,     3,     1,     1,     0,     2,     0,     1,     1
+       1,     1,     1,     1,     2,     4,     3,     6,     7,     3,
+       2,     6,     9,     6,     7,     4,     5,     7,     7,     4,
+       1,     3,     1,     3,     3,     4,     2,     1,     4,     1,
+       1,     1,     1,     3,     1,     1,     1,     1,     1,     3,
+       0,     2,     1,     3,     3,     1,     1,     3,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,     3,     3,     1,
+       1,     2,     0,     5,     5,     5,     5,     5,     1,     3,
+       1,     1,     3,     3,     3,     0,     2,     1,     3,     1,
+       1,     0,     2,     0,     1,     1
 };
 
 
@@ -1674,647 +1689,725 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* start: stmt ';'  */
-#line 66 "yacc.y"
+#line 67 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = (yyvsp[-1].sv_node);
         YYACCEPT;
     }
-#line 1683 "yacc.tab.cpp"
+#line 1698 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 3: /* start: HELP  */
-#line 71 "yacc.y"
+#line 72 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = std::make_shared<Help>();
         YYACCEPT;
     }
-#line 1692 "yacc.tab.cpp"
+#line 1707 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 4: /* start: EXIT  */
-#line 76 "yacc.y"
+#line 77 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = nullptr;
         YYACCEPT;
     }
-#line 1701 "yacc.tab.cpp"
+#line 1716 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 5: /* start: T_EOF  */
-#line 81 "yacc.y"
+#line 82 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = nullptr;
         YYACCEPT;
     }
-#line 1710 "yacc.tab.cpp"
+#line 1725 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 10: /* txnStmt: TXN_BEGIN  */
-#line 96 "yacc.y"
+#line 97 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnBegin>();
     }
-#line 1718 "yacc.tab.cpp"
+#line 1733 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 11: /* txnStmt: TXN_COMMIT  */
-#line 100 "yacc.y"
+#line 101 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnCommit>();
     }
-#line 1726 "yacc.tab.cpp"
+#line 1741 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 12: /* txnStmt: TXN_ABORT  */
-#line 104 "yacc.y"
+#line 105 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnAbort>();
     }
-#line 1734 "yacc.tab.cpp"
+#line 1749 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 13: /* txnStmt: TXN_ROLLBACK  */
-#line 108 "yacc.y"
+#line 109 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnRollback>();
     }
-#line 1742 "yacc.tab.cpp"
+#line 1757 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 14: /* dbStmt: SHOW TABLES  */
-#line 115 "yacc.y"
+#line 116 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<ShowTables>();
     }
-#line 1750 "yacc.tab.cpp"
+#line 1765 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 15: /* dbStmt: SHOW INDEX FROM tbName  */
-#line 119 "yacc.y"
+#line 120 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<ShowIndex>((yyvsp[0].sv_str));
     }
-#line 1758 "yacc.tab.cpp"
+#line 1773 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 16: /* dbStmt: SHOW IDENTIFIER IDENTIFIER  */
+#line 124 "/root/repo/src/parser/yacc.y"
+    {
+        // buffer和stats不作为保留字，以免与同名的表和列冲突
+        if (strcasecmp((yyvsp[-1].sv_str).c_str(), "buffer") != 0 || strcasecmp((yyvsp[0].sv_str).c_str(), "stats") != 0) {
+            yyerror(&(yyloc), "syntax error, expecting SHOW BUFFER STATS");
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<ShowBufferStats>();
+    }
+#line 1786 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 16: /* ddl: CREATE TABLE tbName '(' fieldList ')'  */
-#line 126 "yacc.y"
+  case 17: /* ddl: CREATE TABLE tbName '(' fieldList ')'  */
+#line 136 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<CreateTable>((yyvsp[-3].sv_str), (yyvsp[-1].sv_fields));
     }
-#line 1766 "yacc.tab.cpp"
+#line 1794 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 18: /* ddl: CREATE TABLE tbName '(' fieldList ')' tableOptionList  */
+#line 140 "/root/repo/src/parser/yacc.y"
+    {
+        // format和compression不作为保留字，以免与同名的表和列冲突
+        auto create_table = std::make_shared<CreateTable>((yyvsp[-4].sv_str), (yyvsp[-2].sv_fields));
+        for (size_t i = 0; i < (yyvsp[0].sv_strs).size(); i += 2) {
+            if (strcasecmp((yyvsp[0].sv_strs)[i].c_str(), "format") == 0) {
+                create_table->format = (yyvsp[0].sv_strs)[i + 1];
+            } else if (strcasecmp((yyvsp[0].sv_strs)[i].c_str(), "compression") == 0) {
+                create_table->compression = (yyvsp[0].sv_strs)[i + 1];
+            } else {
+                yyerror(&(yyloc), "syntax error, expecting FORMAT = ... or COMPRESSION = ...");
+                YYERROR;
+            }
+        }
+        (yyval.sv_node) = create_table;
+    }
+#line 1814 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 17: /* ddl: DROP TABLE tbName  */
-#line 130 "yacc.y"
+  case 19: /* ddl: DROP TABLE tbName  */
+#line 156 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DropTable>((yyvsp[0].sv_str));
     }
-#line 1774 "yacc.tab.cpp"
+#line 1822 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 18: /* ddl: DESC tbName  */
-#line 134 "yacc.y"
+  case 20: /* ddl: DESC tbName  */
+#line 160 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DescTable>((yyvsp[0].sv_str));
     }
-#line 1782 "yacc.tab.cpp"
+#line 1830 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 19: /* ddl: CREATE INDEX tbName '(' colNameList ')'  */
-#line 138 "yacc.y"
+  case 21: /* ddl: CREATE INDEX tbName '(' colNameList ')'  */
+#line 164 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<CreateIndex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
     }
-#line 1790 "yacc.tab.cpp"
+#line 1838 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 20: /* ddl: DROP INDEX tbName '(' colNameList ')'  */
-#line 142 "yacc.y"
+  case 22: /* ddl: CREATE INDEX tbName '(' colNameList ')' IDENTIFIER '=' VALUE_INT  */
+#line 168 "/root/repo/src/parser/yacc.y"
+    {
+        // 与建表选项相同，fillfactor不作为保留字
+        if (strcasecmp((yyvsp[-2].sv_str).c_str(), "fillfactor") != 0) {
+            yyerror(&(yyloc), "syntax error, expecting FILLFACTOR = ...");
+            YYERROR;
+        }
+        auto create_index = std::make_shared<CreateIndex>((yyvsp[-6].sv_str), (yyvsp[-4].sv_strs));
+        create_index->fill_factor = (yyvsp[0].sv_int);
+        (yyval.sv_node) = create_index;
+    }
+#line 1853 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 23: /* ddl: DROP INDEX tbName '(' colNameList ')'  */
+#line 179 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DropIndex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
     }
-#line 1798 "yacc.tab.cpp"
+#line 1861 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 21: /* dml: INSERT INTO tbName VALUES '(' valueList ')'  */
-#line 149 "yacc.y"
+  case 24: /* dml: INSERT INTO tbName VALUES '(' valueList ')'  */
+#line 186 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<InsertStmt>((yyvsp[-4].sv_str), (yyvsp[-1].sv_vals));
     }
-#line 1806 "yacc.tab.cpp"
+#line 1869 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 22: /* dml: DELETE FROM tbName optWhereClause  */
-#line 153 "yacc.y"
+  case 25: /* dml: DELETE FROM tbName optWhereClause  */
+#line 190 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DeleteStmt>((yyvsp[-1].sv_str), (yyvsp[0].sv_conds));
     }
-#line 1814 "yacc.tab.cpp"
+#line 1877 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 23: /* dml: UPDATE tbName SET setClauses optWhereClause  */
-#line 157 "yacc.y"
+  case 26: /* dml: UPDATE tbName SET setClauses optWhereClause  */
+#line 194 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<UpdateStmt>((yyvsp[-3].sv_str), (yyvsp[-1].sv_set_clauses), (yyvsp[0].sv_conds));
     }
-#line 1822 "yacc.tab.cpp"
+#line 1885 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 24: /* dml: SELECT selector FROM tableList optWhereClause opt_order_clause limit_clause  */
-#line 161 "yacc.y"
+  case 27: /* dml: SELECT selector FROM tableList optWhereClause opt_order_clause limit_clause  */
+#line 198 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<SelectStmt>((yyvsp[-5].sv_cols), (yyvsp[-3].sv_strs), (yyvsp[-2].sv_conds), (yyvsp[-1].sv_orderbys), (yyvsp[0].sv_limit));
     }
-#line 1830 "yacc.tab.cpp"
+#line 1893 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 25: /* dml: SELECT aggregator FROM tableList optWhereClause opt_order_clause limit_clause  */
-#line 165 "yacc.y"
+  case 28: /* dml: SELECT aggregator FROM tableList optWhereClause opt_order_clause limit_clause  */
+#line 202 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<SelectStmt>((yyvsp[-5].sv_agg_clauses), (yyvsp[-3].sv_strs), (yyvsp[-2].sv_conds), (yyvsp[-1].sv_orderbys), (yyvsp[0].sv_limit));
     }
-#line 1838 "yacc.tab.cpp"
+#line 1901 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 29: /* dml: IDENTIFIER VALUE_STRING INTO tbName  */
+#line 206 "/root/repo/src/parser/yacc.y"
+    {
+        // load不作为保留字，以免与同名的表和列冲突
+        if (strcasecmp((yyvsp[-3].sv_str).c_str(), "load") != 0) {
+            yyerror(&(yyloc), "syntax error, expecting LOAD 'file' INTO table");
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<LoadData>((yyvsp[-2].sv_str), (yyvsp[0].sv_str));
+    }
+#line 1914 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 26: /* fieldList: field  */
-#line 172 "yacc.y"
+  case 30: /* fieldList: field  */
+#line 218 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_fields) = std::vector<std::shared_ptr<Field>>{(yyvsp[0].sv_field)};
     }
-#line 1846 "yacc.tab.cpp"
+#line 1922 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 27: /* fieldList: fieldList ',' field  */
-#line 176 "yacc.y"
+  case 31: /* fieldList: fieldList ',' field  */
+#line 222 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_fields).push_back((yyvsp[0].sv_field));
     }
-#line 1854 "yacc.tab.cpp"
+#line 1930 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 28: /* colNameList: colName  */
-#line 183 "yacc.y"
+  case 32: /* colNameList: colName  */
+#line 229 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs) = std::vector<std::string>{(yyvsp[0].sv_str)};
     }
-#line 1862 "yacc.tab.cpp"
+#line 1938 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 33: /* colNameList: colNameList ',' colName  */
+#line 233 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_strs).push_back((yyvsp[0].sv_str));
+    }
+#line 1946 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 34: /* tableOptionList: IDENTIFIER '=' IDENTIFIER  */
+#line 240 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_strs) = std::vector<std::string>{(yyvsp[-2].sv_str), (yyvsp[0].sv_str)};
+    }
+#line 1954 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 29: /* colNameList: colNameList ',' colName  */
-#line 187 "yacc.y"
+  case 35: /* tableOptionList: tableOptionList IDENTIFIER '=' IDENTIFIER  */
+#line 244 "/root/repo/src/parser/yacc.y"
     {
+        (yyval.sv_strs).push_back((yyvsp[-2].sv_str));
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 1870 "yacc.tab.cpp"
+#line 1963 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 30: /* field: colName type  */
-#line 194 "yacc.y"
+  case 36: /* field: colName type  */
+#line 252 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_field) = std::make_shared<ColDef>((yyvsp[-1].sv_str), (yyvsp[0].sv_type_len));
     }
-#line 1878 "yacc.tab.cpp"
+#line 1971 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 31: /* type: INT  */
-#line 201 "yacc.y"
+  case 37: /* type: INT  */
+#line 259 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_INT, sizeof(int));
     }
-#line 1886 "yacc.tab.cpp"
+#line 1979 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 32: /* type: CHAR '(' VALUE_INT ')'  */
-#line 205 "yacc.y"
+  case 38: /* type: CHAR '(' VALUE_INT ')'  */
+#line 263 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_STRING, (yyvsp[-1].sv_int));
     }
-#line 1894 "yacc.tab.cpp"
+#line 1987 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 33: /* type: FLOAT  */
-#line 209 "yacc.y"
+  case 39: /* type: FLOAT  */
+#line 267 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(double));
     }
-#line 1902 "yacc.tab.cpp"
+#line 1995 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 34: /* type: BIGINT  */
-#line 213 "yacc.y"
+  case 40: /* type: BIGINT  */
+#line 271 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_BIGINT, sizeof(long long));
     }
-#line 1910 "yacc.tab.cpp"
+#line 2003 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 35: /* type: DATETIME  */
-#line 217 "yacc.y"
+  case 41: /* type: DATETIME  */
+#line 275 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_DATETIME, sizeof(DateTime));
     }
-#line 1918 "yacc.tab.cpp"
+#line 2011 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 36: /* valueList: value  */
-#line 224 "yacc.y"
+  case 42: /* valueList: value  */
+#line 282 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_vals) = std::vector<std::shared_ptr<Value>>{(yyvsp[0].sv_val)};
     }
-#line 1926 "yacc.tab.cpp"
+#line 2019 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 37: /* valueList: valueList ',' value  */
-#line 228 "yacc.y"
+  case 43: /* valueList: valueList ',' value  */
+#line 286 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_vals).push_back((yyvsp[0].sv_val));
     }
-#line 1934 "yacc.tab.cpp"
+#line 2027 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 38: /* value: VALUE_INT  */
-#line 235 "yacc.y"
+  case 44: /* value: VALUE_INT  */
+#line 293 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<IntLit>((yyvsp[0].sv_int));
     }
-#line 1942 "yacc.tab.cpp"
+#line 2035 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 39: /* value: VALUE_FLOAT  */
-#line 239 "yacc.y"
+  case 45: /* value: VALUE_FLOAT  */
+#line 297 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<FloatLit>((yyvsp[0].sv_float));
     }
-#line 1950 "yacc.tab.cpp"
+#line 2043 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 40: /* value: VALUE_STRING  */
-#line 243 "yacc.y"
+  case 46: /* value: VALUE_STRING  */
+#line 301 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<StringLit>((yyvsp[0].sv_str));
     }
-#line 1958 "yacc.tab.cpp"
+#line 2051 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 41: /* value: VALUE_BIGINT  */
-#line 247 "yacc.y"
+  case 47: /* value: VALUE_BIGINT  */
+#line 305 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<BigintLit>((yyvsp[0].sv_bigint));
     }
-#line 1966 "yacc.tab.cpp"
+#line 2059 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 42: /* value: VALUE_DATETIME  */
-#line 251 "yacc.y"
+  case 48: /* value: VALUE_DATETIME  */
+#line 309 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<DatetimeLit>((yyvsp[0].sv_datetime));
     }
-#line 1974 "yacc.tab.cpp"
+#line 2067 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 43: /* condition: col op expr  */
-#line 258 "yacc.y"
+  case 49: /* condition: col op expr  */
+#line 316 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cond) = std::make_shared<BinaryExpr>((yyvsp[-2].sv_col), (yyvsp[-1].sv_comp_op), (yyvsp[0].sv_expr));
     }
-#line 1982 "yacc.tab.cpp"
+#line 2075 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 44: /* optWhereClause: %empty  */
-#line 264 "yacc.y"
+  case 50: /* optWhereClause: %empty  */
+#line 322 "/root/repo/src/parser/yacc.y"
                       { /* ignore*/ }
-#line 1988 "yacc.tab.cpp"
+#line 2081 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 45: /* optWhereClause: WHERE whereClause  */
-#line 266 "yacc.y"
+  case 51: /* optWhereClause: WHERE whereClause  */
+#line 324 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds) = (yyvsp[0].sv_conds);
     }
-#line 1996 "yacc.tab.cpp"
+#line 2089 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 46: /* whereClause: condition  */
-#line 273 "yacc.y"
+  case 52: /* whereClause: condition  */
+#line 331 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds) = std::vector<std::shared_ptr<BinaryExpr>>{(yyvsp[0].sv_cond)};
     }
-#line 2004 "yacc.tab.cpp"
+#line 2097 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 47: /* whereClause: whereClause AND condition  */
-#line 277 "yacc.y"
+  case 53: /* whereClause: whereClause AND condition  */
+#line 335 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds).push_back((yyvsp[0].sv_cond));
     }
-#line 2012 "yacc.tab.cpp"
+#line 2105 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 48: /* col: tbName '.' colName  */
-#line 284 "yacc.y"
+  case 54: /* col: tbName '.' colName  */
+#line 342 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_col) = std::make_shared<Col>((yyvsp[-2].sv_str), (yyvsp[0].sv_str));
     }
-#line 2020 "yacc.tab.cpp"
+#line 2113 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 49: /* col: colName  */
-#line 288 "yacc.y"
+  case 55: /* col: colName  */
+#line 346 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_col) = std::make_shared<Col>("", (yyvsp[0].sv_str));
     }
-#line 2028 "yacc.tab.cpp"
+#line 2121 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 50: /* colList: col  */
-#line 295 "yacc.y"
+  case 56: /* colList: col  */
+#line 353 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols) = std::vector<std::shared_ptr<Col>>{(yyvsp[0].sv_col)};
     }
-#line 2036 "yacc.tab.cpp"
+#line 2129 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 51: /* colList: colList ',' col  */
-#line 299 "yacc.y"
+  case 57: /* colList: colList ',' col  */
+#line 357 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols).push_back((yyvsp[0].sv_col));
     }
-#line 2044 "yacc.tab.cpp"
+#line 2137 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 52: /* op: '='  */
-#line 306 "yacc.y"
+  case 58: /* op: '='  */
+#line 364 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_EQ;
     }
-#line 2052 "yacc.tab.cpp"
+#line 2145 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 53: /* op: '<'  */
-#line 310 "yacc.y"
+  case 59: /* op: '<'  */
+#line 368 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_LT;
     }
-#line 2060 "yacc.tab.cpp"
+#line 2153 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 54: /* op: '>'  */
-#line 314 "yacc.y"
+  case 60: /* op: '>'  */
+#line 372 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_GT;
     }
-#line 2068 "yacc.tab.cpp"
+#line 2161 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 55: /* op: NEQ  */
-#line 318 "yacc.y"
+  case 61: /* op: NEQ  */
+#line 376 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_NE;
     }
-#line 2076 "yacc.tab.cpp"
+#line 2169 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 56: /* op: LEQ  */
-#line 322 "yacc.y"
+  case 62: /* op: LEQ  */
+#line 380 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_LE;
     }
-#line 2084 "yacc.tab.cpp"
+#line 2177 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 57: /* op: GEQ  */
-#line 326 "yacc.y"
+  case 63: /* op: GEQ  */
+#line 384 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_GE;
     }
-#line 2092 "yacc.tab.cpp"
+#line 2185 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 58: /* expr: value  */
-#line 333 "yacc.y"
+  case 64: /* expr: value  */
+#line 391 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_expr) = std::static_pointer_cast<Expr>((yyvsp[0].sv_val));
     }
-#line 2100 "yacc.tab.cpp"
+#line 2193 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 59: /* expr: col  */
-#line 337 "yacc.y"
+  case 65: /* expr: col  */
+#line 395 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_expr) = std::static_pointer_cast<Expr>((yyvsp[0].sv_col));
     }
-#line 2108 "yacc.tab.cpp"
+#line 2201 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 60: /* setClauses: setClause  */
-#line 344 "yacc.y"
+  case 66: /* setClauses: setClause  */
+#line 402 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clauses) = std::vector<std::shared_ptr<SetClause>>{(yyvsp[0].sv_set_clause)};
     }
-#line 2116 "yacc.tab.cpp"
+#line 2209 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 61: /* setClauses: setClauses ',' setClause  */
-#line 348 "yacc.y"
+  case 67: /* setClauses: setClauses ',' setClause  */
+#line 406 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clauses).push_back((yyvsp[0].sv_set_clause));
     }
-#line 2124 "yacc.tab.cpp"
+#line 2217 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 62: /* setClause: colName '=' value  */
-#line 355 "yacc.y"
+  case 68: /* setClause: colName '=' value  */
+#line 413 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clause) = std::make_shared<SetClause>((yyvsp[-2].sv_str), (yyvsp[0].sv_val));
     }
-#line 2132 "yacc.tab.cpp"
+#line 2225 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 63: /* selector: '*'  */
-#line 362 "yacc.y"
+  case 69: /* selector: '*'  */
+#line 420 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols) = {};
     }
-#line 2140 "yacc.tab.cpp"
+#line 2233 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 65: /* asClause: AS colName  */
-#line 370 "yacc.y"
+  case 71: /* asClause: AS colName  */
+#line 428 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_as_nickname) = (yyvsp[0].sv_str);
     }
-#line 2148 "yacc.tab.cpp"
+#line 2241 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 66: /* asClause: %empty  */
-#line 374 "yacc.y"
+  case 72: /* asClause: %empty  */
+#line 432 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_as_nickname) = {};
     }
-#line 2156 "yacc.tab.cpp"
+#line 2249 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 67: /* aggClause: SUM '(' col ')' asClause  */
-#line 381 "yacc.y"
+  case 73: /* aggClause: SUM '(' col ')' asClause  */
+#line 439 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_agg_clause) = std::make_shared<AggClause>(T_SUM, (yyvsp[-2].sv_col), (yyvsp[0].sv_as_nickname));
     }
-#line 2164 "yacc.tab.cpp"
+#line 2257 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 68: /* aggClause: MAX '(' col ')' asClause  */
-#line 385 "yacc.y"
+  case 74: /* aggClause: MAX '(' col ')' asClause  */
+#line 443 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_agg_clause) = std::make_shared<AggClause>(T_MAX, (yyvsp[-2].sv_col), (yyvsp[0].sv_as_nickname));
     }
-#line 2172 "yacc.tab.cpp"
+#line 2265 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 69: /* aggClause: MIN '(' col ')' asClause  */
-#line 389 "yacc.y"
+  case 75: /* aggClause: MIN '(' col ')' asClause  */
+#line 447 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_agg_clause) = std::make_shared<AggClause>(T_MIN, (yyvsp[-2].sv_col), (yyvsp[0].sv_as_nickname));
     }
-#line 2180 "yacc.tab.cpp"
+#line 2273 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 70: /* aggClause: COUNT '(' '*' ')' asClause  */
-#line 393 "yacc.y"
+  case 76: /* aggClause: COUNT '(' '*' ')' asClause  */
+#line 451 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_agg_clause) = std::make_shared<AggClause>(T_COUNT, std::make_shared<Col>("", ""), (yyvsp[0].sv_as_nickname));
     }
-#line 2188 "yacc.tab.cpp"
+#line 2281 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 71: /* aggClause: COUNT '(' col ')' asClause  */
-#line 397 "yacc.y"
+  case 77: /* aggClause: COUNT '(' col ')' asClause  */
+#line 455 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_agg_clause) = std::make_shared<AggClause>(T_COUNT, (yyvsp[-2].sv_col), (yyvsp[0].sv_as_nickname));
     }
-#line 2196 "yacc.tab.cpp"
+#line 2289 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 72: /* aggClauses: aggClause  */
-#line 404 "yacc.y"
+  case 78: /* aggClauses: aggClause  */
+#line 462 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_agg_clauses) = std::vector<std::shared_ptr<AggClause>>{(yyvsp[0].sv_agg_clause)};
     }
-#line 2204 "yacc.tab.cpp"
+#line 2297 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 73: /* aggClauses: aggClauses ',' aggClause  */
-#line 408 "yacc.y"
+  case 79: /* aggClauses: aggClauses ',' aggClause  */
+#line 466 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_agg_clauses).push_back((yyvsp[0].sv_agg_clause));
     }
-#line 2212 "yacc.tab.cpp"
+#line 2305 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 74: /* aggregator: aggClauses  */
-#line 415 "yacc.y"
+  case 80: /* aggregator: aggClauses  */
+#line 473 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_agg_clauses) = (yyvsp[0].sv_agg_clauses);
     }
-#line 2220 "yacc.tab.cpp"
+#line 2313 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 75: /* tableList: tbName  */
-#line 422 "yacc.y"
+  case 81: /* tableList: tbName  */
+#line 480 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs) = std::vector<std::string>{(yyvsp[0].sv_str)};
     }
-#line 2228 "yacc.tab.cpp"
+#line 2321 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 76: /* tableList: tableList ',' tbName  */
-#line 426 "yacc.y"
+  case 82: /* tableList: tableList ',' tbName  */
+#line 484 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 2236 "yacc.tab.cpp"
+#line 2329 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 77: /* tableList: tableList JOIN tbName  */
-#line 430 "yacc.y"
+  case 83: /* tableList: tableList JOIN tbName  */
+#line 488 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 2244 "yacc.tab.cpp"
+#line 2337 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 78: /* opt_order_clause: ORDER BY order_clause  */
-#line 437 "yacc.y"
+  case 84: /* opt_order_clause: ORDER BY order_clause  */
+#line 495 "/root/repo/src/parser/yacc.y"
     { 
         (yyval.sv_orderbys) = (yyvsp[0].sv_orderbys); 
     }
-#line 2252 "yacc.tab.cpp"
+#line 2345 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 79: /* opt_order_clause: %empty  */
-#line 440 "yacc.y"
+  case 85: /* opt_order_clause: %empty  */
+#line 498 "/root/repo/src/parser/yacc.y"
                       { /* ignore*/ }
-#line 2258 "yacc.tab.cpp"
+#line 2351 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 80: /* order: col opt_asc_desc  */
-#line 445 "yacc.y"
+  case 86: /* order: col opt_asc_desc  */
+#line 503 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_orderby) = std::make_shared<OrderBy>((yyvsp[-1].sv_col), (yyvsp[0].sv_orderby_dir));
     }
-#line 2266 "yacc.tab.cpp"
+#line 2359 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 81: /* order_clause: order  */
-#line 452 "yacc.y"
+  case 87: /* order_clause: order  */
+#line 510 "/root/repo/src/parser/yacc.y"
     { 
         (yyval.sv_orderbys).push_back((yyvsp[0].sv_orderby));
     }
-#line 2274 "yacc.tab.cpp"
+#line 2367 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 82: /* order_clause: order_clause ',' order  */
-#line 456 "yacc.y"
+  case 88: /* order_clause: order_clause ',' order  */
+#line 514 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_orderbys).push_back((yyvsp[0].sv_orderby));
     }
-#line 2282 "yacc.tab.cpp"
+#line 2375 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 83: /* opt_asc_desc: ASC  */
-#line 462 "yacc.y"
+  case 89: /* opt_asc_desc: ASC  */
+#line 520 "/root/repo/src/parser/yacc.y"
                  { (yyval.sv_orderby_dir) = OrderBy_ASC;     }
-#line 2288 "yacc.tab.cpp"
+#line 2381 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 84: /* opt_asc_desc: DESC  */
-#line 463 "yacc.y"
+  case 90: /* opt_asc_desc: DESC  */
+#line 521 "/root/repo/src/parser/yacc.y"
                  { (yyval.sv_orderby_dir) = OrderBy_DESC;    }
-#line 2294 "yacc.tab.cpp"
+#line 2387 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 85: /* opt_asc_desc: %empty  */
-#line 464 "yacc.y"
+  case 91: /* opt_asc_desc: %empty  */
+#line 522 "/root/repo/src/parser/yacc.y"
             { (yyval.sv_orderby_dir) = OrderBy_DEFAULT; }
-#line 2300 "yacc.tab.cpp"
+#line 2393 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 86: /* limit_clause: LIMIT VALUE_INT  */
-#line 469 "yacc.y"
+  case 92: /* limit_clause: LIMIT VALUE_INT  */
+#line 527 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_limit) = (yyvsp[0].sv_int);
     }
-#line 2308 "yacc.tab.cpp"
+#line 2401 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 87: /* limit_clause: %empty  */
-#line 472 "yacc.y"
+  case 93: /* limit_clause: %empty  */
+#line 530 "/root/repo/src/parser/yacc.y"
         { (yyval.sv_limit) = -1; }
-#line 2314 "yacc.tab.cpp"
+#line 2407 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
 
-#line 2318 "yacc.tab.cpp"
+#line 2411 "/root/repo/src/parser/yacc.tab.cpp"
 
       default: break;
     }
@@ -2543,5 +2636,5 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 478 "yacc.y"
+#line 536 "/root/repo/src/parser/yacc.y"
 
@@ -1,6 +1,7 @@
 %{
 #include "ast.h"
 #include "yacc.tab.h"
+#include <strings.h>
 #include <iostream>
 #include <memory>
 
@@ -45,7 +46,7 @@ SUM MAX MIN COUNT AS
 %type <sv_val> value
 %type <sv_vals> valueList
 %type <sv_str> tbName colName
-%type <sv_strs> tableList colNameList
+%type <sv_strs> tableList colNameList tableOptionList
 %type <sv_col> col
 %type <sv_cols> colList selector
 %type <sv_set_clause> setClause
@@ -119,6 +120,15 @@ dbStmt:
     {
         $$ = std::make_shared<ShowIndex>($4);
     }
+    |   SHOW IDENTIFIER IDENTIFIER
+    {
+        // buffer和stats不作为保留字，以免与同名的表和列冲突
+        if (strcasecmp($2.c_str(), "buffer") != 0 || strcasecmp($3.c_str(), "stats") != 0) {
+            yyerror(&@$, "syntax error, expecting SHOW BUFFER STATS");
+            YYERROR;
+        }
+        $$ = std::make_shared<ShowBufferStats>();
+    }
     ;
 
 ddl:
@@ -126,6 +136,22 @@ ddl:
     {
         $$ = std::make_shared<CreateTable>($3, $5);
     }
+    |   CREATE TABLE tbName '(' fieldList ')' tableOptionList
+    {
+        // format和compression不作为保留字，以免与同名的表和列冲突
+        auto create_table = std::make_shared<CreateTable>($3, $5);
+        for (size_t i = 0; i < $7.size(); i += 2) {
+            if (strcasecmp($7[i].c_str(), "format") == 0) {
+                create_table->format = $7[i + 1];
+            } else if (strcasecmp($7[i].c_str(), "compression") == 0) {
+                create_table->compression = $7[i + 1];
+            } else {
+                yyerror(&@$, "syntax error, expecting FORMAT = ... or COMPRESSION = ...");
+                YYERROR;
+            }
+        }
+        $$ = create_table;
+    }
     |   DROP TABLE tbName
     {
         $$ = std::make_shared<DropTable>($3);
@@ -138,6 +164,17 @@ ddl:
     {
         $$ = std::make_shared<CreateIndex>($3, $5);
     }
+    |   CREATE INDEX tbName '(' colNameList ')' IDENTIFIER '=' VALUE_INT
+    {
+        // 与建表选项相同，fillfactor不作为保留字
+        if (strcasecmp($7.c_str(), "fillfactor") != 0) {
+            yyerror(&@$, "syntax error, expecting FILLFACTOR = ...");
+            YYERROR;
+        }
+        auto create_index = std::make_shared<CreateIndex>($3, $5);
+        create_index->fill_factor = $9;
+        $$ = create_index;
+    }
     |   DROP INDEX tbName '(' colNameList ')'
     {
         $$ = std::make_shared<DropIndex>($3, $5);
@@ -165,6 +202,15 @@ dml:
     {
         $$ = std::make_shared<SelectStmt>($2, $4, $5, $6, $7);
     }
+    |   IDENTIFIER VALUE_STRING INTO tbName
+    {
+        // load不作为保留字，以免与同名的表和列冲突
+        if (strcasecmp($1.c_str(), "load") != 0) {
+            yyerror(&@$, "syntax error, expecting LOAD 'file' INTO table");
+            YYERROR;
+        }
+        $$ = std::make_shared<LoadData>($2, $4);
+    }
     ;
 
 fieldList:
@@ -189,6 +235,18 @@ colNameList:
     }
     ;
 
+tableOptionList:
+        IDENTIFIER '=' IDENTIFIER
+    {
+        $$ = std::vector<std::string>{$1, $3};
+    }
+    |   tableOptionList IDENTIFIER '=' IDENTIFIER
+    {
+        $$.push_back($2);
+        $$.push_back($4);
+    }
+    ;
+
 field:
         colName type
     {
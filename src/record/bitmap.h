@@ -31,7 +31,7 @@ class Bitmap {
     static bool is_set(const char *bm, int pos) { return (bm[get_bucket(pos)] & get_bit(pos)) != 0; }
 
     /**
-     * @brief 找下一个为0 or 1的位
+     * @brief 找下一个为0 or 1的位，每次比较64位，跳过整字全为0(找1时)或全为1(找0时)的区域
      * @param bit false表示要找下一个为0的位，true表示要找下一个为1的位
      * @param bm 要找的起始地址为bm
      * @param max_n 要找的从起始地址开始的偏移为[curr+1,max_n)
@@ -39,12 +39,70 @@ class Bitmap {
      * @return 找到了就返回偏移位置，没找到就返回max_n
      */
     static int next_bit(bool bit, const char *bm, int max_n, int curr) {
-        for (int i = curr + 1; i < max_n; i++) {
-            if (is_set(bm, i) == bit) {
-                return i;
+        int pos = curr + 1;
+        if (pos >= max_n) {
+            return max_n;
+        }
+        int num_bytes = get_bucket(max_n - 1) + 1;
+        uint64_t flip = bit ? 0 : ~static_cast<uint64_t>(0);
+        int byte = get_bucket(pos);
+        // 第一个字中屏蔽掉pos之前的位
+        uint64_t word = (load_word(bm, byte, num_bytes) ^ flip) & (~static_cast<uint64_t>(0) >> (pos % BITMAP_WIDTH));
+        while (word == 0) {
+            byte += sizeof(uint64_t);
+            if (byte >= num_bytes) {
+                return max_n;
+            }
+            word = load_word(bm, byte, num_bytes) ^ flip;
+        }
+        // 位图中靠前的位在字的高位
+        int i = byte * BITMAP_WIDTH + __builtin_clzll(word);
+        return i < max_n ? i : max_n;
+    }
+
+    /**
+     * @brief 按从小到大的顺序对[0,max_n)中每个为1的位调用一次f(pos)
+     * @param bm 位图起始地址
+     * @param max_n 位图中有效的位数
+     * @param f 回调函数，参数为int类型的位偏移
+     */
+    template <typename F>
+    static void for_each_set(const char *bm, int max_n, F &&f) {
+        if (max_n <= 0) {
+            return;
+        }
+        int num_bytes = get_bucket(max_n - 1) + 1;
+        for (int byte = 0; byte < num_bytes; byte += sizeof(uint64_t)) {
+            uint64_t word = load_word(bm, byte, num_bytes);
+            while (word != 0) {
+                int i = byte * BITMAP_WIDTH + __builtin_clzll(word);
+                if (i >= max_n) {
+                    return;
+                }
+                f(i);
+                // 清掉已经处理的最高位
+                word &= ~(static_cast<uint64_t>(1) << (63 - __builtin_clzll(word)));
+            }
+        }
+    }
+
+    // [0,max_n)中为1的位的个数
+    static int count(const char *bm, int max_n) {
+        if (max_n <= 0) {
+            return 0;
+        }
+        int num_bytes = get_bucket(max_n - 1) + 1;
+        int n = 0;
+        for (int byte = 0; byte < num_bytes; byte += sizeof(uint64_t)) {
+            uint64_t word = load_word(bm, byte, num_bytes);
+            // 最后一个字中屏蔽掉max_n之后的位
+            int valid = max_n - byte * BITMAP_WIDTH;
+            if (valid < 64) {
+                word &= ~(~static_cast<uint64_t>(0) >> valid);
             }
+            n += __builtin_popcountll(word);
         }
-        return max_n;
+        return n;
     }
 
     // 找第一个为0 or 1的位
@@ -58,4 +116,26 @@ class Bitmap {
     static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
 
     static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
+
+    /**
+     * @brief 从第byte个字节开始按大端序读出一个64位的字，使位图中靠前的位位于字的高位
+     * 位图末尾不足8个字节时只读有效字节，其余位补0
+     */
+    static uint64_t load_word(const char *bm, int byte, int num_bytes) {
+        uint64_t word = 0;
+        if (byte + static_cast<int>(sizeof(uint64_t)) <= num_bytes) {
+            memcpy(&word, bm + byte, sizeof(uint64_t));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            word = __builtin_bswap64(word);
+#endif
+            return word;
+        }
+        for (int i = 0; i < static_cast<int>(sizeof(uint64_t)); i++) {
+            word <<= BITMAP_WIDTH;
+            if (byte + i < num_bytes) {
+                word |= static_cast<unsigned char>(bm[byte + i]);
+            }
+        }
+        return word;
+    }
 };
@@ -18,18 +18,46 @@ constexpr int RM_FILE_HDR_PAGE = 0;
 constexpr int RM_FIRST_RECORD_PAGE = 1;
 constexpr int RM_MAX_RECORD_SIZE = 512;
 
+constexpr char RM_FSM_SUFFIX[] = ".fsm";    // 空闲空间映射文件名的后缀，与数据文件同名
+constexpr int RM_FSM_BITS = 4;              // 空闲空间映射中每个页面占用的位数
+constexpr int RM_FSM_MAX_CATEGORY = (1 << RM_FSM_BITS) - 1;     // 空页面的空闲等级，已满的页面为0
+constexpr int RM_FSM_ENTRIES_PER_PAGE = PAGE_SIZE * 8 / RM_FSM_BITS;   // 每个空闲空间映射页面记录的数据页面个数
+constexpr int RM_INSERT_TARGETS = 16;       // 插入目标页面的槽数，不同线程按线程号散列到不同的槽
+constexpr int RM_MAX_FIELDS = 64;           // 文件头中字段定义的最大个数
+
+constexpr char RM_ZONE_MAP_SUFFIX[] = ".zmap";  // 区域映射文件名的后缀，与数据文件同名
+constexpr int RM_ZONE_PAGES_PER_CHUNK = 1024;   // 区域映射按块扩充，每块记录的数据页面个数
+
+/* 表数据文件的页面格式，创建表时指定 */
+enum RmPageFormat {
+    RM_FORMAT_FIXED = 0,    // 定长格式，每个slot存放一条record_size字节的记录
+    RM_FORMAT_SLOTTED = 1,  // 变长格式，页内有slot目录，CHAR字段去掉末尾的'\0'后按实际长度存放
+    RM_FORMAT_PAX = 2,      // 按列分组的定长格式，页面中每一列的值连续存放在各自的minipage中
+};
+
+/**
+ * 记录中[offset, offset+len)这段字节构成的字段。变长格式中是按实际长度存放的CHAR字段，
+ * PAX格式中是记录的所有列，按偏移排序并且首尾相接
+ */
+struct RmField {
+    int offset;
+    int len;
+};
+
 /* 文件头，记录表数据文件的元信息，写入磁盘中文件的第0号页面 */
 struct RmFileHdr {
     int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
     int num_pages;              // 文件中分配的页面个数（初始化为1）
     int num_records_per_page;   // 每个页面最多能存储的元组个数
-    int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
+    int first_free_page_no;     // 已不再使用，空闲页面由RmFreeSpaceMap记录，保留以兼容文件格式（初始化为-1）
     int bitmap_size;            // 每个页面bitmap大小
+    int format;                 // 页面格式，见RmPageFormat，旧版本的文件中为0
+    int num_fields;             // 字段定义的个数，RmField数组紧跟在第0号页面的文件头之后
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
 struct RmPageHdr {
-    int next_free_page_no;  // 当前页面满了之后，下一个包含空闲空间的页面号（初始化为-1）
+    int next_free_page_no;  // 已不再使用，空闲页面由RmFreeSpaceMap记录，保留以兼容页面格式（初始化为-1）
     int num_records;        // 当前页面中当前已经存储的记录个数（初始化为0）
 };
 
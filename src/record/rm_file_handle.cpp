@@ -10,6 +10,13 @@ See the Mulan PSL v2 for more details. */
 
 #include "rm_file_handle.h"
 
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+#include "rm_scan.h"
+#include "rm_slotted_page.h"
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
@@ -26,62 +33,125 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
         context->lock_mgr_->lock_shared_on_record(context->txn_, rid, fd_);
     }
 
+    if (is_slotted()) {
+        auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+        read_record(rid, record->data, nullptr);
+        return record;
+    }
+
     RmPageHandle rmPageHandle = fetch_page_handle(rid.page_no);
     // 检查 slot是否存在
     if (!Bitmap::is_set(rmPageHandle.bitmap, rid.slot_no)) {
+        unpin_page_handle(rmPageHandle, false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
 
-    return std::make_unique<RmRecord>(file_hdr_.record_size, rmPageHandle.get_slot(rid.slot_no));
+    std::unique_ptr<RmRecord> record;
+    if (is_pax()) {
+        record = std::make_unique<RmRecord>(file_hdr_.record_size);
+        pax_page(rmPageHandle).gather(rid.slot_no, record->data);
+    } else {
+        record = std::make_unique<RmRecord>(file_hdr_.record_size, rmPageHandle.get_slot(rid.slot_no));
+    }
+    unpin_page_handle(rmPageHandle, false);
+    return record;
 }
 
 /**
- * @description: 在当前表中插入一条记录，不指定插入位置
- * @param {char*} buf 要插入的记录的数据
+ * @description: 获取当前表中记录号为rid的记录的只读视图，定长格式的表不拷贝记录数据
+ * @param {Rid&} rid 记录号，指定记录的位置
  * @param {Context*} context
- * @return {Rid} 插入的记录的记录号（位置）
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，为空时使用共享的缓冲池
+ * @return {RmRecordRef} 指向页面中slot的视图，视图析构前页面一直被pin住；变长格式和PAX格式的表返回拼好的记录
  */
-Rid RmFileHandle::insert_record(char* buf, Context* context) {
-    // Todo:
-    // 1. 获取当前未满的page handle
-    // 2. 在page handle中找到空闲slot位置
-    // 3. 将buf复制到空闲slot位置
-    // 4. 更新page_handle.page_hdr中的数据结构
-    // 注意考虑插入一条记录后页面已满的情况，需要更新file_hdr_.first_free_page_no
-
-    auto pageHandle = create_page_handle();
-    int slot_no = Bitmap::first_bit(false, pageHandle.bitmap, file_hdr_.num_records_per_page);
-
-    Rid rid{pageHandle.page->get_page_id().page_no, slot_no};
-    // 申请行级写锁
+RmRecordRef RmFileHandle::get_record_ref(const Rid& rid, Context* context, BufferAccessStrategy* strategy) const {
+    // 申请行级读锁
     if (context) {
-        context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
+        context->lock_mgr_->lock_shared_on_record(context->txn_, rid, fd_);
     }
 
-    char* slot = pageHandle.get_slot(slot_no);
-    memcpy(slot, buf, file_hdr_.record_size);
+    if (is_slotted()) {
+        auto buf = std::make_unique<char[]>(file_hdr_.record_size);
+        read_record(rid, buf.get(), strategy);
+        return {std::move(buf), file_hdr_.record_size};
+    }
 
-    Bitmap::set(pageHandle.bitmap, slot_no);
-    pageHandle.page_hdr->num_records++;
-    // 页面已满
-    if (pageHandle.page_hdr->num_records == pageHandle.file_hdr->num_records_per_page) {
-        file_hdr_.first_free_page_no = pageHandle.page_hdr->next_free_page_no;
+    RmPageHandle rmPageHandle = fetch_page_handle(rid.page_no, strategy);
+    if (!Bitmap::is_set(rmPageHandle.bitmap, rid.slot_no)) {
+        unpin_page_handle(rmPageHandle, false);
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    if (is_pax()) {
+        auto buf = std::make_unique<char[]>(file_hdr_.record_size);
+        pax_page(rmPageHandle).gather(rid.slot_no, buf.get());
+        unpin_page_handle(rmPageHandle, false);
+        return {std::move(buf), file_hdr_.record_size};
+    }
+    return {buffer_pool_manager_, rmPageHandle.page, rmPageHandle.get_slot(rid.slot_no), file_hdr_.record_size};
+}
+
+/**
+ * @description: 在当前表中插入一条记录，不指定插入位置
+ * @param {char*} buf 要插入的记录的数据
+ * @param {Context*} context
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，批量导入时使用，避免新页面冲刷缓冲池
+ * @return {Rid} 插入的记录的记录号（位置）
+ */
+Rid RmFileHandle::insert_record(char* buf, Context* context, BufferAccessStrategy* strategy) {
+    Rid rid;
+    if (!is_slotted()) {
+        rid = place_record(buf, file_hdr_.record_size, 0, context, strategy);
+    } else {
+        char data[PAGE_SIZE];
+        int len = encode_record(buf, data);
+        rid = place_record(data, len, 0, context, strategy);
     }
+    zone_map_.widen(rid.page_no, buf);
     return rid;
 }
 
 /**
- * @description: 在当前表中的指定位置插入一条记录
+ * @description: 在当前表中的指定位置插入一条记录，用于回滚删除操作
  * @param {Rid&} rid 要插入记录的位置
  * @param {char*} buf 要插入记录的数据
  */
 void RmFileHandle::insert_record(const Rid& rid, char* buf, Context* context) {
     context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
+    zone_map_.widen(rid.page_no, buf);
     auto pageHandle = fetch_page_handle(rid.page_no);
-    char* slot = pageHandle.get_slot(rid.slot_no);
-    memcpy(slot, buf, file_hdr_.record_size);
+    pageHandle.page->WLatch();
+    int old_category = page_category(pageHandle);
+    if (is_slotted()) {
+        char data[PAGE_SIZE];
+        int len = encode_record(buf, data);
+        RmSlottedPage page(pageHandle);
+        if (page.is_used(rid.slot_no)) {
+            pageHandle.page->WUnlatch();
+            unpin_page_handle(pageHandle, false);
+            throw InternalError("RmFileHandle::insert_record: slot is occupied");
+        }
+        if (!page.insert(rid.slot_no, data, len, 0)) {
+            // 删除之后页面被其他记录占用，记录迁移到其他页面，原位置存放迁移后的Rid
+            pageHandle.page->WUnlatch();
+            Rid moved = place_record(data, len, RM_SLOT_MOVED, context, nullptr);
+            pageHandle.page->WLatch();
+            if (!page.insert(rid.slot_no, reinterpret_cast<const char*>(&moved), sizeof(Rid), RM_SLOT_FORWARD)) {
+                pageHandle.page->WUnlatch();
+                unpin_page_handle(pageHandle, false);
+                erase_moved_record(moved);
+                throw InternalError("RmFileHandle::insert_record: no space for forwarding slot");
+            }
+        }
+    } else if (is_pax()) {
+        pax_page(pageHandle).scatter(rid.slot_no, buf);
+    } else {
+        memcpy(pageHandle.get_slot(rid.slot_no), buf, file_hdr_.record_size);
+    }
     pageHandle.page_hdr->num_records++;
     Bitmap::set(pageHandle.bitmap, rid.slot_no);
+    update_fsm(rid.page_no, old_category, page_category(pageHandle));
+    pageHandle.page->WUnlatch();
+    unpin_page_handle(pageHandle, true);
 }
 
 /**
@@ -90,25 +160,36 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf, Context* context) {
  * @param {Context*} context
  */
 void RmFileHandle::delete_record(const Rid& rid, Context* context) {
-    // Todo:
-    // 1. 获取指定记录所在的page handle
-    // 2. 更新page_handle.page_hdr中的数据结构
-    // 注意考虑删除一条记录后页面未满的情况，需要调用release_page_handle()
-
     // 申请行级写锁
     if (context) {
         context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
     }
 
     auto pageHandle = fetch_page_handle(rid.page_no);
+    pageHandle.page->WLatch();
     if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
+        pageHandle.page->WUnlatch();
+        unpin_page_handle(pageHandle, false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
+    int old_category = page_category(pageHandle);
+    Rid moved{RM_NO_PAGE, -1};
+    if (is_slotted()) {
+        RmSlottedPage page(pageHandle);
+        if (page.flags(rid.slot_no) & RM_SLOT_FORWARD) {
+            memcpy(&moved, page.get(rid.slot_no), sizeof(Rid));
+        }
+        page.erase(rid.slot_no);
+    }
     // 1 变 0
     Bitmap::reset(pageHandle.bitmap, rid.slot_no);
-    // pageHandle.page_hdr->num_records--;
-    if (pageHandle.page_hdr->num_records-- == file_hdr_.num_records_per_page) {
-        release_page_handle(pageHandle);
+    pageHandle.page_hdr->num_records--;
+    // 释放出的空间记入空闲空间映射，之后的插入可以复用
+    update_fsm(rid.page_no, old_category, page_category(pageHandle));
+    pageHandle.page->WUnlatch();
+    unpin_page_handle(pageHandle, true);
+    if (moved.page_no != RM_NO_PAGE) {
+        erase_moved_record(moved);
     }
 }
 
@@ -130,11 +211,482 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     }
 
     auto pageHandle = fetch_page_handle(rid.page_no);
+    pageHandle.page->WLatch();
     if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
+        pageHandle.page->WUnlatch();
+        unpin_page_handle(pageHandle, false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
-    auto slot = pageHandle.get_slot(rid.slot_no);
-    memcpy(slot, buf, file_hdr_.record_size);
+    // 迁移到其他页面的记录仍计入原来的页面，旧值留在范围中，范围只会扩大
+    zone_map_.widen(rid.page_no, buf);
+    if (!is_slotted()) {
+        if (is_pax()) {
+            pax_page(pageHandle).scatter(rid.slot_no, buf);
+        } else {
+            memcpy(pageHandle.get_slot(rid.slot_no), buf, file_hdr_.record_size);
+        }
+        pageHandle.page->WUnlatch();
+        unpin_page_handle(pageHandle, true);
+        return;
+    }
+
+    char data[PAGE_SIZE];
+    int len = encode_record(buf, data);
+    int old_category = page_category(pageHandle);
+    RmSlottedPage page(pageHandle);
+    Rid old_target{RM_NO_PAGE, -1};
+    if (page.flags(rid.slot_no) & RM_SLOT_FORWARD) {
+        memcpy(&old_target, page.get(rid.slot_no), sizeof(Rid));
+    } else if (page.update(rid.slot_no, data, len, 0)) {
+        update_fsm(rid.page_no, old_category, page_category(pageHandle));
+        pageHandle.page->WUnlatch();
+        unpin_page_handle(pageHandle, true);
+        return;
+    }
+    pageHandle.page->WUnlatch();
+    unpin_page_handle(pageHandle, false);
+
+    // 已经迁移的记录先尝试在迁移后的位置原地修改
+    if (old_target.page_no != RM_NO_PAGE) {
+        auto targetHandle = fetch_page_handle(old_target.page_no);
+        targetHandle.page->WLatch();
+        int target_old_category = page_category(targetHandle);
+        if (RmSlottedPage(targetHandle).update(old_target.slot_no, data, len, RM_SLOT_MOVED)) {
+            update_fsm(old_target.page_no, target_old_category, page_category(targetHandle));
+            targetHandle.page->WUnlatch();
+            unpin_page_handle(targetHandle, true);
+            return;
+        }
+        targetHandle.page->WUnlatch();
+        unpin_page_handle(targetHandle, false);
+    }
+
+    // 页面中放不下，记录迁移到其他页面，原位置改为存放迁移后的Rid，记录号保持不变。
+    // 行级写锁保证期间没有其他事务修改这条记录，原位置变短，一定放得下
+    Rid new_target = place_record(data, len, RM_SLOT_MOVED, context, nullptr);
+    pageHandle = fetch_page_handle(rid.page_no);
+    pageHandle.page->WLatch();
+    old_category = page_category(pageHandle);
+    bool stub_fits = RmSlottedPage(pageHandle).update(rid.slot_no, reinterpret_cast<const char*>(&new_target),
+                                                      sizeof(Rid), RM_SLOT_FORWARD);
+    assert(stub_fits);
+    update_fsm(rid.page_no, old_category, page_category(pageHandle));
+    pageHandle.page->WUnlatch();
+    unpin_page_handle(pageHandle, true);
+    if (old_target.page_no != RM_NO_PAGE) {
+        erase_moved_record(old_target);
+    }
+}
+
+/**
+ * @description: 批量读取记录，rid按页面分组，每个页面只fetch一次，在一次读锁内读出该页上的所有记录
+ * @param {vector<Rid>&} rids 要读取的记录号，可以乱序、跨页
+ * @param {Context*} context
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略
+ * @return {vector<unique_ptr<RmRecord>>} 与rids一一对应的记录
+ */
+std::vector<std::unique_ptr<RmRecord>> RmFileHandle::get_records(const std::vector<Rid>& rids, Context* context,
+                                                                 BufferAccessStrategy* strategy) const {
+    // 申请行级读锁
+    if (context) {
+        for (auto& rid : rids) {
+            context->lock_mgr_->lock_shared_on_record(context->txn_, rid, fd_);
+        }
+    }
+
+    std::vector<std::unique_ptr<RmRecord>> records(rids.size());
+    std::vector<size_t> order = group_by_page(rids);
+    std::vector<size_t> forwarded;
+    for (size_t begin = 0, end; begin < order.size(); begin = end) {
+        page_id_t page_no = rids[order[begin]].page_no;
+        for (end = begin + 1; end < order.size() && rids[order[end]].page_no == page_no; end++) {
+        }
+        auto pageHandle = fetch_page_handle(page_no, strategy);
+        pageHandle.page->RLatch();
+        for (size_t k = begin; k < end; k++) {
+            size_t i = order[k];
+            int slot_no = rids[i].slot_no;
+            if (!Bitmap::is_set(pageHandle.bitmap, slot_no)) {
+                pageHandle.page->RUnlatch();
+                unpin_page_handle(pageHandle, false);
+                throw RecordNotFoundError(page_no, slot_no);
+            }
+            records[i] = std::make_unique<RmRecord>(file_hdr_.record_size);
+            if (is_slotted()) {
+                RmSlottedPage page(pageHandle);
+                if (page.flags(slot_no) & RM_SLOT_FORWARD) {
+                    // 已迁移的记录在另一个页面上，释放本页后再读
+                    forwarded.push_back(i);
+                } else {
+                    decode_record(page.get(slot_no), page.size(slot_no), records[i]->data);
+                }
+            } else if (is_pax()) {
+                pax_page(pageHandle).gather(slot_no, records[i]->data);
+            } else {
+                memcpy(records[i]->data, pageHandle.get_slot(slot_no), file_hdr_.record_size);
+            }
+        }
+        pageHandle.page->RUnlatch();
+        unpin_page_handle(pageHandle, false);
+    }
+    for (size_t i : forwarded) {
+        read_record(rids[i], records[i]->data, strategy);
+    }
+    return records;
+}
+
+/**
+ * @description: 批量插入记录，连续放入同一个页面的记录只pin一次、加一次写锁，空闲空间映射每页只更新一次
+ * @param {vector<const char*>&} bufs 要插入的记录，长度均为record_size
+ * @param {Context*} context 不为空时申请每条记录的行级写锁，失败时撤销本批插入
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略
+ * @return {vector<Rid>} 与bufs一一对应的记录号
+ */
+std::vector<Rid> RmFileHandle::insert_records(const std::vector<const char*>& bufs, Context* context,
+                                              BufferAccessStrategy* strategy) {
+    std::vector<Rid> rids;
+    rids.reserve(bufs.size());
+    if (bufs.empty()) {
+        return rids;
+    }
+    size_t target_idx = std::hash<std::thread::id>()(std::this_thread::get_id()) % RM_INSERT_TARGETS;
+    auto& target = insert_targets_[target_idx];
+    page_id_t page_no = target.load(std::memory_order_relaxed);
+    page_id_t search_start = RM_FIRST_RECORD_PAGE + file_hdr_.num_pages * target_idx / RM_INSERT_TARGETS;
+
+    // 变长格式的记录逐条编码，data和len总是下一条要放入的记录
+    char encoded[PAGE_SIZE];
+    const char* data = bufs[0];
+    int len = file_hdr_.record_size;
+    auto prepare = [&](size_t i) {
+        if (is_slotted()) {
+            len = encode_record(bufs[i], encoded);
+            data = encoded;
+        } else {
+            data = bufs[i];
+        }
+    };
+    prepare(0);
+    int min_category = 0;
+    int new_category = 0;
+    while (rids.size() < bufs.size()) {
+        min_category = required_category(len);
+        if (page_no == RM_NO_PAGE) {
+            page_no = fsm_.search(min_category, search_start, file_hdr_.num_pages);
+        }
+        auto pageHandle = page_no == RM_NO_PAGE ? create_new_page_handle(strategy) : fetch_page_handle(page_no, strategy);
+        page_no = pageHandle.page->get_page_id().page_no;
+
+        pageHandle.page->WLatch();
+        int old_category = page_category(pageHandle);
+        size_t num_placed = 0;
+        try {
+            while (rids.size() < bufs.size()) {
+                int slot_no = place_on_page(pageHandle, data, len, 0, context);
+                if (slot_no == -1) {
+                    break;
+                }
+                rids.push_back({page_no, slot_no});
+                zone_map_.widen(page_no, bufs[rids.size() - 1]);
+                num_placed++;
+                if (rids.size() < bufs.size()) {
+                    prepare(rids.size());
+                }
+            }
+        } catch (...) {
+            // 行级写锁申请失败，撤销本批插入
+            update_fsm(page_no, old_category, page_category(pageHandle));
+            pageHandle.page->WUnlatch();
+            unpin_page_handle(pageHandle, num_placed > 0);
+            delete_records(rids, nullptr);
+            throw;
+        }
+        new_category = page_category(pageHandle);
+        if (num_placed == 0) {
+            // 映射中的等级已过期，更正后换一个页面
+            fsm_.set(page_no, std::min(old_category, min_category - 1));
+            search_start = page_no + 1;
+        } else {
+            update_fsm(page_no, old_category, new_category);
+        }
+        pageHandle.page->WUnlatch();
+        unpin_page_handle(pageHandle, num_placed > 0);
+        if (rids.size() == bufs.size()) {
+            break;
+        }
+        page_no = RM_NO_PAGE;
+    }
+    target.store(new_category >= min_category ? page_no : RM_NO_PAGE, std::memory_order_relaxed);
+    return rids;
+}
+
+/**
+ * @description: 批量删除记录，rid按页面分组，每个页面只fetch一次、加一次写锁，空闲空间映射每页只更新一次
+ * @param {vector<Rid>&} rids 要删除的记录号，可以乱序、跨页
+ * @param {Context*} context 不为空时申请每条记录的行级写锁
+ * @param {vector<size_t>*} deleted 不为空时追加已经删除的记录在rids中的下标，抛出异常时也只包含真正删除的记录
+ * @note 某个页面上有不存在的记录时抛出RecordNotFoundError，该页面不做修改，之前的页面上的记录已经删除
+ */
+void RmFileHandle::delete_records(const std::vector<Rid>& rids, Context* context, std::vector<size_t>* deleted) {
+    // 申请行级写锁
+    if (context) {
+        for (auto& rid : rids) {
+            context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
+        }
+    }
+
+    std::vector<size_t> order = group_by_page(rids);
+    std::vector<Rid> moved;
+    for (size_t begin = 0, end; begin < order.size(); begin = end) {
+        page_id_t page_no = rids[order[begin]].page_no;
+        for (end = begin + 1; end < order.size() && rids[order[end]].page_no == page_no; end++) {
+        }
+        auto pageHandle = fetch_page_handle(page_no);
+        pageHandle.page->WLatch();
+        for (size_t k = begin; k < end; k++) {
+            int slot_no = rids[order[k]].slot_no;
+            if (!Bitmap::is_set(pageHandle.bitmap, slot_no)) {
+                pageHandle.page->WUnlatch();
+                unpin_page_handle(pageHandle, false);
+                throw RecordNotFoundError(page_no, slot_no);
+            }
+        }
+        int old_category = page_category(pageHandle);
+        for (size_t k = begin; k < end; k++) {
+            int slot_no = rids[order[k]].slot_no;
+            if (!Bitmap::is_set(pageHandle.bitmap, slot_no)) {
+                continue;   // 同一个rid出现了多次
+            }
+            if (is_slotted()) {
+                RmSlottedPage page(pageHandle);
+                if (page.flags(slot_no) & RM_SLOT_FORWARD) {
+                    moved.emplace_back();
+                    memcpy(&moved.back(), page.get(slot_no), sizeof(Rid));
+                }
+                page.erase(slot_no);
+            }
+            Bitmap::reset(pageHandle.bitmap, slot_no);
+            pageHandle.page_hdr->num_records--;
+            if (deleted) {
+                deleted->push_back(order[k]);
+            }
+        }
+        update_fsm(page_no, old_category, page_category(pageHandle));
+        pageHandle.page->WUnlatch();
+        unpin_page_handle(pageHandle, true);
+    }
+    for (auto& rid : moved) {
+        erase_moved_record(rid);
+    }
+}
+
+/**
+ * @description: 把编码后的记录放入一个有足够空闲空间的页面，insert_record和记录迁移共用
+ * @param {char*} data 要放入的数据，定长格式和PAX格式为原始记录，变长格式为编码后的记录
+ * @param {int} len 数据的长度
+ * @param {uint16_t} flags 变长格式slot的标志，RM_SLOT_MOVED的记录不在bitmap中置位
+ * @param {Context*} context 不为空时申请新位置的行级写锁
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略
+ * @return {Rid} 数据所在的位置
+ */
+Rid RmFileHandle::place_record(const char* data, int len, uint16_t flags, Context* context,
+                               BufferAccessStrategy* strategy) {
+    // 每个线程优先插入自己上次插入的页面，并发的插入因此落在不同的页面上，不会争用同一个页面的锁
+    size_t target_idx = std::hash<std::thread::id>()(std::this_thread::get_id()) % RM_INSERT_TARGETS;
+    auto& target = insert_targets_[target_idx];
+    page_id_t page_no = target.load(std::memory_order_relaxed);
+    page_id_t search_start = RM_FIRST_RECORD_PAGE + file_hdr_.num_pages * target_idx / RM_INSERT_TARGETS;
+    int min_category = required_category(len);
+
+    while (true) {
+        if (page_no == RM_NO_PAGE) {
+            page_no = fsm_.search(min_category, search_start, file_hdr_.num_pages);
+        }
+        auto pageHandle = page_no == RM_NO_PAGE ? create_new_page_handle(strategy) : fetch_page_handle(page_no, strategy);
+        page_no = pageHandle.page->get_page_id().page_no;
+
+        pageHandle.page->WLatch();
+        int old_category = page_category(pageHandle);
+        int slot_no;
+        try {
+            slot_no = place_on_page(pageHandle, data, len, flags, context);
+        } catch (...) {
+            // 行级写锁申请失败，页面没有修改
+            pageHandle.page->WUnlatch();
+            unpin_page_handle(pageHandle, false);
+            throw;
+        }
+        if (slot_no == -1) {
+            // 映射中的等级已过期，更正后换一个页面
+            fsm_.set(page_no, std::min(old_category, min_category - 1));
+            pageHandle.page->WUnlatch();
+            unpin_page_handle(pageHandle, false);
+            search_start = page_no + 1;
+            page_no = RM_NO_PAGE;
+            continue;
+        }
+        int new_category = page_category(pageHandle);
+        update_fsm(page_no, old_category, new_category);
+        pageHandle.page->WUnlatch();
+        unpin_page_handle(pageHandle, true);
+        target.store(new_category >= min_category ? page_no : RM_NO_PAGE, std::memory_order_relaxed);
+        return {page_no, slot_no};
+    }
+}
+
+/**
+ * @description: 在调用者已加写锁的页面中找一个空闲slot，申请行级写锁后放入数据，并更新bitmap和页头
+ * @param {RmPageHandle&} page_handle 页面句柄
+ * @param {char*} data 要放入的数据，定长格式和PAX格式为原始记录，变长格式为编码后的记录
+ * @param {int} len 数据的长度
+ * @param {uint16_t} flags 变长格式slot的标志，RM_SLOT_MOVED的记录不在bitmap中置位
+ * @param {Context*} context 不为空时在写入之前申请新位置的行级写锁，加锁失败时抛出异常，页面不变
+ * @return {int} 放入的slot号，页面放不下时返回-1
+ */
+int RmFileHandle::place_on_page(const RmPageHandle& page_handle, const char* data, int len, uint16_t flags,
+                                Context* context) {
+    int slot_no;
+    if (is_slotted()) {
+        RmSlottedPage page(page_handle);
+        slot_no = page.find_free_slot();
+        if (slot_no == -1 || !page.fits(slot_no, len)) {
+            return -1;
+        }
+    } else {
+        slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
+        if (slot_no >= file_hdr_.num_records_per_page) {
+            return -1;
+        }
+    }
+    // 锁管理器不等待，持有页面的锁时申请行级写锁不会阻塞
+    if (context) {
+        Rid rid{page_handle.page->get_page_id().page_no, slot_no};
+        context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
+    }
+    if (is_slotted()) {
+        RmSlottedPage(page_handle).insert(slot_no, data, len, flags);
+    } else if (is_pax()) {
+        pax_page(page_handle).scatter(slot_no, data);
+    } else {
+        memcpy(page_handle.get_slot(slot_no), data, len);
+    }
+    if (!(flags & RM_SLOT_MOVED)) {
+        Bitmap::set(page_handle.bitmap, slot_no);
+        page_handle.page_hdr->num_records++;
+    }
+    return slot_no;
+}
+
+/**
+ * @description: 把rids的下标按页面号排序，同一页面上的rid相邻，页面内保持原来的顺序
+ * @param {vector<Rid>&} rids 记录号
+ * @return {vector<size_t>} 排序后的下标
+ */
+std::vector<size_t> RmFileHandle::group_by_page(const std::vector<Rid>& rids) {
+    std::vector<size_t> order(rids.size());
+    std::iota(order.begin(), order.end(), 0);
+    // 顺序扫描得到的rid已经按页面排好序
+    if (!std::is_sorted(rids.begin(), rids.end(),
+                        [](const Rid& a, const Rid& b) { return a.page_no < b.page_no; })) {
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return rids[a].page_no < rids[b].page_no; });
+    }
+    return order;
+}
+
+/**
+ * @description: 删除迁移到其他页面的记录
+ * @param {Rid&} rid 迁移后的位置
+ */
+void RmFileHandle::erase_moved_record(const Rid& rid) {
+    auto pageHandle = fetch_page_handle(rid.page_no);
+    pageHandle.page->WLatch();
+    int old_category = page_category(pageHandle);
+    RmSlottedPage(pageHandle).erase(rid.slot_no);
+    update_fsm(rid.page_no, old_category, page_category(pageHandle));
+    pageHandle.page->WUnlatch();
+    unpin_page_handle(pageHandle, true);
+}
+
+/**
+ * @description: 读出变长格式的表中的一条记录并解码，已经迁移的记录到迁移后的位置读取
+ * @param {Rid&} rid 记录号
+ * @param {char*} buf 存放解码后的记录，长度为record_size
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略
+ */
+void RmFileHandle::read_record(const Rid& rid, char* buf, BufferAccessStrategy* strategy) const {
+    auto pageHandle = fetch_page_handle(rid.page_no, strategy);
+    pageHandle.page->RLatch();
+    if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
+        pageHandle.page->RUnlatch();
+        unpin_page_handle(pageHandle, false);
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    RmSlottedPage page(pageHandle);
+    if (page.flags(rid.slot_no) & RM_SLOT_FORWARD) {
+        Rid target;
+        memcpy(&target, page.get(rid.slot_no), sizeof(Rid));
+        pageHandle.page->RUnlatch();
+        unpin_page_handle(pageHandle, false);
+        pageHandle = fetch_page_handle(target.page_no, strategy);
+        pageHandle.page->RLatch();
+        RmSlottedPage target_page(pageHandle);
+        decode_record(target_page.get(target.slot_no), target_page.size(target.slot_no), buf);
+    } else {
+        decode_record(page.get(rid.slot_no), page.size(rid.slot_no), buf);
+    }
+    pageHandle.page->RUnlatch();
+    unpin_page_handle(pageHandle, false);
+}
+
+/**
+ * @description: 把记录编码为变长格式：定长部分原样存放，每个变长字段存为2字节的长度加上去掉末尾'\0'的内容
+ * @param {char*} record 长度为record_size的原始记录
+ * @param {char*} buf 存放编码后的记录
+ * @return {int} 编码后的长度，至少为sizeof(Rid)，以便原位置总能改写为迁移后的Rid
+ */
+int RmFileHandle::encode_record(const char* record, char* buf) const {
+    int pos = 0;
+    int prev = 0;
+    for (auto& field : fields_) {
+        memcpy(buf + pos, record + prev, field.offset - prev);
+        pos += field.offset - prev;
+        uint16_t len = field.len;
+        while (len > 0 && record[field.offset + len - 1] == '\0') {
+            len--;
+        }
+        memcpy(buf + pos, &len, sizeof(len));
+        memcpy(buf + pos + sizeof(len), record + field.offset, len);
+        pos += sizeof(len) + len;
+        prev = field.offset + field.len;
+    }
+    memcpy(buf + pos, record + prev, file_hdr_.record_size - prev);
+    pos += file_hdr_.record_size - prev;
+    if (pos < static_cast<int>(sizeof(Rid))) {
+        memset(buf + pos, 0, sizeof(Rid) - pos);
+        pos = sizeof(Rid);
+    }
+    return pos;
+}
+
+/**
+ * @description: 把变长格式的记录解码为长度为record_size的原始记录，变长字段末尾补'\0'
+ */
+void RmFileHandle::decode_record(const char* data, int len, char* record) const {
+    memset(record, 0, file_hdr_.record_size);
+    int pos = 0;
+    int prev = 0;
+    for (auto& field : fields_) {
+        memcpy(record + prev, data + pos, field.offset - prev);
+        pos += field.offset - prev;
+        uint16_t field_len;
+        memcpy(&field_len, data + pos, sizeof(field_len));
+        memcpy(record + field.offset, data + pos + sizeof(field_len), field_len);
+        pos += sizeof(field_len) + field_len;
+        prev = field.offset + field.len;
+    }
+    assert(pos + file_hdr_.record_size - prev <= len);
+    memcpy(record + prev, data + pos, file_hdr_.record_size - prev);
 }
 
 /**
@@ -143,14 +695,16 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
 /**
  * @description: 获取指定页面的页面句柄
  * @param {int} page_no 页面号
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，为空时使用共享的缓冲池
  * @return {RmPageHandle} 指定页面的句柄
+ * @note pin the page, remember to unpin it with unpin_page_handle!
  */
-RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
+RmPageHandle RmFileHandle::fetch_page_handle(int page_no, BufferAccessStrategy* strategy) const {
     // Todo:
     // 使用缓冲池获取指定页面，并生成page_handle返回给上层
     // if page_no is invalid, throw PageNotExistError exception
 
-    auto page = buffer_pool_manager_->fetch_page(PageId{fd_, page_no});
+    auto page = buffer_pool_manager_->fetch_page(PageId{fd_, page_no}, strategy);
     if (page == nullptr) {
         throw PageNotExistError(std::to_string(fd_), page_no);
     }
@@ -161,56 +715,137 @@ RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
  * @description: 创建一个新的page handle
  * @return {RmPageHandle} 新的PageHandle
  */
-RmPageHandle RmFileHandle::create_new_page_handle() {
-    // Todo:
-    // 1.使用缓冲池来创建一个新page
-    // 2.更新page handle中的相关信息
-    // 3.更新file_hdr_
-
+RmPageHandle RmFileHandle::create_new_page_handle(BufferAccessStrategy* strategy) {
     PageId pageId = {fd_, -1};
     // 获取 page 同时更新 pageId
-    Page* page = buffer_pool_manager_->new_page(&pageId);
+    Page* page = buffer_pool_manager_->new_page(&pageId, strategy);
     if (page) {
-        file_hdr_.first_free_page_no = pageId.page_no;
-        file_hdr_.num_pages++;
+        {
+            // 并发插入的线程可能同时分配新页面，页面号由DiskManager原子地分配，但可能乱序到达这里
+            std::scoped_lock lock{alloc_latch_};
+            file_hdr_.num_pages = std::max(file_hdr_.num_pages, pageId.page_no + 1);
+        }
         auto pageHandle = RmPageHandle(&file_hdr_, page);
         // 初始化所有成员变量
         pageHandle.page_hdr->num_records = 0;
         pageHandle.page_hdr->next_free_page_no = RM_NO_PAGE;
-        Bitmap::init(pageHandle.bitmap, file_hdr_.num_records_per_page);
+        Bitmap::init(pageHandle.bitmap, file_hdr_.bitmap_size);
+        if (is_slotted()) {
+            RmSlottedPage::init(pageHandle);
+        }
+        fsm_.set(pageId.page_no, page_category(pageHandle));
         return pageHandle;
     }
     return {&file_hdr_, nullptr};
 }
 
 /**
- * @brief 创建或获取一个空闲的page handle
- *
- * @return RmPageHandle 返回生成的空闲page handle
- * @note pin the page, remember to unpin it outside!
+ * @description: 计算页面在空闲空间映射中的等级，定长格式按空闲slot数，变长格式按空闲字节数，调用者需持有页面的锁
+ * @param {RmPageHandle&} page_handle 页面句柄
+ * @return {int} 空闲等级，没有空闲slot的页面为0
  */
-RmPageHandle RmFileHandle::create_page_handle() {
-    // Todo:
-    // 1. 判断file_hdr_中是否还有空闲页
-    //     1.1 没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page_handle()
-    //     1.2 有空闲页：直接获取第一个空闲页
-    // 2. 生成page handle并返回给上层
+int RmFileHandle::page_category(const RmPageHandle& page_handle) const {
+    int max_slots = file_hdr_.num_records_per_page;
+    if (!is_slotted()) {
+        return RmFreeSpaceMap::category(max_slots - page_handle.page_hdr->num_records, max_slots);
+    }
+    RmSlottedPage page(page_handle);
+    if (page.find_free_slot() == -1) {
+        return 0;
+    }
+    // 向下取整，等级不低于required_category的页面一定放得下
+    return page.free_space() * RM_FSM_MAX_CATEGORY / RmSlottedPage::capacity(file_hdr_);
+}
 
-    if (file_hdr_.first_free_page_no != INVALID_PAGE_ID) {
-        return fetch_page_handle(file_hdr_.first_free_page_no);
+/**
+ * @description: 计算存放长度为len的数据需要的最低空闲等级
+ */
+int RmFileHandle::required_category(int len) const {
+    if (!is_slotted()) {
+        return 1;
     }
-    return create_new_page_handle();
+    int capacity = RmSlottedPage::capacity(file_hdr_);
+    int needed = len + static_cast<int>(sizeof(RmSlot));
+    return std::max((needed * RM_FSM_MAX_CATEGORY + capacity - 1) / capacity, 1);
 }
 
 /**
- * @description: 当一个页面从没有空闲空间的状态变为有空闲空间状态时，更新文件头和页头中空闲页面相关的元数据
+ * @description: 扫描所有数据页面的页头，重新建立空闲空间映射，用于打开没有FSM文件的旧表
  */
-void RmFileHandle::release_page_handle(RmPageHandle& page_handle) {
-    // Todo:
-    // 当page从已满变成未满，考虑如何更新：
-    // 1. page_handle.page_hdr->next_free_page_no
-    // 2. file_hdr_.first_free_page_no
+void RmFileHandle::rebuild_fsm() {
+    BufferAccessStrategy strategy(BUFFER_SCAN_RING_SIZE);
+    for (page_id_t page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr_.num_pages; page_no++) {
+        auto pageHandle = fetch_page_handle(page_no, &strategy);
+        fsm_.set(page_no, page_category(pageHandle));
+        unpin_page_handle(pageHandle, false);
+    }
+}
+
+/**
+ * @description: 设置区域映射的列并从区域映射文件读入映射，读不到可用的映射时扫描数据页面重新建立，
+ * 之后把文件标记为未正常关闭，直到关闭表时写回
+ * @param {vector<RmZoneCol>&} cols 建立区域映射的列
+ * @param {int} zmap_fd 区域映射文件的文件句柄
+ */
+void RmFileHandle::init_zone_map(const std::vector<RmZoneCol>& cols, int zmap_fd) {
+    zmap_fd_ = zmap_fd;
+    zone_map_.init(cols);
+    if (!zone_map_.load(disk_manager_, zmap_fd_)) {
+        BufferAccessStrategy strategy(BUFFER_SCAN_RING_SIZE);
+        for (RmScan scan(this, &strategy, READ_AHEAD_PAGES, true); !scan.is_end(); scan.next()) {
+            zone_map_.widen(scan.rid().page_no, scan.tuple());
+        }
+    }
+    zone_map_.flush(disk_manager_, zmap_fd_, false);
+}
 
-    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
-}
\ No newline at end of file
+/**
+ * @description: 把一条记录追加到正在写入的页面，页面写满时更新空闲空间映射并换一个新页面
+ * @param {char*} buf 要插入的记录，长度为record_size
+ * @return {Rid} 插入的记录的记录号
+ */
+Rid RmBulkInserter::insert(const char* buf) {
+    const RmFileHdr& file_hdr = file_handle_->file_hdr_;
+    const char* data = buf;
+    int len = file_hdr.record_size;
+    char encoded[PAGE_SIZE];
+    if (file_handle_->is_slotted()) {
+        len = file_handle_->encode_record(buf, encoded);
+        data = encoded;
+    }
+    while (true) {
+        if (!page_handle_) {
+            page_handle_.emplace(file_handle_->create_new_page_handle(&strategy_));
+            page_handle_->page->WLatch();
+            next_slot_ = 0;
+        }
+        bool placed = next_slot_ < file_hdr.num_records_per_page;
+        if (placed && file_handle_->is_slotted()) {
+            placed = RmSlottedPage(*page_handle_).insert(next_slot_, data, len, 0);
+        } else if (placed && file_handle_->is_pax()) {
+            file_handle_->pax_page(*page_handle_).scatter(next_slot_, data);
+        } else if (placed) {
+            memcpy(page_handle_->get_slot(next_slot_), data, len);
+        }
+        if (placed) {
+            file_handle_->zone_map_.widen(page_handle_->page->get_page_id().page_no, buf);
+            Bitmap::set(page_handle_->bitmap, next_slot_);
+            page_handle_->page_hdr->num_records++;
+            return {page_handle_->page->get_page_id().page_no, next_slot_++};
+        }
+        if (next_slot_ == 0) {
+            throw InternalError("RmBulkInserter::insert: record does not fit in an empty page");
+        }
+        finish();
+    }
+}
+
+void RmBulkInserter::finish() {
+    if (!page_handle_) {
+        return;
+    }
+    file_handle_->fsm_.set(page_handle_->page->get_page_id().page_no, file_handle_->page_category(*page_handle_));
+    page_handle_->page->WUnlatch();
+    file_handle_->unpin_page_handle(*page_handle_, true);
+    page_handle_.reset();
+}
@@ -12,11 +12,20 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 #include "bitmap.h"
 #include "common/context.h"
 #include "rm_defs.h"
+#include "rm_free_space_map.h"
+#include "rm_pax_page.h"
+#include "rm_zone_map.h"
+#include "storage/read_ahead.h"
 
 class RmManager;
 
@@ -40,40 +49,129 @@ struct RmPageHandle {
     }
 };
 
+/**
+ * 只读的记录视图，定长格式的表直接指向缓冲池中页面的slot，视图存在期间页面保持pin住，析构时自动unpin；
+ * 变长格式的表需要解码，视图持有解码后的记录，不占用页面
+ */
+class RmRecordRef {
+   public:
+    RmRecordRef() = default;
+
+    RmRecordRef(BufferPoolManager *buffer_pool_manager, Page *page, const char *data, int size)
+        : buffer_pool_manager_(buffer_pool_manager), page_(page), data_(data), size_(size) {}
+
+    RmRecordRef(std::unique_ptr<char[]> buf, int size) : buf_(std::move(buf)), data_(buf_.get()), size_(size) {}
+
+    RmRecordRef(const RmRecordRef &) = delete;
+    RmRecordRef &operator=(const RmRecordRef &) = delete;
+
+    RmRecordRef(RmRecordRef &&other) noexcept { *this = std::move(other); }
+
+    RmRecordRef &operator=(RmRecordRef &&other) noexcept {
+        if (this != &other) {
+            release();
+            buffer_pool_manager_ = other.buffer_pool_manager_;
+            page_ = other.page_;
+            buf_ = std::move(other.buf_);
+            data_ = other.data_;
+            size_ = other.size_;
+            other.page_ = nullptr;
+            other.data_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~RmRecordRef() { release(); }
+
+    const char *data() const { return data_; }
+
+    int size() const { return size_; }
+
+    // 只有真正需要持有记录时才拷贝出一个RmRecord
+    std::unique_ptr<RmRecord> to_record() const { return std::make_unique<RmRecord>(size_, const_cast<char *>(data_)); }
+
+    // 提前unpin页面，之后视图不再可用
+    void release() {
+        if (page_ != nullptr) {
+            buffer_pool_manager_->unpin_page(page_->get_page_id(), false);
+            page_ = nullptr;
+        }
+        buf_.reset();
+        data_ = nullptr;
+    }
+
+   private:
+    BufferPoolManager *buffer_pool_manager_ = nullptr;
+    Page *page_ = nullptr;
+    std::unique_ptr<char[]> buf_;       // 解码后的记录，指向页面时为空
+    const char *data_ = nullptr;
+    int size_ = 0;
+};
+
 /* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
 class RmFileHandle {      
     friend class RmScan;    
     friend class RmManager;
+    friend class RmBulkInserter;
 
    private:
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    int fsm_fd_;            // 空闲空间映射文件的文件句柄，为-1时映射只保存在内存中
+    RmFreeSpaceMap fsm_;    // 空闲空间映射，插入时据此查找有空闲slot的页面
+    std::mutex alloc_latch_;    // 保护新页面的分配和file_hdr_.num_pages
+    std::atomic<page_id_t> insert_targets_[RM_INSERT_TARGETS];  // 每个槽最近插入的页面，线程按线程号散列到不同的槽
+    std::vector<RmField> fields_;           // 变长格式中的变长字段或PAX格式中的列，按偏移排序
+    int zmap_fd_ = -1;      // 区域映射文件的文件句柄，为-1时没有建立区域映射
+    RmZoneMap zone_map_;    // 区域映射，扫描时据此跳过不满足条件的页面
 
    public:
-    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
-        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, int fsm_fd = -1)
+        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd), fsm_fd_(fsm_fd) {
         // 注意：这里从磁盘中读出文件描述符为fd的文件的file_hdr，读到内存中
         // 这里实际就是初始化file_hdr，只不过是从磁盘中读出进行初始化
         // init file_hdr_
-        disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+        // 旧版本创建的空表只写了较短的文件头，缺少的字段按0处理
+        memset(&file_hdr_, 0, sizeof(file_hdr_));
+        int hdr_size = std::min<int>(sizeof(file_hdr_), disk_manager_->get_file_size(disk_manager_->get_file_name(fd)));
+        disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, hdr_size);
+        if (file_hdr_.num_fields > 0) {
+            char buf[PAGE_SIZE];
+            disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, buf,
+                                     sizeof(RmFileHdr) + file_hdr_.num_fields * sizeof(RmField));
+            auto fields = reinterpret_cast<const RmField *>(buf + sizeof(RmFileHdr));
+            fields_.assign(fields, fields + file_hdr_.num_fields);
+        }
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+        if (fsm_fd_ != -1) {
+            fsm_.load(disk_manager_, fsm_fd_);
+        }
+        for (auto &target : insert_targets_) {
+            target.store(RM_NO_PAGE, std::memory_order_relaxed);
+        }
     }
 
     RmFileHdr get_file_hdr() { return file_hdr_; }
     int GetFd() { return fd_; }
 
+    const RmZoneMap &zone_map() const { return zone_map_; }
+
     /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
     bool is_record(const Rid &rid) const {
         RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-        return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        bool exist = Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        unpin_page_handle(page_handle, false);
+        return exist;
     }
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
-    Rid insert_record(char *buf, Context *context);
+    RmRecordRef get_record_ref(const Rid &rid, Context *context, BufferAccessStrategy *strategy = nullptr) const;
+
+    Rid insert_record(char *buf, Context *context, BufferAccessStrategy *strategy = nullptr);
 
     void insert_record(const Rid &rid, char *buf, Context* context);
 
@@ -81,12 +179,106 @@ class RmFileHandle {
 
     void update_record(const Rid &rid, char *buf, Context *context);
 
-    RmPageHandle create_new_page_handle();
+    std::vector<std::unique_ptr<RmRecord>> get_records(const std::vector<Rid> &rids, Context *context,
+                                                       BufferAccessStrategy *strategy = nullptr) const;
+
+    std::vector<Rid> insert_records(const std::vector<const char *> &bufs, Context *context,
+                                    BufferAccessStrategy *strategy = nullptr);
+
+    void delete_records(const std::vector<Rid> &rids, Context *context, std::vector<size_t> *deleted = nullptr);
+
+    RmPageHandle create_new_page_handle(BufferAccessStrategy *strategy = nullptr);
+
+    RmPageHandle fetch_page_handle(int page_no, BufferAccessStrategy *strategy = nullptr) const;
+
+    /**
+     * @description: 使用完fetch_page_handle/create_new_page_handle得到的页面后，必须调用此函数unpin
+     * @param {RmPageHandle&} page_handle 页面句柄
+     * @param {bool} is_dirty 页面是否被修改
+     */
+    void unpin_page_handle(const RmPageHandle &page_handle, bool is_dirty) const {
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), is_dirty);
+    }
+
+    void rebuild_fsm();
 
-    RmPageHandle fetch_page_handle(int page_no) const;
+    void init_zone_map(const std::vector<RmZoneCol> &cols, int zmap_fd);
+
+    /**
+     * @description: 按页遍历PAX格式的表，调用者只读取需要的列的minipage，不必拼出完整的记录
+     * @param {BufferAccessStrategy*} strategy 缓冲区访问策略
+     * @param {F&&} f 对每个数据页面调用一次f(const RmPaxPage&)，调用期间页面被pin住并持有读锁
+     */
+    template <typename F>
+    void scan_pax_pages(BufferAccessStrategy *strategy, F &&f) const {
+        assert(is_pax());
+        ReadAhead read_ahead(buffer_pool_manager_, fd_, READ_AHEAD_PAGES);
+        for (page_id_t page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr_.num_pages; page_no++) {
+            read_ahead.access(page_no, file_hdr_.num_pages);
+            auto pageHandle = fetch_page_handle(page_no, strategy);
+            pageHandle.page->RLatch();
+            f(pax_page(pageHandle));
+            pageHandle.page->RUnlatch();
+            unpin_page_handle(pageHandle, false);
+        }
+    }
 
    private:
-    RmPageHandle create_page_handle();
+    bool is_slotted() const { return file_hdr_.format == RM_FORMAT_SLOTTED; }
+
+    bool is_pax() const { return file_hdr_.format == RM_FORMAT_PAX; }
+
+    RmPaxPage pax_page(const RmPageHandle &page_handle) const {
+        return {page_handle.bitmap, page_handle.slots, file_hdr_.num_records_per_page, fields_};
+    }
+
+    int page_category(const RmPageHandle &page_handle) const;
+
+    int required_category(int len) const;
+
+    void update_fsm(page_id_t page_no, int old_category, int new_category) {
+        if (old_category != new_category) {
+            fsm_.set(page_no, new_category);
+        }
+    }
+
+    Rid place_record(const char *data, int len, uint16_t flags, Context *context, BufferAccessStrategy *strategy);
+
+    int place_on_page(const RmPageHandle &page_handle, const char *data, int len, uint16_t flags, Context *context);
+
+    static std::vector<size_t> group_by_page(const std::vector<Rid> &rids);
+
+    void erase_moved_record(const Rid &rid);
 
-    void release_page_handle(RmPageHandle &page_handle);
-};
\ No newline at end of file
+    void read_record(const Rid &rid, char *buf, BufferAccessStrategy *strategy) const;
+
+    int encode_record(const char *record, char *buf) const;
+
+    void decode_record(const char *data, int len, char *record) const;
+};
+
+/**
+ * 批量导入时把记录依次写入新分配的页面，一个页面写满后才分配下一个：不查找空闲空间映射，
+ * 也不逐条申请行锁，调用者需持有表级写锁。正在写的页面一直pin住并持有写锁，新页面经由私有的帧环写出
+ */
+class RmBulkInserter {
+   public:
+    explicit RmBulkInserter(RmFileHandle *file_handle)
+        : file_handle_(file_handle), strategy_(BUFFER_BULK_RING_SIZE) {}
+
+    RmBulkInserter(const RmBulkInserter &) = delete;
+    RmBulkInserter &operator=(const RmBulkInserter &) = delete;
+
+    ~RmBulkInserter() { finish(); }
+
+    Rid insert(const char *buf);
+
+    // 结束当前页面，之后的insert会分配新页面
+    void finish();
+
+   private:
+    RmFileHandle *file_handle_;
+    BufferAccessStrategy strategy_;
+    std::optional<RmPageHandle> page_handle_;   // 正在写入的页面
+    int next_slot_ = 0;                         // 当前页面中下一条记录的slot
+};
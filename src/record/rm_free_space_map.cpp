@@ -0,0 +1,127 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "rm_free_space_map.h"
+
+/**
+ * @description: 获取页面的空闲等级，映射中没有记录的页面视为已满
+ * @param {page_id_t} page_no 数据页面号
+ * @return {int} 空闲等级
+ */
+int RmFreeSpaceMap::get(page_id_t page_no) const {
+    std::shared_lock lock{latch_};
+    size_t chunk = page_no / RM_FSM_ENTRIES_PER_PAGE;
+    if (chunk >= chunks_.size()) {
+        return 0;
+    }
+    return chunks_[chunk][page_no % RM_FSM_ENTRIES_PER_PAGE].load(std::memory_order_relaxed);
+}
+
+/**
+ * @description: 更新页面的空闲等级，多个线程可以并发地更新不同页面
+ * @param {page_id_t} page_no 数据页面号
+ * @param {int} category 新的空闲等级，取值[0, RM_FSM_MAX_CATEGORY]
+ */
+void RmFreeSpaceMap::set(page_id_t page_no, int category) {
+    size_t chunk = page_no / RM_FSM_ENTRIES_PER_PAGE;
+    {
+        std::shared_lock lock{latch_};
+        if (chunk < chunks_.size()) {
+            int old = chunks_[chunk][page_no % RM_FSM_ENTRIES_PER_PAGE].exchange(category, std::memory_order_relaxed);
+            if ((old == 0) != (category == 0)) {
+                free_pages_[chunk]->fetch_add(category == 0 ? -1 : 1, std::memory_order_relaxed);
+            }
+            return;
+        }
+    }
+    grow(chunk + 1);
+    set(page_no, category);
+}
+
+/**
+ * @description: 从start开始循环查找空闲等级不低于min_category的数据页面，跳过没有空闲页面的FSM页面
+ * @param {int} min_category 要求的最低空闲等级，至少为1
+ * @param {page_id_t} start 查找的起始页面号，不同线程从不同的位置开始，避免落到同一个页面上
+ * @param {page_id_t} num_pages 数据文件中的页面个数
+ * @return {page_id_t} 找到的页面号，没有满足要求的页面时返回RM_NO_PAGE
+ */
+page_id_t RmFreeSpaceMap::search(int min_category, page_id_t start, page_id_t num_pages) const {
+    std::shared_lock lock{latch_};
+    page_id_t end = std::min<page_id_t>(num_pages, chunks_.size() * RM_FSM_ENTRIES_PER_PAGE);
+    if (start < RM_FIRST_RECORD_PAGE || start >= end) {
+        start = RM_FIRST_RECORD_PAGE;
+    }
+    auto search_range = [&](page_id_t lo, page_id_t hi) -> page_id_t {
+        for (page_id_t page_no = lo; page_no < hi;) {
+            size_t chunk = page_no / RM_FSM_ENTRIES_PER_PAGE;
+            if (free_pages_[chunk]->load(std::memory_order_relaxed) == 0) {
+                page_no = (chunk + 1) * RM_FSM_ENTRIES_PER_PAGE;
+                continue;
+            }
+            if (chunks_[chunk][page_no % RM_FSM_ENTRIES_PER_PAGE].load(std::memory_order_relaxed) >= min_category) {
+                return page_no;
+            }
+            page_no++;
+        }
+        return RM_NO_PAGE;
+    };
+    page_id_t page_no = search_range(start, end);
+    return page_no != RM_NO_PAGE ? page_no : search_range(RM_FIRST_RECORD_PAGE, start);
+}
+
+/**
+ * @description: 从FSM文件中读入空闲空间映射
+ * @param {DiskManager*} disk_manager
+ * @param {int} fd FSM文件的文件句柄
+ */
+void RmFreeSpaceMap::load(DiskManager *disk_manager, int fd) {
+    int num_fsm_pages = disk_manager->get_file_size(disk_manager->get_file_name(fd)) / PAGE_SIZE;
+    grow(num_fsm_pages);
+    char buf[PAGE_SIZE];
+    for (int fsm_page_no = 0; fsm_page_no < num_fsm_pages; fsm_page_no++) {
+        disk_manager->read_page(fd, fsm_page_no, buf, PAGE_SIZE);
+        // 每个字节存放两个页面的等级，靠前的页面在高4位
+        for (int i = 0; i < RM_FSM_ENTRIES_PER_PAGE; i++) {
+            int category = (static_cast<unsigned char>(buf[i / 2]) >> (i % 2 == 0 ? RM_FSM_BITS : 0)) & RM_FSM_MAX_CATEGORY;
+            if (category != 0) {
+                set(fsm_page_no * RM_FSM_ENTRIES_PER_PAGE + i, category);
+            }
+        }
+    }
+}
+
+/**
+ * @description: 把空闲空间映射写回FSM文件
+ * @param {DiskManager*} disk_manager
+ * @param {int} fd FSM文件的文件句柄
+ */
+void RmFreeSpaceMap::flush(DiskManager *disk_manager, int fd) const {
+    std::shared_lock lock{latch_};
+    char buf[PAGE_SIZE];
+    for (size_t fsm_page_no = 0; fsm_page_no < chunks_.size(); fsm_page_no++) {
+        memset(buf, 0, PAGE_SIZE);
+        for (int i = 0; i < RM_FSM_ENTRIES_PER_PAGE; i++) {
+            int category = chunks_[fsm_page_no][i].load(std::memory_order_relaxed);
+            buf[i / 2] |= static_cast<char>(category << (i % 2 == 0 ? RM_FSM_BITS : 0));
+        }
+        disk_manager->write_page(fd, fsm_page_no, buf, PAGE_SIZE);
+    }
+}
+
+/**
+ * @description: 扩充映射，使其至少包含num_chunks个FSM页面
+ */
+void RmFreeSpaceMap::grow(size_t num_chunks) {
+    std::unique_lock lock{latch_};
+    while (chunks_.size() < num_chunks) {
+        chunks_.push_back(std::make_unique<std::atomic<uint8_t>[]>(RM_FSM_ENTRIES_PER_PAGE));
+        free_pages_.push_back(std::make_unique<std::atomic<int>>(0));
+    }
+}
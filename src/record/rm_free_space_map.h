@@ -0,0 +1,63 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "rm_defs.h"
+
+/**
+ * @description: 表数据文件的空闲空间映射(FSM)。每个数据页面用RM_FSM_BITS位记录空闲等级，0表示已满，
+ * 等级越高空闲空间越多。映射常驻内存，打开表时从与数据文件同名、后缀为RM_FSM_SUFFIX的文件中读入，
+ * 关闭表时写回，磁盘上每个FSM页面按页面号顺序紧凑地存放RM_FSM_ENTRIES_PER_PAGE个数据页面的等级。
+ * 映射中的等级只是提示，插入时以页面中的bitmap为准，发现不一致时更正映射
+ */
+class RmFreeSpaceMap {
+   public:
+    RmFreeSpaceMap() = default;
+
+    ~RmFreeSpaceMap() = default;
+
+    RmFreeSpaceMap(const RmFreeSpaceMap &) = delete;
+    RmFreeSpaceMap &operator=(const RmFreeSpaceMap &) = delete;
+
+    /**
+     * @description: 根据页面中空闲slot的个数计算空闲等级，只要还有空闲slot等级就不为0
+     * @param {int} free_slots 页面中空闲slot的个数
+     * @param {int} max_slots 页面中slot的总个数
+     */
+    static int category(int free_slots, int max_slots) {
+        return (free_slots * RM_FSM_MAX_CATEGORY + max_slots - 1) / max_slots;
+    }
+
+    int get(page_id_t page_no) const;
+
+    void set(page_id_t page_no, int category);
+
+    page_id_t search(int min_category, page_id_t start, page_id_t num_pages) const;
+
+    void load(DiskManager *disk_manager, int fd);
+
+    void flush(DiskManager *disk_manager, int fd) const;
+
+   private:
+    using Chunk = std::unique_ptr<std::atomic<uint8_t>[]>;
+
+    /* 每个Chunk对应磁盘上的一个FSM页面，free_pages_记录Chunk中等级不为0的页面个数，查找时据此跳过已满的Chunk */
+    mutable std::shared_mutex latch_;           // 保护chunks_的扩容，读写单个等级只需要读锁
+    std::vector<Chunk> chunks_;
+    std::vector<std::unique_ptr<std::atomic<int>>> free_pages_;
+
+    void grow(size_t num_chunks);
+};
@@ -12,9 +12,13 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <cstddef>
+#include <vector>
+
 #include "bitmap.h"
 #include "rm_defs.h"
 #include "rm_file_handle.h"
+#include "rm_slotted_page.h"
 
 /* 记录管理器，用于管理表的数据文件，进行文件的创建、打开、删除、关闭 */
 class RmManager {
@@ -30,45 +34,143 @@ class RmManager {
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
      * @param {int} record_size 表中记录的大小
+     * @param {RmPageFormat} format 页面格式
+     * @param {vector<RmField>&} fields 变长格式中按实际长度存放的字段，或PAX格式中的所有列，按偏移排序
+     * @param {bool} compressed 是否压缩存放数据页面，适合很少更新、经常扫描的表
      */ 
-    void create_file(const std::string& filename, int record_size) {
-        if (record_size < 1 || record_size > RM_MAX_RECORD_SIZE) {
+    void create_file(const std::string& filename, int record_size, RmPageFormat format = RM_FORMAT_FIXED,
+                     const std::vector<RmField>& fields = {}, bool compressed = false) {
+        if (record_size < 1 || (format != RM_FORMAT_SLOTTED && record_size > RM_MAX_RECORD_SIZE)) {
+            throw InvalidRecordSizeError(record_size);
+        }
+        if (fields.size() > RM_MAX_FIELDS) {
             throw InvalidRecordSizeError(record_size);
         }
-        disk_manager_->create_file(filename);
-        int fd = disk_manager_->open_file(filename);
 
         // 初始化file header
         RmFileHdr file_hdr{};
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
-        file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
-        file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        file_hdr.format = format;
+        std::vector<RmField> hdr_fields;
+        if (format == RM_FORMAT_FIXED) {
+            // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
+            // hdr按加入format之前的文件头大小计算，定长格式每页的记录数与旧版本相同
+            int hdr_size = static_cast<int>(offsetof(RmFileHdr, format));
+            file_hdr.num_records_per_page =
+                (BITMAP_WIDTH * (PAGE_SIZE - 1 - hdr_size) + 1) / (1 + record_size * BITMAP_WIDTH);
+            file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        } else if (format == RM_FORMAT_PAX) {
+            // 列必须首尾相接地覆盖整条记录，没有给出列时整条记录作为一列
+            hdr_fields = fields.empty() ? std::vector<RmField>{{0, record_size}} : fields;
+            int end = 0;
+            for (auto& field : hdr_fields) {
+                if (field.offset != end || field.len < 1) {
+                    throw InvalidRecordSizeError(record_size);
+                }
+                end += field.len;
+            }
+            if (end != record_size) {
+                throw InvalidRecordSizeError(record_size);
+            }
+            // 与定长格式的slot数相同，只是slot区按列重新排列
+            int avail = PAGE_SIZE - Page::OFFSET_PAGE_HDR - sizeof(RmPageHdr);
+            file_hdr.num_records_per_page = (BITMAP_WIDTH * (avail - 1) + 1) / (1 + record_size * BITMAP_WIDTH);
+            file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        } else {
+            hdr_fields = fields;
+            // 编码后最短和最长的记录，slot数按最短的记录计算，最长的记录至少要能单独放进一个页面
+            int min_len = record_size + (int)(fields.size() * sizeof(uint16_t));
+            int max_len = min_len;
+            for (auto& field : fields) {
+                min_len -= field.len;
+            }
+            min_len = std::max(min_len, (int)sizeof(Rid));
+            max_len = std::max(max_len, (int)sizeof(Rid));
+            int avail = PAGE_SIZE - Page::OFFSET_PAGE_HDR - sizeof(RmPageHdr) - sizeof(RmSlottedPageHdr);
+            file_hdr.num_records_per_page =
+                (BITMAP_WIDTH * (avail - 1) + 1) / (1 + (min_len + (int)sizeof(RmSlot)) * BITMAP_WIDTH);
+            file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+            if (max_len + (int)sizeof(RmSlot) > RmSlottedPage::capacity(file_hdr)) {
+                throw InvalidRecordSizeError(record_size);
+            }
+        }
+        file_hdr.num_fields = hdr_fields.size();
 
-        // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
+        disk_manager_->create_file(filename);
+        int fd = disk_manager_->open_file(filename);
+        // 将file header和字段定义写入磁盘文件（名为file name，文件描述符为fd）中的第0页
         // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
-        disk_manager_->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
+        char hdr_page[PAGE_SIZE] = {};
+        memcpy(hdr_page, &file_hdr, sizeof(file_hdr));
+        memcpy(hdr_page + sizeof(file_hdr), hdr_fields.data(), hdr_fields.size() * sizeof(RmField));
+        disk_manager_->write_page(fd, RM_FILE_HDR_PAGE, hdr_page,
+                                  sizeof(file_hdr) + hdr_fields.size() * sizeof(RmField));
         disk_manager_->close_file(fd);
+        // 空闲空间映射文件，新表没有数据页面，文件为空；残留的同名映射文件属于已经删除的数据文件
+        if (disk_manager_->is_file(filename + RM_FSM_SUFFIX)) {
+            disk_manager_->destroy_file(filename + RM_FSM_SUFFIX);
+        }
+        disk_manager_->create_file(filename + RM_FSM_SUFFIX);
+        // 页面映射文件存在时表是压缩存放的
+        if (disk_manager_->is_file(filename + COMPRESSED_PAGE_MAP_SUFFIX)) {
+            disk_manager_->destroy_file(filename + COMPRESSED_PAGE_MAP_SUFFIX);
+        }
+        if (compressed) {
+            disk_manager_->create_file(filename + COMPRESSED_PAGE_MAP_SUFFIX);
+        }
+        if (disk_manager_->is_file(filename + RM_ZONE_MAP_SUFFIX)) {
+            disk_manager_->destroy_file(filename + RM_ZONE_MAP_SUFFIX);
+        }
     }
 
     /**
      * @description: 删除表的数据文件
      * @param {string&} filename 要删除的文件名称
      */    
-    void destroy_file(const std::string& filename) { disk_manager_->destroy_file(filename); }
+    void destroy_file(const std::string& filename) {
+        disk_manager_->destroy_file(filename);
+        if (disk_manager_->is_file(filename + RM_FSM_SUFFIX)) {
+            disk_manager_->destroy_file(filename + RM_FSM_SUFFIX);
+        }
+        if (disk_manager_->is_file(filename + COMPRESSED_PAGE_MAP_SUFFIX)) {
+            disk_manager_->destroy_file(filename + COMPRESSED_PAGE_MAP_SUFFIX);
+        }
+        if (disk_manager_->is_file(filename + RM_ZONE_MAP_SUFFIX)) {
+            disk_manager_->destroy_file(filename + RM_ZONE_MAP_SUFFIX);
+        }
+    }
 
     // 注意这里打开文件，创建并返回了record file handle的指针
     /**
      * @description: 打开表的数据文件，并返回文件句柄
      * @param {string&} filename 要打开的文件名称
+     * @param {vector<RmZoneCol>&} zone_cols 建立区域映射的列，为空时不建立区域映射
      * @return {unique_ptr<RmFileHandle>} 文件句柄的指针
      */
-    std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
+    std::unique_ptr<RmFileHandle> open_file(const std::string& filename, const std::vector<RmZoneCol>& zone_cols = {}) {
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        if (disk_manager_->is_file(filename + COMPRESSED_PAGE_MAP_SUFFIX)) {
+            disk_manager_->set_compressed(fd, filename + COMPRESSED_PAGE_MAP_SUFFIX);
+        }
+        // 没有空闲空间映射文件的旧表，扫描数据页面重新建立映射
+        bool rebuild_fsm = !disk_manager_->is_file(filename + RM_FSM_SUFFIX);
+        if (rebuild_fsm) {
+            disk_manager_->create_file(filename + RM_FSM_SUFFIX);
+        }
+        int fsm_fd = disk_manager_->open_file(filename + RM_FSM_SUFFIX);
+        auto file_handle = std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd, fsm_fd);
+        if (rebuild_fsm) {
+            file_handle->rebuild_fsm();
+        }
+        if (!zone_cols.empty()) {
+            if (!disk_manager_->is_file(filename + RM_ZONE_MAP_SUFFIX)) {
+                disk_manager_->create_file(filename + RM_ZONE_MAP_SUFFIX);
+            }
+            file_handle->init_zone_map(zone_cols, disk_manager_->open_file(filename + RM_ZONE_MAP_SUFFIX));
+        }
+        return file_handle;
     }
     /**
      * @description: 关闭表的数据文件
@@ -79,6 +181,16 @@ class RmManager {
                                   sizeof(file_handle->file_hdr_));
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(file_handle->fd_);
+        // fd关闭后会被其他文件复用，不能在缓冲池中留下以它为键的页面
+        buffer_pool_manager_->delete_all_pages(file_handle->fd_);
         disk_manager_->close_file(file_handle->fd_);
+        if (file_handle->fsm_fd_ != -1) {
+            file_handle->fsm_.flush(disk_manager_, file_handle->fsm_fd_);
+            disk_manager_->close_file(file_handle->fsm_fd_);
+        }
+        if (file_handle->zmap_fd_ != -1) {
+            file_handle->zone_map_.flush(disk_manager_, file_handle->zmap_fd_, true);
+            disk_manager_->close_file(file_handle->zmap_fd_);
+        }
     }
 };
@@ -0,0 +1,33 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "rm_pax_page.h"
+
+/**
+ * @description: 从各列的minipage中取出第slot_no条记录，拼成完整的记录
+ * @param {int} slot_no slot号
+ * @param {char*} record 存放记录，长度为record_size
+ */
+void RmPaxPage::gather(int slot_no, char *record) const {
+    for (auto &field : fields_) {
+        memcpy(record + field.offset, column(field.offset) + slot_no * field.len, field.len);
+    }
+}
+
+/**
+ * @description: 把记录的各列分别写入对应minipage的第slot_no个位置
+ * @param {int} slot_no slot号
+ * @param {char*} record 长度为record_size的记录
+ */
+void RmPaxPage::scatter(int slot_no, const char *record) {
+    for (auto &field : fields_) {
+        memcpy(slots_ + field.offset * max_slots_ + slot_no * field.len, record + field.offset, field.len);
+    }
+}
@@ -0,0 +1,44 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <vector>
+
+#include "bitmap.h"
+#include "rm_defs.h"
+
+/**
+ * @description: 对PAX格式页面的封装。页面的bitmap与定长格式相同，slot区按列划分为minipage，
+ * 偏移为offset、长度为len的列的minipage从slot区的offset * max_slots处开始，第slot_no个值位于
+ * minipage + slot_no * len。只访问少数几列的扫描只需要读这几列的minipage
+ */
+class RmPaxPage {
+   public:
+    RmPaxPage(const char *bitmap, char *slots, int max_slots, const std::vector<RmField> &fields)
+        : bitmap_(bitmap), slots_(slots), max_slots_(max_slots), fields_(fields) {}
+
+    const char *bitmap() const { return bitmap_; }
+
+    int max_slots() const { return max_slots_; }
+
+    // 记录中偏移为offset的列的minipage
+    const char *column(int offset) const { return slots_ + offset * max_slots_; }
+
+    void gather(int slot_no, char *record) const;
+
+    void scatter(int slot_no, const char *record);
+
+   private:
+    const char *bitmap_;
+    char *slots_;
+    int max_slots_;
+    const std::vector<RmField> &fields_;
+};
@@ -10,32 +10,84 @@ See the Mulan PSL v2 for more details. */
 
 #include "rm_scan.h"
 #include "rm_file_handle.h"
+#include "rm_slotted_page.h"
 
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
+ * @param strategy 缓冲区访问策略，全表扫描时传入以免冲刷缓冲池
+ * @param read_ahead_pages 预读窗口的页面数，为0时不预读
+ * @param page_at_a_time 是否按页扫描，每个页面只fetch一次
+ * @param ranges 扫描条件在区域映射的列上限定的范围，不满足的记录仍可能被返回，调用者需要自己判断条件
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+RmScan::RmScan(const RmFileHandle *file_handle, BufferAccessStrategy *strategy, int read_ahead_pages,
+               bool page_at_a_time, std::vector<RmZoneRange> ranges)
+    : file_handle_(file_handle),
+      strategy_(strategy),
+      read_ahead_(file_handle->buffer_pool_manager_, file_handle->fd_, read_ahead_pages),
+      page_at_a_time_(page_at_a_time),
+      ranges_(std::move(ranges)) {
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
     rid_.page_no = RM_FIRST_RECORD_PAGE;
     // 设置 -1 Bit::next_bit 即是 0
     // 直接设置为 0，会少判断 0
     rid_.slot_no = -1;
-    next();
+    if (page_at_a_time_) {
+        load_page(RM_FIRST_RECORD_PAGE);
+    } else {
+        next_slot();
+    }
 }
 
 /**
  * @brief 找到文件中下一个存放了记录的位置
  */
 void RmScan::next() {
+    if (!page_at_a_time_) {
+        next_slot();
+        return;
+    }
+    if (rid_.page_no == RM_NO_PAGE) {
+        return;
+    }
+    if (++pos_ < batch_.size()) {
+        rid_ = batch_.rids[pos_];
+        return;
+    }
+    load_page(rid_.page_no + 1);
+}
+
+/**
+ * @brief 按页扫描时放弃当前页面剩余的记录，移动到下一个有记录的页面
+ */
+void RmScan::next_page() {
+    assert(page_at_a_time_);
+    if (rid_.page_no != RM_NO_PAGE) {
+        load_page(rid_.page_no + 1);
+    }
+}
+
+/**
+ * @brief 逐条扫描：每次都fetch页面，在bitmap中找到下一个存放了记录的slot
+ */
+void RmScan::next_slot() {
     // Todo:
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
 
     while (rid_.page_no < file_handle_->file_hdr_.num_pages) {
-        auto pageHander = file_handle_->fetch_page_handle(rid_.page_no);
+        if (rid_.slot_no == -1 && skip_page(rid_.page_no)) {
+            rid_.page_no++;
+            continue;
+        }
+        // 进入新页面时检测顺序访问
+        if (rid_.slot_no == -1) {
+            read_ahead_.access(rid_.page_no, file_handle_->file_hdr_.num_pages);
+        }
+        auto pageHander = file_handle_->fetch_page_handle(rid_.page_no, strategy_);
         // 这里是 record 的数量不是 bitSize
         rid_.slot_no = Bitmap::next_bit(true, pageHander.bitmap, file_handle_->file_hdr_.num_records_per_page, rid_.slot_no);
+        file_handle_->unpin_page_handle(pageHander, false);
         if (rid_.slot_no < file_handle_->file_hdr_.num_records_per_page) {
             return;
         }
@@ -45,6 +97,90 @@ void RmScan::next() {
     rid_.page_no = RM_NO_PAGE;
 }
 
+/**
+ * @brief 按页扫描：从page_no开始找到第一个有记录的页面，把页面上的所有记录取成批次
+ * 定长格式的页面保持pin住和读锁，批次直接指向slot；其他格式解码到buf_后立即释放页面
+ */
+void RmScan::load_page(int page_no) {
+    release_page();
+    batch_.rids.clear();
+    batch_.tuples.clear();
+    pos_ = 0;
+    const RmFileHdr &file_hdr = file_handle_->file_hdr_;
+    for (; page_no < file_hdr.num_pages; page_no++) {
+        if (skip_page(page_no)) {
+            continue;
+        }
+        read_ahead_.access(page_no, file_hdr.num_pages);
+        auto pageHandle = file_handle_->fetch_page_handle(page_no, strategy_);
+        pageHandle.page->RLatch();
+        for (int slot_no = Bitmap::first_bit(true, pageHandle.bitmap, file_hdr.num_records_per_page);
+             slot_no < file_hdr.num_records_per_page;
+             slot_no = Bitmap::next_bit(true, pageHandle.bitmap, file_hdr.num_records_per_page, slot_no)) {
+            batch_.rids.push_back(Rid{page_no, slot_no});
+        }
+        if (batch_.rids.empty()) {
+            pageHandle.page->RUnlatch();
+            file_handle_->unpin_page_handle(pageHandle, false);
+            continue;
+        }
+        if (!file_handle_->is_slotted() && !file_handle_->is_pax()) {
+            // 定长格式不拷贝，离开页面时再释放
+            page_ = pageHandle.page;
+            for (auto &rid : batch_.rids) {
+                batch_.tuples.push_back(pageHandle.get_slot(rid.slot_no));
+            }
+        } else {
+            if (!buf_) {
+                buf_ = std::make_unique<char[]>(static_cast<size_t>(file_hdr.num_records_per_page) * file_hdr.record_size);
+            }
+            std::vector<size_t> forwarded;
+            for (size_t i = 0; i < batch_.rids.size(); i++) {
+                char *tuple = buf_.get() + i * file_hdr.record_size;
+                int slot_no = batch_.rids[i].slot_no;
+                batch_.tuples.push_back(tuple);
+                if (file_handle_->is_pax()) {
+                    file_handle_->pax_page(pageHandle).gather(slot_no, tuple);
+                    continue;
+                }
+                RmSlottedPage page(pageHandle);
+                if (page.flags(slot_no) & RM_SLOT_FORWARD) {
+                    // 已迁移的记录在另一个页面上，释放本页后再读，避免同时持有两个页面的读锁
+                    forwarded.push_back(i);
+                } else {
+                    file_handle_->decode_record(page.get(slot_no), page.size(slot_no), tuple);
+                }
+            }
+            pageHandle.page->RUnlatch();
+            file_handle_->unpin_page_handle(pageHandle, false);
+            for (size_t i : forwarded) {
+                file_handle_->read_record(batch_.rids[i], const_cast<char *>(batch_.tuples[i]), strategy_);
+            }
+        }
+        rid_ = batch_.rids[0];
+        return;
+    }
+    rid_.page_no = RM_NO_PAGE;
+}
+
+/**
+ * @brief 根据区域映射判断页面上是否一定没有满足扫描条件的记录，跳过的页面不fetch
+ */
+bool RmScan::skip_page(int page_no) const {
+    return !ranges_.empty() && !file_handle_->zone_map_.may_match(page_no, ranges_);
+}
+
+/**
+ * @brief 按页扫描时释放当前持有的页面
+ */
+void RmScan::release_page() {
+    if (page_ != nullptr) {
+        page_->RUnlatch();
+        file_handle_->buffer_pool_manager_->unpin_page(page_->get_page_id(), false);
+        page_ = nullptr;
+    }
+}
+
 /**
  * @brief ​ 判断是否到达文件末尾
  */
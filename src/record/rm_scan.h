@@ -10,19 +10,72 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "rm_defs.h"
+#include "rm_zone_map.h"
+#include "storage/read_ahead.h"
 
 class RmFileHandle;
 
+/* 按页扫描时当前页面上所有记录组成的批次，rids与tuples一一对应，按slot_no递增 */
+struct RmScanBatch {
+    std::vector<Rid> rids;
+    std::vector<const char *> tuples;   // 每条记录的数据，长度均为record_size
+
+    size_t size() const { return rids.size(); }
+};
+
+/**
+ * 表迭代器。逐条模式每次next都重新fetch所在页面；按页模式进入一个页面时只fetch一次，
+ * 把页面上的记录一次取成批次，之后的next只在批次内移动，直到批次用完才离开页面。
+ * 按页模式下定长格式的表在离开页面前一直pin住页面并持有读锁，批次中的记录直接指向缓冲池的slot；
+ * 变长格式和PAX格式的表先把记录解码到扫描私有的连续缓冲区中，随即释放页面
+ */
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    BufferAccessStrategy *strategy_;    // 缓冲区访问策略，为空时使用共享的缓冲池
+    ReadAhead read_ahead_;              // 顺序预读
+    bool page_at_a_time_;               // 是否按页扫描
+    Page *page_ = nullptr;              // 按页扫描时当前pin住并持有读锁的页面
+    RmScanBatch batch_;                 // 按页扫描时当前页面上的记录
+    std::unique_ptr<char[]> buf_;       // 解码后的记录，定长格式不使用
+    size_t pos_ = 0;                    // rid_在batch_中的位置
+    std::vector<RmZoneRange> ranges_;   // 扫描条件限定的范围，区域映射表明页面上没有满足条件的记录时跳过页面
+
 public:
-    RmScan(const RmFileHandle *file_handle);
+    RmScan(const RmFileHandle *file_handle, BufferAccessStrategy *strategy = nullptr,
+           int read_ahead_pages = READ_AHEAD_PAGES, bool page_at_a_time = false,
+           std::vector<RmZoneRange> ranges = {});
+
+    RmScan(const RmScan &) = delete;
+    RmScan &operator=(const RmScan &) = delete;
+
+    ~RmScan() override { release_page(); }
 
     void next() override;
 
     bool is_end() const override;
 
     Rid rid() const override;
+
+    // 按页扫描时rid_对应的记录数据，离开当前页面后失效
+    const char *tuple() const { return batch_.tuples[pos_]; }
+
+    // 按页扫描时当前页面上的全部记录，离开当前页面后失效
+    const RmScanBatch &batch() const { return batch_; }
+
+    // 按页扫描时跳过当前页面剩余的记录，移动到下一个有记录的页面
+    void next_page();
+
+private:
+    void next_slot();
+
+    void load_page(int page_no);
+
+    bool skip_page(int page_no) const;
+
+    void release_page();
 };
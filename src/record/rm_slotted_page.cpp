@@ -0,0 +1,143 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "rm_slotted_page.h"
+
+#include <algorithm>
+#include <vector>
+
+RmSlottedPage::RmSlottedPage(const RmPageHandle &page_handle)
+    : data_(page_handle.page->get_data()),
+      bitmap_(page_handle.bitmap),
+      max_slots_(page_handle.file_hdr->num_records_per_page),
+      hdr_(reinterpret_cast<RmSlottedPageHdr *>(page_handle.slots)),
+      dir_(reinterpret_cast<RmSlot *>(page_handle.slots + sizeof(RmSlottedPageHdr))) {}
+
+/**
+ * @description: 初始化一个新的变长格式页面
+ */
+void RmSlottedPage::init(const RmPageHandle &page_handle) {
+    auto hdr = reinterpret_cast<RmSlottedPageHdr *>(page_handle.slots);
+    hdr->num_slots = 0;
+    hdr->free_end = PAGE_SIZE;
+    hdr->free_bytes = capacity(*page_handle.file_hdr);
+    hdr->reserved = 0;
+}
+
+/**
+ * @description: 找一个bitmap中没有置位，并且没有存放迁移记录的slot
+ * @return {int} slot号，没有空闲的slot时返回-1
+ */
+int RmSlottedPage::find_free_slot() const {
+    for (int slot_no = Bitmap::first_bit(false, bitmap_, max_slots_); slot_no < max_slots_;
+         slot_no = Bitmap::next_bit(false, bitmap_, max_slots_, slot_no)) {
+        if (!is_used(slot_no)) {
+            return slot_no;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @description: 判断空的slot中能否放入长度为len的记录，包括扩充目录需要的空间
+ */
+bool RmSlottedPage::fits(int slot_no, int len) const {
+    int dir_growth = std::max(slot_no + 1 - hdr_->num_slots, 0) * static_cast<int>(sizeof(RmSlot));
+    return hdr_->free_bytes >= dir_growth + len;
+}
+
+/**
+ * @description: 在空的slot中放入一条记录，slot超出目录时扩充目录
+ * @return {bool} 页面空间不足时返回false，页面不变
+ */
+bool RmSlottedPage::insert(int slot_no, const char *data, int len, uint16_t flags) {
+    if (!fits(slot_no, len)) {
+        return false;
+    }
+    int dir_growth = std::max(slot_no + 1 - hdr_->num_slots, 0) * static_cast<int>(sizeof(RmSlot));
+    if (contiguous_space() < dir_growth + len) {
+        compact();
+    }
+    for (int i = hdr_->num_slots; i <= slot_no; i++) {
+        dir_[i] = {0, 0};
+    }
+    hdr_->num_slots = std::max<int>(hdr_->num_slots, slot_no + 1);
+    hdr_->free_bytes -= dir_growth;
+    place(slot_no, data, len, flags);
+    return true;
+}
+
+/**
+ * @description: 修改slot中的记录，变短时原地修改，变长时在页内重新分配空间
+ * @return {bool} 页面空间不足时返回false，页面不变
+ */
+bool RmSlottedPage::update(int slot_no, const char *data, int len, uint16_t flags) {
+    int old_len = size(slot_no);
+    if (len <= old_len) {
+        memcpy(data_ + dir_[slot_no].offset, data, len);
+        dir_[slot_no].size = static_cast<uint16_t>(len) | flags;
+        hdr_->free_bytes += old_len - len;
+        return true;
+    }
+    if (hdr_->free_bytes + old_len < len) {
+        return false;
+    }
+    // 释放旧记录后再分配，整理页面时不需要搬动旧记录
+    hdr_->free_bytes += old_len;
+    dir_[slot_no] = {0, 0};
+    if (contiguous_space() < len) {
+        compact();
+    }
+    place(slot_no, data, len, flags);
+    return true;
+}
+
+/**
+ * @description: 删除slot中的记录，并回收目录末尾的空项
+ */
+void RmSlottedPage::erase(int slot_no) {
+    hdr_->free_bytes += size(slot_no);
+    dir_[slot_no] = {0, 0};
+    while (hdr_->num_slots > 0 && dir_[hdr_->num_slots - 1].offset == 0) {
+        hdr_->num_slots--;
+        hdr_->free_bytes += sizeof(RmSlot);
+    }
+}
+
+/**
+ * @description: 从记录区开头分配len个字节存放记录，调用者需保证连续空间足够
+ */
+void RmSlottedPage::place(int slot_no, const char *data, int len, uint16_t flags) {
+    hdr_->free_end -= len;
+    memcpy(data_ + hdr_->free_end, data, len);
+    dir_[slot_no] = {hdr_->free_end, static_cast<uint16_t>(static_cast<uint16_t>(len) | flags)};
+    hdr_->free_bytes -= len;
+}
+
+/**
+ * @description: 把所有记录紧凑地移到页尾，使空闲空间连续
+ */
+void RmSlottedPage::compact() {
+    std::vector<int> slots;
+    for (int slot_no = 0; slot_no < hdr_->num_slots; slot_no++) {
+        if (dir_[slot_no].offset != 0) {
+            slots.push_back(slot_no);
+        }
+    }
+    // 按偏移从大到小移动，记录只会向页尾移动，不会覆盖还没有移动的记录
+    std::sort(slots.begin(), slots.end(), [&](int a, int b) { return dir_[a].offset > dir_[b].offset; });
+    int end = PAGE_SIZE;
+    for (int slot_no : slots) {
+        end -= size(slot_no);
+        memmove(data_ + end, data_ + dir_[slot_no].offset, size(slot_no));
+        dir_[slot_no].offset = end;
+    }
+    hdr_->free_end = end;
+}
@@ -0,0 +1,88 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+
+#include "rm_file_handle.h"
+
+/* 变长格式页面的页头，紧跟在bitmap之后 */
+struct RmSlottedPageHdr {
+    uint16_t num_slots;     // slot目录的项数，目录末尾的空项会被回收
+    uint16_t free_end;      // 记录区的起始偏移，记录从页尾向前存放
+    uint16_t free_bytes;    // 页面中可用的字节数，包括记录区中删除和缩短记录留下的空洞
+    uint16_t reserved;
+};
+
+/* slot目录项，offset为0表示空项 */
+struct RmSlot {
+    uint16_t offset;        // 记录在页面中的偏移
+    uint16_t size;          // 低14位为记录的长度，高2位为标志
+};
+
+constexpr uint16_t RM_SLOT_FORWARD = 0x8000;    // 记录已经迁移到其他页面，这里存放的是迁移后的Rid
+constexpr uint16_t RM_SLOT_MOVED = 0x4000;      // 从其他页面迁移过来的记录，bitmap中不置位，扫描时跳过
+constexpr uint16_t RM_SLOT_SIZE_MASK = 0x3fff;
+
+/**
+ * @description: 对变长格式页面的封装。bitmap中置位的slot是对外可见的记录，与定长格式相同，
+ * 因此RmScan和is_record不需要区分页面格式；slot目录从页头向后增长，记录从页尾向前存放，
+ * 空间不连续时整理页面。调用者负责持有页面的锁
+ */
+class RmSlottedPage {
+   public:
+    explicit RmSlottedPage(const RmPageHandle &page_handle);
+
+    static void init(const RmPageHandle &page_handle);
+
+    // 变长格式页面中可以存放记录和slot目录的字节数
+    static int capacity(const RmFileHdr &file_hdr) { return PAGE_SIZE - dir_begin(file_hdr); }
+
+    bool is_used(int slot_no) const { return slot_no < hdr_->num_slots && dir_[slot_no].offset != 0; }
+
+    const char *get(int slot_no) const { return data_ + dir_[slot_no].offset; }
+
+    int size(int slot_no) const { return dir_[slot_no].size & RM_SLOT_SIZE_MASK; }
+
+    uint16_t flags(int slot_no) const { return dir_[slot_no].size & ~RM_SLOT_SIZE_MASK; }
+
+    int free_space() const { return hdr_->free_bytes; }
+
+    int find_free_slot() const;
+
+    bool fits(int slot_no, int len) const;
+
+    bool insert(int slot_no, const char *data, int len, uint16_t flags);
+
+    bool update(int slot_no, const char *data, int len, uint16_t flags);
+
+    void erase(int slot_no);
+
+   private:
+    char *data_;                // 页面数据的首地址
+    const char *bitmap_;
+    int max_slots_;
+    RmSlottedPageHdr *hdr_;
+    RmSlot *dir_;
+
+    static int dir_begin(const RmFileHdr &file_hdr) {
+        return Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr) + file_hdr.bitmap_size + sizeof(RmSlottedPageHdr);
+    }
+
+    // slot目录末尾到记录区开头之间连续的空闲字节数
+    int contiguous_space() const {
+        return hdr_->free_end - static_cast<int>(reinterpret_cast<char *>(dir_ + hdr_->num_slots) - data_);
+    }
+
+    void place(int slot_no, const char *data, int len, uint16_t flags);
+
+    void compact();
+};
@@ -0,0 +1,218 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "rm_zone_map.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+namespace {
+
+/* 区域映射文件的第0页，列定义紧跟在后面，各页面的范围从第1页开始连续存放 */
+struct RmZoneMapHdr {
+    int clean;      // 表是否正常关闭，打开表后置为0，为0时映射可能缺少崩溃前插入的记录
+    int num_cols;
+    int num_pages;  // 映射中记录的页面个数
+};
+
+constexpr int ENTRIES_PER_PAGE = PAGE_SIZE / sizeof(int64_t);
+
+}  // namespace
+
+/**
+ * @description: 把列值转换为保序的64位整数。浮点数按位翻转负数的低63位，-0.0当作0.0；
+ * 时间按年月日时分秒拼接，无效的时间在执行器中按空串比较，映射为最小的0
+ */
+int64_t RmZoneMap::key(ColType type, const char *data) {
+    switch (type) {
+        case TYPE_INT: {
+            int v;
+            memcpy(&v, data, sizeof(v));
+            return v;
+        }
+        case TYPE_BIGINT: {
+            int64_t v;
+            memcpy(&v, data, sizeof(v));
+            return v;
+        }
+        case TYPE_FLOAT: {
+            double v;
+            memcpy(&v, data, sizeof(v));
+            if (v == 0.0) {
+                v = 0.0;
+            }
+            int64_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            return bits < 0 ? bits ^ INT64_MAX : bits;
+        }
+        case TYPE_DATETIME: {
+            DateTime v;
+            memcpy(&v, data, sizeof(v));
+            if (!v.valid()) {
+                return 0;
+            }
+            return ((static_cast<int64_t>(v.year()) << 40) | (static_cast<int64_t>(v.month()) << 32) |
+                    (static_cast<int64_t>(v.day()) << 24) | (static_cast<int64_t>(v.hour()) << 16) |
+                    (static_cast<int64_t>(v.minutes()) << 8) | v.seconds()) + 1;
+        }
+        default:
+            throw InternalError("RmZoneMap::key: Unsupported column type");
+    }
+}
+
+void RmZoneMap::init(const std::vector<RmZoneCol> &cols) {
+    std::unique_lock lock{latch_};
+    cols_ = cols;
+    chunks_.clear();
+}
+
+int RmZoneMap::col_index(int offset, ColType type) const {
+    for (size_t i = 0; i < cols_.size(); i++) {
+        if (cols_[i].offset == offset && cols_[i].type == type) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @description: 把一条记录的列值计入页面的范围，多个线程可以并发地扩大同一个页面的范围
+ * @param {page_id_t} page_no 记录所在的数据页面号，迁移的记录为原来的页面
+ * @param {char*} record 长度为record_size的原始记录
+ */
+void RmZoneMap::widen(page_id_t page_no, const char *record) {
+    if (cols_.empty()) {
+        return;
+    }
+    size_t chunk = page_no / RM_ZONE_PAGES_PER_CHUNK;
+    {
+        std::shared_lock lock{latch_};
+        if (chunk < chunks_.size()) {
+            auto entry = &chunks_[chunk][(page_no % RM_ZONE_PAGES_PER_CHUNK) * cols_.size() * 2];
+            for (size_t i = 0; i < cols_.size(); i++) {
+                int64_t k = key(cols_[i].type, record + cols_[i].offset);
+                auto &min = entry[i * 2];
+                auto &max = entry[i * 2 + 1];
+                int64_t cur = min.load(std::memory_order_relaxed);
+                while (k < cur && !min.compare_exchange_weak(cur, k, std::memory_order_relaxed)) {
+                }
+                cur = max.load(std::memory_order_relaxed);
+                while (k > cur && !max.compare_exchange_weak(cur, k, std::memory_order_relaxed)) {
+                }
+            }
+            return;
+        }
+    }
+    grow(chunk + 1);
+    widen(page_no, record);
+}
+
+/**
+ * @description: 判断页面上是否可能有满足所有范围的记录
+ * @param {page_id_t} page_no 数据页面号
+ * @param {vector<RmZoneRange>&} ranges 扫描条件限定的范围
+ * @return {bool} 为false时页面上一定没有满足条件的记录，可以跳过
+ */
+bool RmZoneMap::may_match(page_id_t page_no, const std::vector<RmZoneRange> &ranges) const {
+    std::shared_lock lock{latch_};
+    size_t chunk = page_no / RM_ZONE_PAGES_PER_CHUNK;
+    if (chunk >= chunks_.size()) {
+        return std::all_of(ranges.begin(), ranges.end(), [](const RmZoneRange &range) { return range.lo <= range.hi; });
+    }
+    auto entry = &chunks_[chunk][(page_no % RM_ZONE_PAGES_PER_CHUNK) * cols_.size() * 2];
+    return std::all_of(ranges.begin(), ranges.end(), [&](const RmZoneRange &range) {
+        int64_t min = entry[range.col * 2].load(std::memory_order_relaxed);
+        int64_t max = entry[range.col * 2 + 1].load(std::memory_order_relaxed);
+        return range.lo <= range.hi && min <= range.hi && max >= range.lo;
+    });
+}
+
+/**
+ * @description: 从区域映射文件中读入映射，文件为正常关闭时写回的、列定义与init设置的一致时才读入
+ * @param {DiskManager*} disk_manager
+ * @param {int} fd 区域映射文件的文件句柄
+ * @return {bool} 是否读入了映射，为false时调用者需要重新建立映射
+ */
+bool RmZoneMap::load(DiskManager *disk_manager, int fd) {
+    if (disk_manager->get_file_size(disk_manager->get_file_name(fd)) < PAGE_SIZE) {
+        return false;
+    }
+    char buf[PAGE_SIZE];
+    disk_manager->read_page(fd, 0, buf, PAGE_SIZE);
+    RmZoneMapHdr hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (!hdr.clean || hdr.num_cols != static_cast<int>(cols_.size()) ||
+        sizeof(hdr) + hdr.num_cols * sizeof(RmZoneCol) > PAGE_SIZE) {
+        return false;
+    }
+    std::vector<RmZoneCol> cols(hdr.num_cols);
+    memcpy(cols.data(), buf + sizeof(hdr), hdr.num_cols * sizeof(RmZoneCol));
+    if (cols != cols_) {
+        return false;
+    }
+    size_t num_chunks = hdr.num_pages / RM_ZONE_PAGES_PER_CHUNK;
+    size_t num_entries = num_chunks * chunk_entries();
+    size_t num_data_pages = (num_entries + ENTRIES_PER_PAGE - 1) / ENTRIES_PER_PAGE;
+    if (static_cast<size_t>(disk_manager->get_file_size(disk_manager->get_file_name(fd))) <
+        (1 + num_data_pages) * PAGE_SIZE) {
+        return false;
+    }
+    grow(num_chunks);
+    for (size_t e = 0; e < num_entries; e++) {
+        if (e % ENTRIES_PER_PAGE == 0) {
+            disk_manager->read_page(fd, 1 + e / ENTRIES_PER_PAGE, buf, PAGE_SIZE);
+        }
+        int64_t v;
+        memcpy(&v, buf + e % ENTRIES_PER_PAGE * sizeof(int64_t), sizeof(v));
+        chunks_[e / chunk_entries()][e % chunk_entries()].store(v, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+/**
+ * @description: 把区域映射写回文件
+ * @param {DiskManager*} disk_manager
+ * @param {int} fd 区域映射文件的文件句柄
+ * @param {bool} clean 关闭表时为true；打开表时先写入false，崩溃后重新打开时据此重建映射
+ */
+void RmZoneMap::flush(DiskManager *disk_manager, int fd, bool clean) const {
+    std::shared_lock lock{latch_};
+    char buf[PAGE_SIZE] = {};
+    size_t num_entries = clean ? chunks_.size() * chunk_entries() : 0;
+    for (size_t e = 0; e < num_entries; e++) {
+        int64_t v = chunks_[e / chunk_entries()][e % chunk_entries()].load(std::memory_order_relaxed);
+        memcpy(buf + e % ENTRIES_PER_PAGE * sizeof(int64_t), &v, sizeof(v));
+        if ((e + 1) % ENTRIES_PER_PAGE == 0 || e + 1 == num_entries) {
+            disk_manager->write_page(fd, 1 + e / ENTRIES_PER_PAGE, buf, PAGE_SIZE);
+            memset(buf, 0, PAGE_SIZE);
+        }
+    }
+    // 先写范围再写文件头，文件头标记为正常关闭时范围一定是完整的
+    RmZoneMapHdr hdr{clean, static_cast<int>(cols_.size()), static_cast<int>(chunks_.size()) * RM_ZONE_PAGES_PER_CHUNK};
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), cols_.data(), cols_.size() * sizeof(RmZoneCol));
+    disk_manager->write_page(fd, 0, buf, PAGE_SIZE);
+}
+
+/**
+ * @description: 扩充映射，使其至少包含num_chunks块，新页面的范围为空
+ */
+void RmZoneMap::grow(size_t num_chunks) {
+    std::unique_lock lock{latch_};
+    while (chunks_.size() < num_chunks) {
+        Chunk chunk = std::make_unique<std::atomic<int64_t>[]>(chunk_entries());
+        for (size_t i = 0; i < chunk_entries(); i += 2) {
+            chunk[i].store(INT64_MAX, std::memory_order_relaxed);
+            chunk[i + 1].store(INT64_MIN, std::memory_order_relaxed);
+        }
+        chunks_.push_back(std::move(chunk));
+    }
+}
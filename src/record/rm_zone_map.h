@@ -0,0 +1,90 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "rm_defs.h"
+
+/* 建立区域映射的列，只支持定长的数值和时间类型 */
+struct RmZoneCol {
+    int offset;     // 列在记录中的偏移
+    ColType type;   // TYPE_INT、TYPE_FLOAT、TYPE_BIGINT或TYPE_DATETIME
+
+    bool operator==(const RmZoneCol &other) const { return offset == other.offset && type == other.type; }
+};
+
+/* 扫描条件在区域映射的一列上限定的取值范围[lo, hi]，按RmZoneMap::key比较，lo > hi时没有记录满足 */
+struct RmZoneRange {
+    int col;                    // 列在区域映射中的下标
+    int64_t lo = INT64_MIN;
+    int64_t hi = INT64_MAX;
+};
+
+/**
+ * @description: 表数据文件的区域映射(zone map)。对每个数据页面记录若干列的最小值和最大值，扫描时跳过
+ * 取值范围与扫描条件不相交的页面。插入和更新记录时只扩大所在页面的范围，删除时不缩小，范围总是包含页面上的
+ * 所有记录；变长格式中迁移到其他页面的记录计入原来的页面，与扫描时读到它的位置一致。
+ * 映射常驻内存，打开表时从与数据文件同名、后缀为RM_ZONE_MAP_SUFFIX的文件中读入并标记为未正常关闭，
+ * 关闭表时写回并清除标记；文件缺失、未正常关闭或列定义不一致时扫描数据页面重新建立
+ */
+class RmZoneMap {
+   public:
+    RmZoneMap() = default;
+
+    ~RmZoneMap() = default;
+
+    RmZoneMap(const RmZoneMap &) = delete;
+    RmZoneMap &operator=(const RmZoneMap &) = delete;
+
+    static bool is_supported(ColType type) {
+        return type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_BIGINT || type == TYPE_DATETIME;
+    }
+
+    /**
+     * @description: 把列值转换为保序的64位整数，两个值的大小关系与执行器中的比较结果一致
+     * @param {ColType} type 列的类型
+     * @param {char*} data 列值在记录中的存放形式
+     */
+    static int64_t key(ColType type, const char *data);
+
+    // 设置建立映射的列并清空映射，须在使用映射之前调用
+    void init(const std::vector<RmZoneCol> &cols);
+
+    const std::vector<RmZoneCol> &cols() const { return cols_; }
+
+    // 列在映射中的下标，没有为该列建立映射时返回-1
+    int col_index(int offset, ColType type) const;
+
+    void widen(page_id_t page_no, const char *record);
+
+    bool may_match(page_id_t page_no, const std::vector<RmZoneRange> &ranges) const;
+
+    bool load(DiskManager *disk_manager, int fd);
+
+    void flush(DiskManager *disk_manager, int fd, bool clean) const;
+
+   private:
+    /* 每个Chunk记录RM_ZONE_PAGES_PER_CHUNK个页面，每个页面每列依次存放最小值和最大值，空页面的最小值大于最大值 */
+    using Chunk = std::unique_ptr<std::atomic<int64_t>[]>;
+
+    mutable std::shared_mutex latch_;   // 保护chunks_的扩容，读写单个页面的范围只需要读锁
+    std::vector<RmZoneCol> cols_;
+    std::vector<Chunk> chunks_;
+
+    size_t chunk_entries() const { return static_cast<size_t>(RM_ZONE_PAGES_PER_CHUNK) * cols_.size() * 2; }
+
+    void grow(size_t num_chunks);
+};
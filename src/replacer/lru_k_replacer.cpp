@@ -0,0 +1,200 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k),
+      max_size_(num_pages),
+      history_(num_pages * k, 0),
+      ref_count_(num_pages, 0),
+      prev_(num_pages, INVALID_FRAME_ID),
+      next_(num_pages, INVALID_FRAME_ID),
+      in_list_(num_pages, NONE),
+      heap_(num_pages, INVALID_FRAME_ID),
+      heap_pos_(num_pages, 0) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * @description: 记录一次对frame的访问，连续访问同一个frame只记录一次
+ * @param {frame_id_t} frame_id 被访问的frame的id
+ */
+void LRUKReplacer::record_access(frame_id_t frame_id) {
+    current_ts_++;
+    if (last_ref_frame_ == frame_id && ref_count_[frame_id] > 0) {
+        return;
+    }
+    last_ref_frame_ = frame_id;
+    history_[frame_id * k_ + ref_count_[frame_id] % k_] = current_ts_;
+    ref_count_[frame_id]++;
+}
+
+void LRUKReplacer::list_push_back(FrameList &list, frame_id_t frame_id) {
+    prev_[frame_id] = list.tail_;
+    next_[frame_id] = INVALID_FRAME_ID;
+    if (list.tail_ != INVALID_FRAME_ID) {
+        next_[list.tail_] = frame_id;
+    } else {
+        list.head_ = frame_id;
+    }
+    list.tail_ = frame_id;
+}
+
+void LRUKReplacer::list_erase(FrameList &list, frame_id_t frame_id) {
+    if (prev_[frame_id] != INVALID_FRAME_ID) {
+        next_[prev_[frame_id]] = next_[frame_id];
+    } else {
+        list.head_ = next_[frame_id];
+    }
+    if (next_[frame_id] != INVALID_FRAME_ID) {
+        prev_[next_[frame_id]] = prev_[frame_id];
+    } else {
+        list.tail_ = prev_[frame_id];
+    }
+    prev_[frame_id] = next_[frame_id] = INVALID_FRAME_ID;
+}
+
+void LRUKReplacer::heap_push(frame_id_t frame_id) {
+    heap_set(heap_size_++, frame_id);
+    heap_sift_up(heap_size_ - 1);
+}
+
+void LRUKReplacer::heap_erase(frame_id_t frame_id) {
+    size_t pos = heap_pos_[frame_id];
+    heap_size_--;
+    if (pos == heap_size_) {
+        return;
+    }
+    // 用最后一个frame填补空位，再按其排序键向上或向下调整
+    frame_id_t moved = heap_[heap_size_];
+    heap_set(pos, moved);
+    heap_sift_up(pos);
+    heap_sift_down(heap_pos_[moved]);
+}
+
+void LRUKReplacer::heap_sift_up(size_t pos) {
+    frame_id_t frame_id = heap_[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (kth_access(heap_[parent]) <= kth_access(frame_id)) {
+            break;
+        }
+        heap_set(pos, heap_[parent]);
+        pos = parent;
+    }
+    heap_set(pos, frame_id);
+}
+
+void LRUKReplacer::heap_sift_down(size_t pos) {
+    if (pos >= heap_size_) {
+        return;
+    }
+    frame_id_t frame_id = heap_[pos];
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= heap_size_) {
+            break;
+        }
+        if (child + 1 < heap_size_ && kth_access(heap_[child + 1]) < kth_access(heap_[child])) {
+            child++;
+        }
+        if (kth_access(frame_id) <= kth_access(heap_[child])) {
+            break;
+        }
+        heap_set(pos, heap_[child]);
+        pos = child;
+    }
+    heap_set(pos, frame_id);
+}
+
+/**
+ * @description: 使用LRU-K策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim(frame_id_t* frame_id) {
+    std::scoped_lock lock{latch_};
+
+    if (size_ == 0) {
+        return false;
+    }
+
+    frame_id_t victim_id = INVALID_FRAME_ID;
+    if (cold_.head_ != INVALID_FRAME_ID) {
+        // 后向K距离为无穷大的frame优先淘汰
+        victim_id = cold_.head_;
+        list_erase(cold_, victim_id);
+    } else {
+        // 第K次最近访问最早的frame在堆顶
+        victim_id = heap_[0];
+        heap_erase(victim_id);
+    }
+
+    in_list_[victim_id] = NONE;
+    // 该frame将装入新的页面，清空访问历史
+    ref_count_[victim_id] = 0;
+    if (last_ref_frame_ == victim_id) {
+        last_ref_frame_ = INVALID_FRAME_ID;
+    }
+    size_--;
+    *frame_id = victim_id;
+    stats_.victims.add();
+    return true;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰；缓冲池每次获取页面都会调用pin，因此在这里记录访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    stats_.pins.add();
+
+    record_access(frame_id);
+    if (in_list_[frame_id] != NONE) {
+        if (in_list_[frame_id] == COLD) {
+            list_erase(cold_, frame_id);
+        } else {
+            heap_erase(frame_id);
+        }
+        in_list_[frame_id] = NONE;
+        size_--;
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    stats_.unpins.add();
+
+    if (in_list_[frame_id] != NONE) {
+        return;
+    }
+    if (ref_count_[frame_id] >= k_) {
+        heap_push(frame_id);
+        in_list_[frame_id] = HOT;
+    } else {
+        list_push_back(cold_, frame_id);
+        in_list_[frame_id] = COLD;
+    }
+    size_++;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return size_;
+}
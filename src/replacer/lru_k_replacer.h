@@ -0,0 +1,94 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+LRUKReplacer实现了LRU-K替换策略：
+访问次数不足K次的frame(例如全表扫描只读过一次的页面)优先按LRU顺序淘汰，
+其余frame中淘汰第K次最近访问时间最早的那个，从而避免顺序扫描冲刷掉热点页面。
+连续两次访问同一个frame视为相关访问，只记录一次。
+所有状态保存在构造时分配好的数组中，pin/unpin/victim过程中不会申请内存
+*/
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的LRUKReplacer
+     * @param {size_t} num_pages LRUKReplacer最多需要存储的page数量
+     * @param {size_t} k 计算后向K距离时使用的访问次数
+     */
+    LRUKReplacer(size_t num_pages, size_t k);
+
+    ~LRUKReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    // frame所在的可淘汰链表
+    enum ListType : char { NONE = 0, COLD, HOT };
+
+    struct FrameList {
+        frame_id_t head_ = INVALID_FRAME_ID;
+        frame_id_t tail_ = INVALID_FRAME_ID;
+    };
+
+    void record_access(frame_id_t frame_id);
+
+    void list_push_back(FrameList &list, frame_id_t frame_id);
+
+    void list_erase(FrameList &list, frame_id_t frame_id);
+
+    void heap_push(frame_id_t frame_id);
+
+    void heap_erase(frame_id_t frame_id);
+
+    void heap_sift_up(size_t pos);
+
+    void heap_sift_down(size_t pos);
+
+    void heap_set(size_t pos, frame_id_t frame_id) {
+        heap_[pos] = frame_id;
+        heap_pos_[frame_id] = pos;
+    }
+
+    // 第K次最近访问的时间戳，调用者需保证该frame已有至少K次访问
+    inline uint64_t kth_access(frame_id_t frame_id) const {
+        return history_[frame_id * k_ + (ref_count_[frame_id] - k_) % k_];
+    }
+
+    std::mutex latch_;                  // 互斥锁
+    size_t k_;
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+    uint64_t current_ts_ = 0;           // 逻辑时钟，每次访问加一
+    frame_id_t last_ref_frame_ = INVALID_FRAME_ID;  // 最近一次访问的frame，用于识别相关访问
+    std::vector<uint64_t> history_;     // 每个frame最近K次访问的时间戳，按环形数组存放
+    std::vector<size_t> ref_count_;     // 每个frame被记录的访问次数
+    std::vector<frame_id_t> prev_;      // cold_链表的前驱
+    std::vector<frame_id_t> next_;      // cold_链表的后继
+    std::vector<ListType> in_list_;     // frame当前所在的链表
+    FrameList cold_;                    // 访问次数不足K次的可淘汰frame，按unpin的先后顺序排列
+    // 访问次数达到K次的可淘汰frame，按第K次最近访问时间组成的小根堆；frame在堆中时不会被访问，其排序键不变
+    std::vector<frame_id_t> heap_;
+    std::vector<size_t> heap_pos_;      // 每个frame在heap_中的下标
+    size_t heap_size_ = 0;
+    size_t size_ = 0;                   // 可淘汰的frame数量
+};
@@ -36,6 +36,7 @@ bool LRUReplacer::victim(frame_id_t* frame_id) {
     *frame_id = LRUlist_.back();
     LRUlist_.pop_back();
     LRUhash_.erase(*frame_id);
+    stats_.victims.add();
     return true;
 
 //    for (auto it = LRUlist_.rbegin(); it != LRUlist_.rend(); ++it) {
@@ -55,6 +56,7 @@ bool LRUReplacer::victim(frame_id_t* frame_id) {
  */
 void LRUReplacer::pin(frame_id_t frame_id) {
     std::scoped_lock lock{latch_};
+    stats_.pins.add();
     // Todo:
     // 固定指定id的frame
     // 在数据结构中移除该frame
@@ -77,6 +79,7 @@ void LRUReplacer::unpin(frame_id_t frame_id) {
     //  选择一个frame取消固定
 
     std::scoped_lock lock(latch_);
+    stats_.unpins.add();
 
     // LRUList 空间有限
     if (LRUlist_.size() >= max_size_) {
@@ -11,6 +11,22 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "common/config.h"
+#include "common/stats.h"
+
+/**
+ * @description: 置换策略的操作计数
+ */
+struct ReplacerStats {
+    StatCounter victims;    // 成功选出淘汰帧的次数
+    StatCounter pins;       // pin调用次数
+    StatCounter unpins;     // unpin调用次数
+
+    void merge(const ReplacerStats &other) {
+        victims.add(other.victims.get());
+        pins.add(other.pins.get());
+        unpins.add(other.unpins.get());
+    }
+};
 
 /**
  * Replacer is an abstract class that tracks page usage.
@@ -41,4 +57,10 @@ class Replacer {
 
     /** @return the number of elements in the replacer that can be victimized */
     virtual size_t Size() = 0;
+
+    /** @return counters of victim/pin/unpin calls, updated without taking the replacer latch */
+    const ReplacerStats &get_stats() const { return stats_; }
+
+   protected:
+    ReplacerStats stats_;
 };
@@ -29,21 +29,21 @@ See the Mulan PSL v2 for more details. */
 
 static bool should_exit = false;
 
-// 构建全局所需的管理器对象
+// 全局所需的管理器对象，在main中解析完启动参数后由init_managers构建
 auto disk_manager = std::make_unique<DiskManager>();
-auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
-auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
-auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
-auto sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
-auto lock_manager = std::make_unique<LockManager>();
-auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
-auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
-auto log_manager = std::make_unique<LogManager>(disk_manager.get());
-auto recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
-auto planner = std::make_unique<Planner>(sm_manager.get());
-auto optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
-auto portal = std::make_unique<Portal>(sm_manager.get());
-auto analyze = std::make_unique<Analyze>(sm_manager.get());
+std::unique_ptr<BufferPoolManager> buffer_pool_manager;
+std::unique_ptr<RmManager> rm_manager;
+std::unique_ptr<IxManager> ix_manager;
+std::unique_ptr<SmManager> sm_manager;
+std::unique_ptr<LockManager> lock_manager;
+std::unique_ptr<TransactionManager> txn_manager;
+std::unique_ptr<QlManager> ql_manager;
+std::unique_ptr<LogManager> log_manager;
+std::unique_ptr<RecoveryManager> recovery;
+std::unique_ptr<Planner> planner;
+std::unique_ptr<Optimizer> optimizer;
+std::unique_ptr<Portal> portal;
+std::unique_ptr<Analyze> analyze;
 pthread_mutex_t *buffer_mutex;
 pthread_mutex_t *sockfd_mutex;
 
@@ -267,14 +267,93 @@ void start_server() {
     std::cout << "Server shuts down." << std::endl;
 }
 
+/**
+ * @description: 构建全局的管理器对象
+ * @param {size_t} buffer_pool_size 缓冲池的帧数
+ */
+void init_managers(size_t buffer_pool_size) {
+    buffer_pool_manager = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), BUFFER_POOL_SHARDS);
+    rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
+    lock_manager = std::make_unique<LockManager>();
+    txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
+    ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
+    log_manager = std::make_unique<LogManager>(disk_manager.get());
+    recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
+    planner = std::make_unique<Planner>(sm_manager.get());
+    optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
+    portal = std::make_unique<Portal>(sm_manager.get());
+    analyze = std::make_unique<Analyze>(sm_manager.get());
+}
+
+/**
+ * @description: 解析缓冲池大小，不带单位时为帧数，带K/M/G单位时为字节数
+ * @return {size_t} 缓冲池的帧数，格式错误时返回0
+ * @param {string&} arg 例如"65536"、"256M"、"1G"
+ */
+size_t parse_buffer_pool_size(const std::string &arg) {
+    size_t pos = 0;
+    unsigned long long value;
+    try {
+        value = std::stoull(arg, &pos);
+    } catch (std::exception &) {
+        return 0;
+    }
+    std::string unit = arg.substr(pos);
+    if (unit.empty()) {
+        return value;
+    }
+    if (unit.size() != 1) {
+        return 0;
+    }
+    switch (toupper(unit[0])) {
+        case 'K':
+            return value * 1024 / PAGE_SIZE;
+        case 'M':
+            return value * 1024 * 1024 / PAGE_SIZE;
+        case 'G':
+            return value * 1024 * 1024 * 1024 / PAGE_SIZE;
+        default:
+            return 0;
+    }
+}
+
 int main(int argc, char **argv) {
-    if (argc != 2) {
+    // rmdb [-b <buffer_pool_size>] <database>
+    size_t buffer_pool_size = BUFFER_POOL_SIZE;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:")) != -1) {
+        if (opt == 'b') {
+            buffer_pool_size = parse_buffer_pool_size(optarg);
+            if (buffer_pool_size < BUFFER_POOL_SHARDS) {
+                std::cerr << "Invalid buffer pool size: " << optarg << std::endl;
+                exit(1);
+            }
+        } else {
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (optind != argc - 1) {
         // 需要指定数据库名称
-        std::cerr << "Usage: " << argv[0] << " <database>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [-b <buffer_pool_size>] <database>\n"
+                  << "  -b  frames in the buffer pool, or bytes with a K/M/G suffix (default "
+                  << BUFFER_POOL_SIZE << " frames)" << std::endl;
+        exit(1);
+    }
+
+    try {
+        init_managers(buffer_pool_size);
+    } catch (RMDBError &e) {
+        std::cerr << e.what() << std::endl;
         exit(1);
     }
 
     signal(SIGINT, sigint_handler);
+    // 缓冲池写回脏页之前，页面page_lsn及之前的日志需要先写入磁盘。LogManager::flush_log_to_disk还没有实现，
+    // 目前不保证WAL，因此不设置set_flush_log；日志落盘实现后在这里接入
+    buffer_pool_manager->start_flusher();
     try {
         std::cout << "\n"
                      "  _____  __  __ _____  ____  \n"
@@ -288,7 +367,7 @@ int main(int argc, char **argv) {
                      "Type 'help;' for help.\n"
                      "\n";
         // Database name is passed by args
-        std::string db_name = argv[1];
+        std::string db_name = argv[optind];
         if (!sm_manager->is_dir(db_name)) {
             // Database not found, create a new one
             sm_manager->create_db(db_name);
@@ -0,0 +1,168 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/async_io.h"
+
+#include <errno.h>
+#include <unistd.h>  // for pread, pwrite
+
+#include "errors.h"
+
+std::unique_ptr<AsyncIO> AsyncIO::create(const std::string &type) {
+    if (type == "NONE") {
+        return nullptr;
+    }
+#ifdef RMDB_HAVE_LIBURING
+    if (type == "IO_URING") {
+        return std::make_unique<IoUringAsyncIO>(IO_URING_QUEUE_DEPTH);
+    }
+#else
+    if (type == "IO_URING") {
+        return std::make_unique<ThreadPoolAsyncIO>(ASYNC_IO_THREADS);
+    }
+#endif
+    if (type == "THREAD_POOL") {
+        return std::make_unique<ThreadPoolAsyncIO>(ASYNC_IO_THREADS);
+    }
+    throw InternalError("AsyncIO: unknown async io type " + type);
+}
+
+ThreadPoolAsyncIO::ThreadPoolAsyncIO(size_t num_threads) {
+    for (size_t i = 0; i < num_threads; i++) {
+        workers_.emplace_back(&ThreadPoolAsyncIO::worker, this);
+    }
+}
+
+ThreadPoolAsyncIO::~ThreadPoolAsyncIO() {
+    {
+        std::scoped_lock lock{latch_};
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPoolAsyncIO::submit(std::shared_ptr<IoRequest> request) {
+    {
+        std::scoped_lock lock{latch_};
+        queue_.emplace_back(std::move(request));
+    }
+    cv_.notify_one();
+}
+
+/**
+ * @description: I/O线程，依次取出请求并同步地完成读写，退出前处理完队列中剩余的请求
+ */
+void ThreadPoolAsyncIO::worker() {
+    while (true) {
+        std::shared_ptr<IoRequest> request;
+        {
+            std::unique_lock lock{latch_};
+            cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            request = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        // pread/pwrite可能只完成一部分，循环直到读写完全部字节、读到文件末尾或出错
+        ssize_t done = 0;
+        while (done < request->num_bytes_) {
+            ssize_t bytes = request->type_ == IoRequest::Type::READ
+                                ? pread(request->fd_, request->data_ + done, request->num_bytes_ - done,
+                                        request->get_offset() + done)
+                                : pwrite(request->fd_, request->data_ + done, request->num_bytes_ - done,
+                                         request->get_offset() + done);
+            if (bytes < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytes <= 0) {
+                done = bytes < 0 ? -errno : done;
+                break;
+            }
+            done += bytes;
+        }
+        request->complete(done);
+    }
+}
+
+#ifdef RMDB_HAVE_LIBURING
+IoUringAsyncIO::IoUringAsyncIO(unsigned queue_depth) : queue_depth_(queue_depth) {
+    int ret = io_uring_queue_init(queue_depth, &ring_, 0);
+    if (ret < 0) {
+        errno = -ret;
+        throw UnixError();
+    }
+    reaper_ = std::thread(&IoUringAsyncIO::reap, this);
+}
+
+IoUringAsyncIO::~IoUringAsyncIO() {
+    // 提交一个user_data为空的NOP请求通知收割线程退出
+    {
+        std::unique_lock lock{submit_latch_};
+        submit_cv_.wait(lock, [&] { return inflight_ < queue_depth_; });
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+        io_uring_prep_nop(sqe);
+        io_uring_sqe_set_data(sqe, nullptr);
+        io_uring_submit(&ring_);
+        inflight_++;
+    }
+    reaper_.join();
+    io_uring_queue_exit(&ring_);
+}
+
+void IoUringAsyncIO::submit(std::shared_ptr<IoRequest> request) {
+    std::unique_lock lock{submit_latch_};
+    // 在途请求数不超过队列深度，保证提交队列和完成队列都不会溢出
+    submit_cv_.wait(lock, [&] { return inflight_ < queue_depth_; });
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+    if (request->type_ == IoRequest::Type::READ) {
+        io_uring_prep_read(sqe, request->fd_, request->data_, request->num_bytes_, request->get_offset());
+    } else {
+        io_uring_prep_write(sqe, request->fd_, request->data_, request->num_bytes_, request->get_offset());
+    }
+    // 请求完成前由提交队列持有一份引用，收割线程完成请求后释放
+    io_uring_sqe_set_data(sqe, new std::shared_ptr<IoRequest>(std::move(request)));
+    io_uring_submit(&ring_);
+    inflight_++;
+}
+
+/**
+ * @description: 收割线程，等待完成队列中的事件并唤醒等待请求的线程
+ */
+void IoUringAsyncIO::reap() {
+    while (true) {
+        struct io_uring_cqe *cqe;
+        int ret = io_uring_wait_cqe(&ring_, &cqe);
+        if (ret == -EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            return;
+        }
+        auto *request = static_cast<std::shared_ptr<IoRequest> *>(io_uring_cqe_get_data(cqe));
+        ssize_t result = cqe->res;
+        io_uring_cqe_seen(&ring_, cqe);
+        {
+            std::scoped_lock lock{submit_latch_};
+            inflight_--;
+        }
+        submit_cv_.notify_one();
+        if (request == nullptr) {
+            return;
+        }
+        (*request)->complete(result);
+        delete request;
+    }
+}
+#endif
@@ -0,0 +1,140 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef RMDB_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include "common/config.h"
+#include "storage/page.h"
+
+/**
+ * @description: 一次异步的页面读写请求。提交给AsyncIO后由后台完成，调用者通过wait()等待结果
+ */
+class IoRequest {
+   public:
+    enum class Type { READ, WRITE };
+
+    IoRequest(Type type, int fd, page_id_t page_no, char *data, int num_bytes)
+        : type_(type), fd_(fd), page_no_(page_no), data_(data), num_bytes_(num_bytes) {}
+
+    /**
+     * @description: 等待请求完成
+     * @return {bool} 是否完整地读写了num_bytes个字节
+     */
+    bool wait() {
+        std::unique_lock lock{latch_};
+        cv_.wait(lock, [&] { return done_; });
+        return result_ == num_bytes_;
+    }
+
+    /**
+     * @description: 由AsyncIO在请求完成时调用
+     * @param {ssize_t} result 读写的字节数，出错时为-errno
+     */
+    void complete(ssize_t result) {
+        {
+            std::scoped_lock lock{latch_};
+            result_ = result;
+            done_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    off_t get_offset() const { return static_cast<off_t>(page_no_) * PAGE_SIZE; }
+
+    PageId get_page_id() const { return {fd_, page_no_}; }
+
+    Type type_;
+    int fd_;
+    page_id_t page_no_;
+    char *data_;
+    int num_bytes_;
+
+   private:
+    std::mutex latch_;
+    std::condition_variable cv_;
+    bool done_ = false;
+    ssize_t result_ = 0;
+};
+
+/**
+ * @description: 异步磁盘I/O后端。提交请求后立即返回，请求在后台完成
+ */
+class AsyncIO {
+   public:
+    virtual ~AsyncIO() = default;
+
+    virtual void submit(std::shared_ptr<IoRequest> request) = 0;
+
+    /**
+     * @description: 按类型创建异步I/O后端，编译时没有找到liburing则"IO_URING"退化为"THREAD_POOL"
+     * @return {unique_ptr<AsyncIO>} type为"NONE"时返回空指针
+     * @param {string&} type "NONE"、"IO_URING"或"THREAD_POOL"
+     */
+    static std::unique_ptr<AsyncIO> create(const std::string &type);
+};
+
+/**
+ * @description: 用固定数量的I/O线程执行pread/pwrite来模拟异步I/O
+ */
+class ThreadPoolAsyncIO : public AsyncIO {
+   public:
+    explicit ThreadPoolAsyncIO(size_t num_threads);
+
+    ~ThreadPoolAsyncIO() override;
+
+    void submit(std::shared_ptr<IoRequest> request) override;
+
+   private:
+    void worker();
+
+    std::vector<std::thread> workers_;
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<IoRequest>> queue_;
+    bool stop_ = false;
+};
+
+#ifdef RMDB_HAVE_LIBURING
+/**
+ * @description: 基于io_uring的异步I/O，提交线程直接写入提交队列，由一个收割线程等待完成队列
+ */
+class IoUringAsyncIO : public AsyncIO {
+   public:
+    explicit IoUringAsyncIO(unsigned queue_depth);
+
+    ~IoUringAsyncIO() override;
+
+    void submit(std::shared_ptr<IoRequest> request) override;
+
+   private:
+    void reap();
+
+    struct io_uring ring_;
+    std::mutex submit_latch_;       // io_uring的提交队列不是线程安全的
+    std::condition_variable submit_cv_;
+    unsigned queue_depth_;
+    unsigned inflight_ = 0;         // 已提交未收割的请求数，不超过queue_depth_
+    std::thread reaper_;
+};
+#endif
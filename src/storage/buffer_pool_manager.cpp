@@ -11,63 +11,238 @@ See the Mulan PSL v2 for more details. */
 #include "buffer_pool_manager.h"
 
 /**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ * @description: 从分片的free_list或replacer中得到可淘汰帧页的 *frame_id，调用者需持有分片写锁
  * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {BufferPoolShard*} shard 目标页所在的分片
  * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，不为空时优先复用环中的帧
  */
-bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
+bool BufferPoolManager::find_victim_page(BufferPoolShard *shard, frame_id_t* frame_id, BufferAccessStrategy *strategy) {
+    // 环中当前位置的帧仍装载着放入时的页面且没有被固定，则直接复用
+    if (strategy != nullptr) {
+        auto &ring = strategy->get_ring(shard->shard_no_, num_shards_);
+        auto &slot = ring.slots_[ring.cur_];
+        if (slot.frame_id != INVALID_FRAME_ID && shard->page_table_.find(slot.page_id) == slot.frame_id &&
+            claim_frame(slot.frame_id)) {
+            shard->stats_.evictions.add();
+            if (pages_[slot.frame_id].is_dirty()) {
+                shard->stats_.dirty_evictions.add();
+            }
+            shard->pin(slot.frame_id);
+            *frame_id = slot.frame_id;
+            return true;
+        }
+    }
+
     // Todo:
     // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
     // 1.1 未满获得frame
     // 1.2 已满使用lru_replacer中的方法选择淘汰页面
 
     // 当缓冲池中没有可用的空闲帧时，该成员函数用于寻找需要淘汰的页面。
-    if (free_list_.empty()) {
-        if (!replacer_->victim(frame_id)) {
+    if (shard->free_list_.empty()) {
+        // 命中路径不持有写锁，pin与unpin对replacer的操作可能交错，
+        // 导致已被重新固定的帧残留在replacer中，这里跳过这些帧，它们在pin_count归零时会被重新加入。
+        // 脏页留给后台写回线程处理，至多跳过BUFFER_DIRTY_VICTIM_SKIP个脏页，都是脏页时才同步写回第一个
+        frame_id_t victim = INVALID_FRAME_ID;
+        std::vector<frame_id_t> skipped;
+        frame_id_t candidate;
+        while (shard->victim(&candidate)) {
+            if (pages_[candidate].pin_count_ != 0) {
+                continue;
+            }
+            if (!pages_[candidate].is_dirty() || skipped.size() >= BUFFER_DIRTY_VICTIM_SKIP) {
+                if (claim_frame(candidate)) {
+                    victim = candidate;
+                    break;
+                }
+                continue;
+            }
+            skipped.push_back(candidate);
+        }
+        for (frame_id_t frame : skipped) {
+            if (victim == INVALID_FRAME_ID && claim_frame(frame)) {
+                victim = frame;
+            } else {
+                shard->unpin(frame);
+            }
+        }
+        if (victim == INVALID_FRAME_ID) {
             return false;
         }
+        shard->stats_.evictions.add();
+        if (pages_[victim].is_dirty()) {
+            shard->stats_.dirty_evictions.add();
+        }
+        if (!skipped.empty() || pages_[victim].is_dirty()) {
+            wake_flusher();
+        }
+        *frame_id = victim;
     }
     else {
-        // 被淘汰的页面所在的帧由参数frame_id返回
-        *frame_id = free_list_.front();
-        free_list_.pop_front();
+        // 被淘汰的页面所在的帧由参数frame_id返回，空闲帧的pin_count_已经是-1
+        *frame_id = shard->free_list_.front();
+        shard->free_list_.pop_front();
     }
     return true;
 }
 
+/**
+ * @description: 退还find_victim_page取得但没有使用的帧，调用者需持有分片写锁。
+ *              空闲帧放回free_list_；被淘汰的帧还没有被update_page改动，其中的页面仍然有效，恢复为未固定并交还replacer
+ * @param {BufferPoolShard*} shard 帧所在的分片
+ * @param {frame_id_t} frame_id 帧号
+ */
+void BufferPoolManager::return_victim_page(BufferPoolShard *shard, frame_id_t frame_id) {
+    if (shard->page_table_.find(pages_[frame_id].get_page_id()) != frame_id) {
+        shard->free_list_.push_front(frame_id);
+        return;
+    }
+    pages_[frame_id].pin_count_ = 0;
+    shard->unpin(frame_id);
+}
+
+/**
+ * @description: 占用一个未被固定的帧用于淘汰，把pin_count_从0改为-1，之后不加锁的命中路径不能再固定它。
+ *              调用者需持有分片写锁
+ * @return {bool} 帧的pin_count_是否为0
+ * @param {frame_id_t} frame_id 帧号
+ */
+bool BufferPoolManager::claim_frame(frame_id_t frame_id) {
+    int expected = 0;
+    return pages_[frame_id].pin_count_.compare_exchange_strong(expected, -1);
+}
+
+/**
+ * @description: 把帧的pin_count_减一，减到0时放入replacer。pin_count_不大于0时(帧已被delete_all_pages回收)不做任何事
+ * @param {BufferPoolShard*} shard 帧所在的分片
+ * @param {frame_id_t} frame_id 帧号
+ */
+void BufferPoolManager::release_pin(BufferPoolShard *shard, frame_id_t frame_id) {
+    int pin_count = pages_[frame_id].pin_count_.load();
+    do {
+        if (pin_count <= 0) {
+            return;
+        }
+    } while (!pages_[frame_id].pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+    if (pin_count == 1) {
+        shard->unpin(frame_id);
+    }
+}
+
+/**
+ * @description: 不加锁的命中路径。查找page_table_得到帧号并固定该帧，之后检查分片的version_，
+ *              若查找前后有写者持有过分片写锁则撤销固定。version_不变说明查找期间页表没有被修改，
+ *              且之后的写者淘汰帧之前一定能看到这次固定
+ * @return {frame_id_t} 成功时返回已固定的帧号，页面不在缓冲池中或与写者并发时返回INVALID_FRAME_ID
+ * @param {BufferPoolShard*} shard 目标页所在的分片
+ * @param {PageId} page_id 目标页
+ */
+frame_id_t BufferPoolManager::optimistic_pin(BufferPoolShard *shard, PageId page_id) {
+    uint64_t version = shard->version_.load();
+    if (version & 1) {
+        return INVALID_FRAME_ID;
+    }
+    frame_id_t frameId = shard->page_table_.find(page_id);
+    // 与写者并发时可能读到不完整的槽，帧号越界时直接放弃
+    if (frameId < shard->frame_begin_ || frameId >= shard->frame_end_) {
+        return INVALID_FRAME_ID;
+    }
+    int pin_count = pages_[frameId].pin_count_.load();
+    do {
+        if (pin_count < 0) {
+            return INVALID_FRAME_ID;
+        }
+    } while (!pages_[frameId].pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+    if (shard->version_.load() != version) {
+        release_pin(shard, frameId);
+        return INVALID_FRAME_ID;
+    }
+    return frameId;
+}
+
+/**
+ * @description: 把刚装入新页面的帧放入访问策略的环中当前位置，并前移环的游标
+ * @param {BufferPoolShard*} shard 帧所在的分片
+ * @param {frame_id_t} frame_id 帧号
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略
+ */
+void BufferPoolManager::add_to_ring(BufferPoolShard *shard, frame_id_t frame_id, BufferAccessStrategy *strategy) {
+    auto &ring = strategy->get_ring(shard->shard_no_, num_shards_);
+    ring.slots_[ring.cur_] = {frame_id, pages_[frame_id].get_page_id()};
+    ring.cur_ = (ring.cur_ + 1) % ring.slots_.size();
+}
+
 /**
  * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
+ * @param {BufferPoolShard*} shard 帧所在的分片
  * @param {Page*} page 写回页指针
  * @param {PageId} new_page_id 新的page_id
  * @param {frame_id_t} new_frame_id 新的帧frame_id
  */
-void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
+void BufferPoolManager::update_page(BufferPoolShard *shard, Page *page, PageId new_page_id, frame_id_t new_frame_id) {
     // Todo:
     // 1 如果是脏页，写回磁盘，并且把dirty置为false
     // 2 更新page table
     // 3 重置page的data，更新page id
 
     if (page->is_dirty()) {
-        disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-        page->is_dirty_ = false;
+        write_back(shard, page);
     }
 
-    page_table_.erase(page->get_page_id());
-    page_table_[new_page_id] = new_frame_id;
+    // 空闲帧中残留的旧page_id可能已经被读入了其他帧，只删除仍指向本帧的映射
+    if (shard->page_table_.find(page->get_page_id()) == new_frame_id) {
+        shard->page_table_.erase(page->get_page_id());
+    }
+    shard->page_table_.insert(new_page_id, new_frame_id);
 
     page->reset_memory();
+    page->io_.reset();
+    page->io_pending_ = false;
     page->id_ = new_page_id;
+    // 帧已经被claim_frame占用(pin_count_为-1)，不会有其他线程同时修改pin_count_
     page->pin_count_ = 1;
 }
 
+/**
+ * @description: 等待页面在锁外进行的写回完成，调用者需持有分片的读锁或写锁。
+ *              之后再写同一个页面，较早复制的旧数据才不会在新数据之后落盘；
+ *              写回请求先完成再去拿分片锁撤销登记，持锁等待不会死锁
+ * @param {BufferPoolShard*} shard 页面所在的分片
+ * @param {PageId} page_id 页面
+ */
+void BufferPoolManager::wait_write_back(BufferPoolShard *shard, PageId page_id) {
+    auto iter = shard->write_backs_.find(page_id);
+    if (iter != shard->write_backs_.end()) {
+        shard->stats_.io_waits.add();
+        iter->second->wait();
+    }
+}
+
+/**
+ * @description: 把帧中的页面写回磁盘并清除脏标记，调用者需持有分片的读锁或写锁
+ * @param {BufferPoolShard*} shard 帧所在的分片
+ * @param {Page*} page 写回页指针
+ */
+void BufferPoolManager::write_back(BufferPoolShard *shard, Page *page) {
+    wait_write_back(shard, page->get_page_id());
+    if (flush_log_) {
+        flush_log_(page->get_page_lsn());
+    }
+    disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
+    page->is_dirty_ = false;
+    shard->write_epoch_++;
+}
+
 /**
  * @description: 从buffer pool获取需要的页。
  *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
  *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
  * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
  * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，为空时使用共享的缓冲池
  */
-Page* BufferPoolManager::fetch_page(PageId page_id) {
+Page* BufferPoolManager::fetch_page(PageId page_id, BufferAccessStrategy *strategy) {
     //Todo:
     // 1.     从page_table_中搜寻目标页
     // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
@@ -77,36 +252,217 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
     // 4.     固定目标页，更新pin_count_
     // 5.     返回目标页
 
-    std::scoped_lock lock{latch_};
+    BufferPoolShard *shard = get_shard(page_id);
 
-    if (page_table_.count(page_id)) {
-        frame_id_t frameId = page_table_[page_id];
-        pages_[frameId].pin_count_++;
+    // 命中路径先尝试不加锁地查找并固定，与写者并发时退回到持有分片读锁的查找
+    frame_id_t frameId = optimistic_pin(shard, page_id);
+    if (frameId == INVALID_FRAME_ID) {
+        std::shared_lock lock{shard->latch_};
+        frameId = shard->page_table_.find(page_id);
+        if (frameId != INVALID_FRAME_ID) {
+            // 持有读锁时页表中的帧pin_count_都不小于0
+            pages_[frameId].pin_count_++;
+        }
+    }
+    if (frameId != INVALID_FRAME_ID) {
+        shard->stats_.hits.add();
         // 固定 pin 页面不能被淘汰
-        replacer_->pin(frameId);
+        shard->pin(frameId);
+        // 页面还在被其他线程异步读入时，等待读取完成
+        if (pages_[frameId].io_pending_) {
+            std::shared_lock lock{shard->latch_};
+            auto io = pages_[frameId].io_;
+            lock.unlock();
+            if (io != nullptr) {
+                shard->stats_.io_waits.add();
+                return wait_for_load(shard, frameId, std::move(io));
+            }
+        }
+        return &pages_[frameId];
+    }
+
+    if (disk_manager_->has_async_io()) {
+        return fetch_page_async(shard, page_id, strategy);
+    }
+
+    ShardWriteGuard guard{shard};
+
+    // 释放读锁后其他线程可能已经读入了目标页
+    frameId = shard->page_table_.find(page_id);
+    if (frameId != INVALID_FRAME_ID) {
+        shard->stats_.hits.add();
+        pages_[frameId].pin_count_++;
+        shard->pin(frameId);
         return &pages_[frameId];
     }
 
-    frame_id_t frameId = 0;
-    if (find_victim_page(&frameId)) {
+    // 目标页正在被后台写回线程写回，等写回结束后再从磁盘读取
+    auto write_back_iter = shard->write_backs_.find(page_id);
+    if (write_back_iter != shard->write_backs_.end()) {
+        auto io = write_back_iter->second;
+        guard.unlock();
+        shard->stats_.io_waits.add();
+        io->wait();
+        return fetch_page(page_id, strategy);
+    }
+
+    if (find_victim_page(shard, &frameId, strategy)) {
         // if (pages_[frameId].is_dirty_) {
-            update_page(&pages_[frameId], page_id, frameId);
+            update_page(shard, &pages_[frameId], page_id, frameId);
         // }
     }
     else {
         return nullptr;
     }
+    if (strategy != nullptr) {
+        add_to_ring(shard, frameId, strategy);
+    }
 
-    // 读取目标页数据
+    // 读取目标页数据，持有写锁期间其他线程看不到这个页面
+    shard->stats_.misses.add();
     char* offset = pages_[frameId].get_data();
     disk_manager_->read_page(page_id.fd, page_id.page_no, offset, PAGE_SIZE);
 
-    // 固定目标页
-    replacer_->pin(frameId);
-    pages_[frameId].pin_count_ = 1;
+    // 固定目标页，update_page已经把pin_count_置为1
+    shard->pin(frameId);
     return &pages_[frameId];
 }
 
+/**
+ * @description: 使用异步I/O处理缺页。分片锁只在修改页表时持有：选出淘汰帧后，脏页的写回和目标页的读取
+ *              都提交给disk_manager_的异步I/O后端，在释放分片锁之后等待完成。
+ *              读取完成之前页面已经在页表中，其他线程命中该页面时会等待同一个读请求；
+ *              写回完成之前被淘汰的页面记录在write_backs_中，再次读取该页面的线程会等待写回完成
+ * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
+ * @param {BufferPoolShard*} shard 目标页所在的分片
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，为空时使用共享的缓冲池
+ */
+Page *BufferPoolManager::fetch_page_async(BufferPoolShard *shard, PageId page_id, BufferAccessStrategy *strategy) {
+    while (true) {
+        ShardWriteGuard guard{shard};
+
+        frame_id_t frameId = shard->page_table_.find(page_id);
+        if (frameId != INVALID_FRAME_ID) {
+            shard->stats_.hits.add();
+            pages_[frameId].pin_count_++;
+            shard->pin(frameId);
+            auto io = pages_[frameId].io_;
+            guard.unlock();
+            if (io != nullptr) {
+                shard->stats_.io_waits.add();
+            }
+            return io == nullptr ? &pages_[frameId] : wait_for_load(shard, frameId, std::move(io));
+        }
+
+        // 目标页刚被淘汰且还没有写回完成，等写回结束后再从磁盘读取
+        auto write_back_iter = shard->write_backs_.find(page_id);
+        if (write_back_iter != shard->write_backs_.end()) {
+            auto io = write_back_iter->second;
+            guard.unlock();
+            shard->stats_.io_waits.add();
+            io->wait();
+            continue;
+        }
+
+        if (!find_victim_page(shard, &frameId, strategy)) {
+            return nullptr;
+        }
+        shard->stats_.misses.add();
+        Page *page = &pages_[frameId];
+
+        std::shared_ptr<IoRequest> write_io;
+        if (page->is_dirty()) {
+            PageId old_page_id = page->get_page_id();
+            wait_write_back(shard, old_page_id);
+            write_io = std::make_shared<IoRequest>(IoRequest::Type::WRITE, old_page_id.fd, old_page_id.page_no,
+                                                   page->get_data(), PAGE_SIZE);
+            shard->write_backs_[old_page_id] = write_io;
+            page->is_dirty_ = false;
+            shard->write_epoch_++;
+            if (flush_log_) {
+                flush_log_(page->get_page_lsn());
+            }
+            disk_manager_->submit_io(write_io);
+        }
+
+        if (shard->page_table_.find(page->get_page_id()) == frameId) {
+            shard->page_table_.erase(page->get_page_id());
+        }
+        shard->page_table_.insert(page_id, frameId);
+        page->id_ = page_id;
+        page->pin_count_ = 1;
+        shard->pin(frameId);
+        if (strategy != nullptr) {
+            add_to_ring(shard, frameId, strategy);
+        }
+        auto read_io = std::make_shared<IoRequest>(IoRequest::Type::READ, page_id.fd, page_id.page_no,
+                                                   page->get_data(), PAGE_SIZE);
+        page->io_ = read_io;
+        page->io_pending_ = true;
+        guard.unlock();
+
+        // 帧中的旧数据写回完成后才能读入新页面
+        if (write_io != nullptr) {
+            bool written = write_io->wait();
+            {
+                ShardWriteGuard write_back_guard{shard};
+                auto iter = shard->write_backs_.find(write_io->get_page_id());
+                if (iter != shard->write_backs_.end() && iter->second == write_io) {
+                    shard->write_backs_.erase(iter);
+                }
+            }
+            if (!written) {
+                read_io->complete(-EIO);
+                return wait_for_load(shard, frameId, std::move(read_io));
+            }
+        }
+        disk_manager_->submit_io(read_io);
+        return wait_for_load(shard, frameId, std::move(read_io));
+    }
+}
+
+/**
+ * @description: 等待帧中页面的异步读取完成，调用者已经固定了该帧。
+ *              读取失败时取消固定并抛出异常，最后一个取消固定的线程把帧还给free_list_
+ * @return {Page*} 读取完成的页面
+ * @param {BufferPoolShard*} shard 帧所在的分片
+ * @param {frame_id_t} frame_id 帧号
+ * @param {shared_ptr<IoRequest>} io 页面的读请求
+ */
+Page *BufferPoolManager::wait_for_load(BufferPoolShard *shard, frame_id_t frame_id, std::shared_ptr<IoRequest> io) {
+    bool loaded = io->wait();
+    Page *page = &pages_[frame_id];
+    ShardWriteGuard guard{shard};
+    if (loaded) {
+        if (page->io_ == io) {
+            page->io_.reset();
+            page->io_pending_ = false;
+        }
+        return page;
+    }
+    PageId page_id = page->get_page_id();
+    // 持有写锁时不加锁的命中路径无法成功固定帧，最后一个固定者把pin_count_从1改为-1并回收帧
+    int pin_count = page->pin_count_.load();
+    while (pin_count > 0) {
+        if (pin_count == 1 && page->io_ == io) {
+            if (page->pin_count_.compare_exchange_weak(pin_count, -1)) {
+                shard->page_table_.erase(page_id);
+                page->io_.reset();
+                page->io_pending_ = false;
+                shard->free_list_.push_back(frame_id);
+                break;
+            }
+        } else if (page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+            if (pin_count == 1) {
+                shard->unpin(frame_id);
+            }
+            break;
+        }
+    }
+    throw InternalError("BufferPoolManager::fetch_page: failed to read page " + page_id.toString());
+}
+
 /**
  * @description: 取消固定pin_count>0的在缓冲池中的page
  * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
@@ -124,34 +480,42 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
     // 2.2.1 若自减后等于0，则调用replacer_的Unpin
     // 3 根据参数is_dirty，更改P的is_dirty_
 
-    std::scoped_lock lock{latch_};
+    BufferPoolShard *shard = get_shard(page_id);
 
-    if (page_table_.count(page_id) == 0) {
-        return false;
+    // 调用者持有页面的固定，页面不会被淘汰，不加锁查找页表即可；与写者并发时退回到持有读锁的查找
+    uint64_t version = shard->version_.load();
+    frame_id_t frameId = (version & 1) ? INVALID_FRAME_ID : shard->page_table_.find(page_id);
+    if (frameId == INVALID_FRAME_ID || shard->version_.load() != version) {
+        std::shared_lock lock{shard->latch_};
+        frameId = shard->page_table_.find(page_id);
     }
-
-    frame_id_t frameId = page_table_[page_id];
-    int& pin_count = pages_[frameId].pin_count_;
-    if (!pin_count) {
+    if (frameId == INVALID_FRAME_ID || pages_[frameId].pin_count_ <= 0) {
         return false;
     }
-    else if (pin_count > 0) {
-        pin_count--;
+
+    // 根据参数is_dirty，更改P的is_dirty_
+    // When is_dirty = true，无论 is_dirty 是否为脏，都要更改为脏页
+    // When is_dirty = false，保持页面的原有状态
+    // 如果页面原来为脏页，而参数为false，则会被修改为非脏页，导致无法过测试
+    // 先标记脏页再减少pin_count_，页面可以被淘汰或写回时脏标记一定已经可见
+    if (is_dirty) {
+        pages_[frameId].is_dirty_ = true;
     }
-    if (!pin_count) {
+
+    // 多个线程可能同时unpin同一页，使用CAS保证pin_count_不会减为负数
+    int pin_count = pages_[frameId].pin_count_.load();
+    do {
+        if (pin_count <= 0) {
+            return false;
+        }
+    } while (!pages_[frameId].pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+    if (pin_count == 1) {
         // 如果不擦除，一直调用 unpin 不就会一直 unpin ?
         // page_table_.erase(page_id);
         // 只有 delete page 才需要放回链表中
         // free_list_.push_front(frameId);
         // 固定值为0 无线程使用 可以淘汰，加入 LRU 淘汰队列
-        replacer_->unpin(frameId);
-    }
-    // 根据参数is_dirty，更改P的is_dirty_
-    // When is_dirty = true，无论 is_dirty 是否为脏，都要更改为脏页
-    // When is_dirty = false，保持页面的原有状态
-    // 如果页面原来为脏页，而参数为false，则会被修改为非脏页，导致无法过测试
-    if (is_dirty) {
-        pages_[frameId].is_dirty_ = is_dirty;
+        shard->unpin(frameId);
     }
     return true;
 }
@@ -169,17 +533,20 @@ bool BufferPoolManager::flush_page(PageId page_id) {
     // 2. 无论P是否为脏都将其写回磁盘。
     // 3. 更新P的is_dirty_
 
-    std::scoped_lock lock{latch_};
-    if (!page_table_.count(page_id)) {
+    BufferPoolShard *shard = get_shard(page_id);
+    std::shared_lock lock{shard->latch_};
+    frame_id_t frameId = shard->page_table_.find(page_id);
+    if (frameId == INVALID_FRAME_ID) {
         return false;
     }
 
     // 待加强
-    frame_id_t frameId = page_table_[page_id];
+    // 正在异步读入的页面与磁盘上的内容一致，不需要写回
+    if (pages_[frameId].io_ != nullptr) {
+        return true;
+    }
     if (pages_[frameId].get_page_id().fd == page_id.fd && pages_[frameId].get_page_id().page_no != INVALID_PAGE_ID) {
-        disk_manager_->write_page(page_id.fd, pages_[frameId].get_page_id().page_no, pages_[frameId].get_data(),
-                                  PAGE_SIZE);
-        pages_[frameId].is_dirty_ = false;
+        write_back(shard, &pages_[frameId]);
     }
     return true;
 }
@@ -188,24 +555,53 @@ bool BufferPoolManager::flush_page(PageId page_id) {
  * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
  * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
  * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，为空时使用共享的缓冲池
  */
-Page* BufferPoolManager::new_page(PageId* page_id) {
+Page* BufferPoolManager::new_page(PageId* page_id, BufferAccessStrategy *strategy) {
     // 1.   获得一个可用的frame，若无法获得则返回nullptr
     // 2.   在fd对应的文件分配一个新的page_id
     // 3.   将frame的数据写回磁盘
     // 4.   固定frame，更新pin_count_
     // 5.   返回获得的page
 
-    std::scoped_lock lock{latch_};
-    frame_id_t frameId;
-    if (find_victim_page(&frameId)) {
+    if (num_shards_ == 1) {
+        BufferPoolShard *shard = shards_.front().get();
+        ShardWriteGuard guard{shard};
+        frame_id_t frameId;
+        if (!find_victim_page(shard, &frameId, strategy)) {
+            return nullptr;
+        }
         page_id->page_no = disk_manager_->allocate_page(page_id->fd);
-        update_page(&pages_[frameId], *page_id, frameId);
-        replacer_->pin(frameId);
-        pages_[frameId].pin_count_ = 1;
+        update_page(shard, &pages_[frameId], *page_id, frameId);
+        if (strategy != nullptr) {
+            add_to_ring(shard, frameId, strategy);
+        }
+        shard->pin(frameId);
+        return &pages_[frameId];
+    }
+
+    // 页面所属的分片由page_no决定。先按下一个待分配的页号定位分片并取得可用帧，再分配这个页号，
+    // 分片没有可用帧时不分配页号；其间其他线程分配了这个页号时退还帧，按新的页号重试
+    while (true) {
+        page_id->page_no = disk_manager_->get_fd2pageno(page_id->fd);
+        BufferPoolShard *shard = get_shard(*page_id);
+        ShardWriteGuard guard{shard};
+        frame_id_t frameId;
+        if (!find_victim_page(shard, &frameId, strategy)) {
+            page_id->page_no = INVALID_PAGE_ID;
+            return nullptr;
+        }
+        if (!disk_manager_->allocate_page(page_id->fd, page_id->page_no)) {
+            return_victim_page(shard, frameId);
+            continue;
+        }
+        update_page(shard, &pages_[frameId], *page_id, frameId);
+        if (strategy != nullptr) {
+            add_to_ring(shard, frameId, strategy);
+        }
+        shard->pin(frameId);
         return &pages_[frameId];
     }
-    return nullptr;
 }
 
 /**
@@ -218,19 +614,23 @@ bool BufferPoolManager::delete_page(PageId page_id) {
     // 2.   若目标页的pin_count不为0，则返回false
     // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
 
-    std::scoped_lock lock{latch_};
-    if (!page_table_.count(page_id)) {
+    BufferPoolShard *shard = get_shard(page_id);
+    ShardWriteGuard guard{shard};
+    frame_id_t frameId = shard->page_table_.find(page_id);
+    if (frameId == INVALID_FRAME_ID) {
         return true;
     }
-    frame_id_t frameId = page_table_[page_id];
-    if (pages_[frameId].pin_count_) {
+    // pin_count_从0改为-1后不加锁的命中路径不会再固定该帧
+    if (!claim_frame(frameId)) {
         return false;
     }
-    disk_manager_->write_page(page_id.fd, page_id.page_no, pages_[frameId].get_data(), PAGE_SIZE);
-    page_table_.erase(page_id);
+    write_back(shard, &pages_[frameId]);
+    shard->page_table_.erase(page_id);
+    // 帧回到free_list_，不能再留在replacer中被二次分配
+    shard->pin(frameId);
     pages_[frameId].reset_memory();
     pages_[frameId].is_dirty_ = false;
-    free_list_.push_back(frameId);
+    shard->free_list_.push_back(frameId);
     // disk_manager_->deallocate_page(page_id.page_no);
     return true;
 }
@@ -241,16 +641,39 @@ bool BufferPoolManager::delete_page(PageId page_id) {
  */
 void BufferPoolManager::flush_all_pages(int fd) {
 
-    std::scoped_lock lock{latch_};
+    cancel_prefetch(fd);
 
-    for (auto& entry : page_table_) {
-        PageId pageId = entry.first;
-        if (pageId.fd == fd && pageId.page_no != INVALID_PAGE_ID) {
-            disk_manager_->write_page(pageId.fd, pageId.page_no, pages_[entry.second].get_data(), PAGE_SIZE);
-            pages_[entry.second].is_dirty_ = false;
-            // 避免死锁
-            // flush_page(pageId);
+    // 同一文件相邻的页面分布在不同的分片中，按分片编号顺序锁住所有分片，
+    // 收集fd的全部页面后由disk_manager_合并成连续的向量写
+    std::vector<std::unique_ptr<ShardWriteGuard>> guards;
+    guards.reserve(num_shards_);
+    for (auto& shard : shards_) {
+        guards.emplace_back(std::make_unique<ShardWriteGuard>(shard.get()));
+    }
+
+    std::vector<DiskPage> disk_pages;
+    std::vector<frame_id_t> frames;
+    for (auto& shard : shards_) {
+        // 等待fd已被淘汰、正在异步写回的页面写完
+        for (auto& entry : shard->write_backs_) {
+            if (entry.first.fd == fd) {
+                entry.second->wait();
+            }
         }
+        shard->page_table_.for_each([&](PageId pageId, frame_id_t frameId) {
+            if (pageId.fd == fd && pageId.page_no != INVALID_PAGE_ID && pages_[frameId].io_ == nullptr) {
+                disk_pages.push_back({pageId.page_no, pages_[frameId].get_data()});
+                frames.push_back(frameId);
+            }
+        });
+    }
+    disk_manager_->write_pages(fd, disk_pages);
+
+    for (frame_id_t frameId : frames) {
+        pages_[frameId].is_dirty_ = false;
+    }
+    for (auto& shard : shards_) {
+        shard->write_epoch_++;
     }
 }
 
@@ -260,28 +683,352 @@ void BufferPoolManager::flush_all_pages(int fd) {
  */
 void BufferPoolManager::delete_all_pages(int fd) {
 
-    std::scoped_lock lock{latch_};
+    cancel_prefetch(fd);
 
-    std::vector<PageId> pagesId;
+    for (auto& shard : shards_) {
+        ShardWriteGuard guard{shard.get()};
 
-    // 不能一边读一边对遍历对象做写操作
-    for (auto& entry : page_table_) {
-        PageId pageId = entry.first;
-        if (pageId.fd == fd && pageId.page_no != INVALID_PAGE_ID) {
-            pagesId.emplace_back(pageId);
+        // 等待后台写回线程写完fd的页面，之后文件可能被关闭
+        for (auto& entry : shard->write_backs_) {
+            if (entry.first.fd == fd) {
+                entry.second->wait();
+            }
+        }
+
+        std::vector<std::pair<PageId, frame_id_t>> pagesId;
+
+        // 不能一边读一边对遍历对象做写操作
+        shard->page_table_.for_each([&](PageId pageId, frame_id_t frameId) {
+            if (pageId.fd == fd && pageId.page_no != INVALID_PAGE_ID) {
+                pagesId.emplace_back(pageId, frameId);
+            }
+        });
+        for (auto& [pageId, frameId] : pagesId) {
+            // 帧回到free_list_，从replacer中移除
+            shard->pin(frameId);
+            // assert(pages_[frameId].pin_count_ == 0);
+            // 文件close了写不了
+            // disk_manager_->write_page(pageId.fd, pageId.page_no, pages_[frameId].get_data(), PAGE_SIZE);
+            shard->page_table_.erase(pageId);
+            pages_[frameId].reset_memory();
+            pages_[frameId].is_dirty_ = false;
+            pages_[frameId].pin_count_ = -1;
+            shard->free_list_.push_back(frameId);
         }
     }
-    for (auto& pageId : pagesId) {
-        frame_id_t frameId = page_table_.at(pageId);
-        // 只有当前页面不被使用才能删除
-        replacer_->unpin(frameId);
-        // assert(pages_[frameId].pin_count_ == 0);
-        // 文件close了写不了
-        // disk_manager_->write_page(pageId.fd, pageId.page_no, pages_[frameId].get_data(), PAGE_SIZE);
-        page_table_.erase(pageId);
-        pages_[frameId].reset_memory();
-        pages_[frameId].is_dirty_ = false;
-        pages_[frameId].pin_count_ = 0;
-        free_list_.push_back(frameId);
+}
+/**
+ * @description: 判断目标页是否已经在缓冲池中
+ * @param {PageId} page_id 目标页
+ */
+bool BufferPoolManager::is_resident(PageId page_id) {
+    BufferPoolShard *shard = get_shard(page_id);
+    std::shared_lock lock{shard->latch_};
+    return shard->page_table_.count(page_id) > 0;
+}
+
+/**
+ * @description: 统计每个文件在缓冲池中的页面个数和脏页个数
+ * @return {map<int, FileResidency>} 文件句柄到页面个数的映射，没有页面在缓冲池中的文件不出现
+ */
+std::map<int, FileResidency> BufferPoolManager::get_residency() {
+    std::map<int, FileResidency> residency;
+    for (auto &shard : shards_) {
+        std::shared_lock lock{shard->latch_};
+        shard->page_table_.for_each([&](PageId page_id, frame_id_t frame_id) {
+            auto &file = residency[page_id.fd];
+            file.resident_pages++;
+            if (pages_[frame_id].is_dirty()) {
+                file.dirty_pages++;
+            }
+        });
+    }
+    return residency;
+}
+
+/**
+ * @description: 提交一个预读请求，由后台预读线程异步地把页面读入缓冲池，请求队列已满时直接丢弃
+ * @param {PrefetchRequest} request 预读请求
+ */
+void BufferPoolManager::prefetch_pages(PrefetchRequest request) {
+    {
+        std::scoped_lock lock{prefetch_latch_};
+        if (prefetch_stop_ || prefetch_queue_.size() >= PREFETCH_QUEUE_SIZE) {
+            return;
+        }
+        if (!prefetch_thread_.joinable()) {
+            prefetch_thread_ = std::thread(&BufferPoolManager::prefetch_worker, this);
+        }
+        prefetch_queue_.emplace_back(std::move(request));
     }
-}
\ No newline at end of file
+    prefetch_cv_.notify_all();
+}
+
+/**
+ * @description: 丢弃文件fd尚未处理的预读请求，并等待预读线程处理完fd的当前请求，在关闭文件之前调用
+ * @param {int} fd 文件句柄
+ */
+void BufferPoolManager::cancel_prefetch(int fd) {
+    std::unique_lock lock{prefetch_latch_};
+    for (auto iter = prefetch_queue_.begin(); iter != prefetch_queue_.end();) {
+        if (iter->fd == fd) {
+            iter = prefetch_queue_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    prefetch_cv_.wait(lock, [&] { return prefetch_active_fd_ != fd; });
+}
+
+/**
+ * @description: 后台预读线程，依次处理预读请求，把不在缓冲池中的页面读入请求自带的帧环
+ */
+void BufferPoolManager::prefetch_worker() {
+    while (true) {
+        PrefetchRequest request;
+        {
+            std::unique_lock lock{prefetch_latch_};
+            prefetch_cv_.wait(lock, [&] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+            if (prefetch_stop_) {
+                return;
+            }
+            request = std::move(prefetch_queue_.front());
+            prefetch_queue_.pop_front();
+            prefetch_active_fd_ = request.fd;
+        }
+
+        try {
+            if (!request.next_page_no) {
+                read_ahead_contiguous(request);
+            }
+            page_id_t page_no = request.next_page_no ? request.first_page : INVALID_PAGE_ID;
+            for (int i = 0; i < request.num_pages && page_no != INVALID_PAGE_ID; ++i) {
+                PageId page_id = {request.fd, page_no};
+                Page *page = fetch_page(page_id, request.strategy.get());
+                if (page == nullptr) {
+                    break;
+                }
+                page_no = request.next_page_no(page);
+                unpin_page(page_id, false);
+            }
+        } catch (RMDBError &) {
+            // 预读失败不影响正常的读取
+        }
+
+        {
+            std::scoped_lock lock{prefetch_latch_};
+            prefetch_active_fd_ = -1;
+        }
+        prefetch_cv_.notify_all();
+    }
+}
+
+/**
+ * @description: 处理连续页面的预读请求：不在缓冲池中的页面由一次向量读从磁盘读出，再逐页放入请求的帧环
+ * @param {PrefetchRequest&} request 预读请求，next_page_no为空
+ */
+void BufferPoolManager::read_ahead_contiguous(const PrefetchRequest &request) {
+    std::vector<page_id_t> missing;
+    for (int i = 0; i < request.num_pages; ++i) {
+        if (!is_resident({request.fd, request.first_page + i})) {
+            missing.push_back(request.first_page + i);
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    // 读盘前记录各分片的写回次数，读盘期间有写回的分片不安装预读的页面
+    std::vector<uint64_t> epochs(num_shards_);
+    for (size_t i = 0; i < num_shards_; ++i) {
+        epochs[i] = shards_[i]->write_epoch_;
+    }
+
+    std::vector<char> buffer(missing.size() * PAGE_SIZE);
+    std::vector<DiskPage> disk_pages;
+    disk_pages.reserve(missing.size());
+    for (size_t i = 0; i < missing.size(); ++i) {
+        disk_pages.push_back({missing[i], buffer.data() + i * PAGE_SIZE});
+    }
+    disk_manager_->read_pages(request.fd, disk_pages);
+
+    for (auto &disk_page : disk_pages) {
+        PageId page_id = {request.fd, disk_page.page_no};
+        install_page(page_id, disk_page.data, epochs[PageIdHash()(page_id) % num_shards_], request.strategy.get());
+    }
+}
+
+/**
+ * @description: 把在锁外读出的页面数据放入缓冲池，页面放入后不被固定。
+ *              页面已经在缓冲池中、分片在读盘之后写回过页面、或没有可用帧时放弃
+ * @param {PageId} page_id 页面
+ * @param {char*} data 从磁盘读出的页面数据
+ * @param {uint64_t} write_epoch 读盘之前分片的写回次数
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略
+ */
+void BufferPoolManager::install_page(PageId page_id, const char *data, uint64_t write_epoch,
+                                     BufferAccessStrategy *strategy) {
+    BufferPoolShard *shard = get_shard(page_id);
+    ShardWriteGuard guard{shard};
+    if (shard->write_epoch_ != write_epoch || shard->page_table_.count(page_id) > 0 ||
+        shard->write_backs_.count(page_id) > 0) {
+        return;
+    }
+    frame_id_t frameId;
+    if (!find_victim_page(shard, &frameId, strategy)) {
+        return;
+    }
+    update_page(shard, &pages_[frameId], page_id, frameId);
+    if (strategy != nullptr) {
+        add_to_ring(shard, frameId, strategy);
+    }
+    memcpy(pages_[frameId].get_data(), data, PAGE_SIZE);
+    release_pin(shard, frameId);
+    shard->stats_.prefetched_pages.add();
+}
+
+/**
+ * @description: 唤醒后台写回线程
+ */
+void BufferPoolManager::wake_flusher() {
+    {
+        std::scoped_lock lock{flusher_latch_};
+        flusher_wakeup_ = true;
+    }
+    flusher_cv_.notify_one();
+}
+
+/**
+ * @description: 后台写回线程，每隔BUFFER_FLUSH_INTERVAL_MS或淘汰到脏页时被唤醒，写回脏页
+ */
+void BufferPoolManager::flusher_worker() {
+    while (true) {
+        {
+            std::unique_lock lock{flusher_latch_};
+            flusher_cv_.wait_for(lock, std::chrono::milliseconds(BUFFER_FLUSH_INTERVAL_MS),
+                                 [&] { return flusher_stop_ || flusher_wakeup_; });
+            if (flusher_stop_) {
+                return;
+            }
+            flusher_wakeup_ = false;
+        }
+        try {
+            flush_dirty_pages();
+        } catch (RMDBError &) {
+            // 写回失败的页面重新标记为脏页，由之后的写回或淘汰处理
+        }
+    }
+}
+
+/**
+ * @description: 对干净且可淘汰的帧少于BUFFER_FLUSH_CLEAN_RATIO的分片，写回其中未被固定的脏页补足差额。
+ *              在分片写锁下复制页面数据、清除脏标记并登记到write_backs_，之后在锁外按文件和页号合并成向量写，
+ *              写回期间再次读取这些页面的线程会等待写回完成
+ * @return {size_t} 写回的页面个数
+ */
+size_t BufferPoolManager::flush_dirty_pages() {
+    struct FlushPage {
+        BufferPoolShard *shard;
+        PageId page_id;
+        std::shared_ptr<IoRequest> io;
+    };
+    std::vector<FlushPage> flush_pages;
+    std::vector<std::unique_ptr<char[]>> buffers;
+
+    for (auto &shard : shards_) {
+        ShardWriteGuard guard{shard.get()};
+        size_t num_frames = shard->frame_end_ - shard->frame_begin_;
+        size_t target = static_cast<size_t>(num_frames * BUFFER_FLUSH_CLEAN_RATIO);
+        size_t num_clean = 0;
+        std::vector<frame_id_t> dirty_frames;
+        for (frame_id_t frame_id = shard->frame_begin_; frame_id < shard->frame_end_; frame_id++) {
+            Page *page = &pages_[frame_id];
+            // 空闲帧的pin_count_为-1，可以直接使用，算作干净的帧
+            if (page->pin_count_ < 0) {
+                num_clean++;
+                continue;
+            }
+            // 上一次写回还没有完成的页面留到下一轮，同一页面的两次写回不能同时进行
+            if (page->pin_count_ > 0 || page->io_ != nullptr || shard->write_backs_.count(page->get_page_id()) > 0) {
+                continue;
+            }
+            if (page->is_dirty()) {
+                dirty_frames.push_back(frame_id);
+            } else {
+                num_clean++;
+            }
+        }
+        if (num_clean >= target || dirty_frames.empty()) {
+            continue;
+        }
+
+        size_t num_flush = std::min(target - num_clean, dirty_frames.size());
+        auto buffer = std::make_unique<char[]>(num_flush * PAGE_SIZE);
+        for (size_t i = 0; i < num_flush; i++) {
+            Page *page = &pages_[dirty_frames[i]];
+            PageId page_id = page->get_page_id();
+            char *data = buffer.get() + i * PAGE_SIZE;
+            memcpy(data, page->get_data(), PAGE_SIZE);
+            auto io = std::make_shared<IoRequest>(IoRequest::Type::WRITE, page_id.fd, page_id.page_no, data,
+                                                  PAGE_SIZE);
+            shard->write_backs_[page_id] = io;
+            page->is_dirty_ = false;
+            shard->stats_.flushed_pages.add();
+            flush_pages.push_back({shard.get(), page_id, std::move(io)});
+        }
+        shard->write_epoch_++;
+        buffers.emplace_back(std::move(buffer));
+    }
+    if (flush_pages.empty()) {
+        return 0;
+    }
+
+    // 按文件分组，同一文件内的页面由write_pages按页号合并
+    std::sort(flush_pages.begin(), flush_pages.end(), [](const FlushPage &a, const FlushPage &b) {
+        return a.page_id.fd != b.page_id.fd ? a.page_id.fd < b.page_id.fd : a.page_id.page_no < b.page_id.page_no;
+    });
+    bool failed = false;
+    try {
+        if (flush_log_) {
+            lsn_t max_lsn = INVALID_LSN;
+            for (auto &flush_page : flush_pages) {
+                max_lsn = std::max(max_lsn, *reinterpret_cast<lsn_t *>(flush_page.io->data_ + Page::OFFSET_LSN));
+            }
+            flush_log_(max_lsn);
+        }
+        size_t begin = 0;
+        while (begin < flush_pages.size()) {
+            size_t end = begin;
+            std::vector<DiskPage> disk_pages;
+            while (end < flush_pages.size() && flush_pages[end].page_id.fd == flush_pages[begin].page_id.fd) {
+                disk_pages.push_back({flush_pages[end].page_id.page_no, flush_pages[end].io->data_});
+                end++;
+            }
+            disk_manager_->write_pages(flush_pages[begin].page_id.fd, disk_pages);
+            begin = end;
+        }
+    } catch (RMDBError &) {
+        failed = true;
+    }
+
+    // 先完成所有写回请求再去拿分片锁，持有分片锁等待其中某个请求的线程不会挡住其余请求的完成
+    for (auto &flush_page : flush_pages) {
+        flush_page.io->complete(failed ? -EIO : PAGE_SIZE);
+    }
+    for (auto &flush_page : flush_pages) {
+        std::scoped_lock lock{flush_page.shard->latch_};
+        auto iter = flush_page.shard->write_backs_.find(flush_page.page_id);
+        if (iter != flush_page.shard->write_backs_.end() && iter->second == flush_page.io) {
+            flush_page.shard->write_backs_.erase(iter);
+        }
+        // 写回失败时，仍在缓冲池中的页面重新标记为脏页
+        frame_id_t frameId = flush_page.shard->page_table_.find(flush_page.page_id);
+        if (failed && frameId != INVALID_FRAME_ID) {
+            pages_[frameId].is_dirty_ = true;
+        }
+    }
+    if (failed) {
+        throw InternalError("BufferPoolManager::flush_dirty_pages: failed to write back dirty pages");
+    }
+    return flush_pages.size();
+}
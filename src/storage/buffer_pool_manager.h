@@ -12,49 +12,261 @@ See the Mulan PSL v2 for more details. */
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <list>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "common/stats.h"
 #include "disk_manager.h"
 #include "errors.h"
+#include "frame_arena.h"
 #include "page.h"
+#include "page_table.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
 #include "replacer/lru_replacer.h"
 #include "replacer/replacer.h"
 
+/**
+ * @description: 缓冲池的访问统计。每个分片各自计数，避免所有线程争用同一个缓存行，由BufferPoolManager::get_stats汇总
+ */
+struct BufferPoolStats {
+    StatCounter hits;               // fetch_page时页面已在缓冲池中
+    StatCounter misses;             // fetch_page时需要从磁盘读入页面
+    StatCounter evictions;          // 淘汰了装有页面的帧
+    StatCounter dirty_evictions;    // 淘汰的页面是脏页，需要先写回
+    StatCounter flushed_pages;      // 后台写回线程写回的脏页
+    StatCounter prefetched_pages;   // 预读线程放入缓冲池的页面
+    StatCounter io_waits;           // 等待其他线程正在进行的读入或写回
+
+    void merge(const BufferPoolStats &other) {
+        hits.add(other.hits.get());
+        misses.add(other.misses.get());
+        evictions.add(other.evictions.get());
+        dirty_evictions.add(other.dirty_evictions.get());
+        flushed_pages.add(other.flushed_pages.get());
+        prefetched_pages.add(other.prefetched_pages.get());
+        io_waits.add(other.io_waits.get());
+    }
+};
+
+/**
+ * @description: 一个文件在缓冲池中的页面个数
+ */
+struct FileResidency {
+    size_t resident_pages = 0;
+    size_t dirty_pages = 0;
+};
+
+/**
+ * @description: 缓冲池的一个分片。page_table_、free_list_和replacer_按PageIdHash划分到各个分片中，
+ * 每个分片只管理pages_中属于自己的那一段帧，并由分片自己的读写锁保护
+ */
+struct BufferPoolShard {
+    explicit BufferPoolShard(size_t num_frames) : page_table_(num_frames) {}
+
+    PageTable page_table_;      // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
+    std::list<frame_id_t> free_list_;   // 本分片空闲帧编号的链表
+    std::unique_ptr<Replacer> replacer_;    // 本分片的置换策略，其中存放的是分片内的帧号
+    size_t shard_no_;           // 分片编号
+    frame_id_t frame_begin_;    // 本分片第一个帧的全局帧号
+    frame_id_t frame_end_;      // 本分片最后一个帧的下一个全局帧号
+    std::shared_mutex latch_;   // 命中路径(fetch命中、unpin、flush)持有读锁，修改page_table_的操作持有写锁
+    std::atomic<uint64_t> version_{0};  // 持有写锁期间为奇数，不加锁的命中路径据此校验读到的page_table_
+    std::unordered_map<PageId, std::shared_ptr<IoRequest>, PageIdHash> write_backs_;    // 正在锁外写回的脏页
+    std::atomic<uint64_t> write_epoch_{0};  // 分片内页面每写回一次磁盘加一，预读线程据此判断锁外读到的数据是否已过期
+    BufferPoolStats stats_;     // 本分片的访问统计
+
+    // 以下接口负责全局帧号与分片内帧号的转换
+    inline void pin(frame_id_t frame_id) { replacer_->pin(frame_id - frame_begin_); }
+
+    inline void unpin(frame_id_t frame_id) { replacer_->unpin(frame_id - frame_begin_); }
+
+    inline bool victim(frame_id_t *frame_id) {
+        if (!replacer_->victim(frame_id)) {
+            return false;
+        }
+        *frame_id += frame_begin_;
+        return true;
+    }
+};
+
+/**
+ * @description: 分片写锁。加锁后和解锁前各把分片的version_加一，持有期间version_为奇数。
+ * 不加锁的命中路径在查找page_table_并固定帧之后检查version_没有变化，从而确认没有与写者并发
+ */
+class ShardWriteGuard {
+   public:
+    explicit ShardWriteGuard(BufferPoolShard *shard) : shard_(shard) { lock(); }
+
+    ~ShardWriteGuard() {
+        if (owns_lock_) {
+            unlock();
+        }
+    }
+
+    ShardWriteGuard(const ShardWriteGuard &) = delete;
+    ShardWriteGuard &operator=(const ShardWriteGuard &) = delete;
+
+    void lock() {
+        shard_->latch_.lock();
+        shard_->version_++;
+        owns_lock_ = true;
+    }
+
+    void unlock() {
+        shard_->version_++;
+        shard_->latch_.unlock();
+        owns_lock_ = false;
+    }
+
+   private:
+    BufferPoolShard *shard_;
+    bool owns_lock_ = false;
+};
+
+/**
+ * @description: 缓冲区访问策略。顺序扫描、建索引、批量导入等一次性访问大量页面的操作持有一个私有的帧环，
+ * 缺页时优先复用环中自己读入且已经unpin的帧，而不是从共享的replacer中淘汰页面，避免冲刷缓冲池中的热点页面。
+ * 一个策略对象只能由一个线程使用
+ */
+class BufferAccessStrategy {
+    friend class BufferPoolManager;
+
+   public:
+    /**
+     * @param {size_t} ring_size 环中帧的总数，分片模式下平均分配到各分片
+     */
+    explicit BufferAccessStrategy(size_t ring_size) : ring_size_(ring_size) {}
+
+   private:
+    struct RingSlot {
+        frame_id_t frame_id = INVALID_FRAME_ID;
+        PageId page_id;         // 放入环时该帧装载的页面，用于判断帧是否已被其他页面占用
+    };
+
+    struct Ring {
+        std::vector<RingSlot> slots_;
+        size_t cur_ = 0;        // 下一个要复用的位置
+    };
+
+    // 获取分片对应的环，第一次使用时按分片个数初始化
+    Ring &get_ring(size_t shard_no, size_t num_shards) {
+        if (rings_.empty()) {
+            rings_.resize(num_shards);
+            for (auto &ring : rings_) {
+                ring.slots_.resize(std::max<size_t>(ring_size_ / num_shards, 1));
+            }
+        }
+        return rings_[shard_no];
+    }
+
+    size_t ring_size_;
+    std::vector<Ring> rings_;   // 每个分片一个环
+};
+
+/**
+ * @description: 预读请求。从first_page开始依次读入至多num_pages个页面，next_page_no为空时页号依次加一，
+ * 否则由next_page_no根据当前页面的内容给出下一个页号(例如沿B+树叶子链表)，返回INVALID_PAGE_ID时结束
+ */
+struct PrefetchRequest {
+    int fd;
+    page_id_t first_page;
+    int num_pages;
+    std::function<page_id_t(Page *)> next_page_no;
+    std::shared_ptr<BufferAccessStrategy> strategy;     // 预读页面使用的帧环，只由预读线程使用
+};
+
 class BufferPoolManager {
    private:
     size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
-    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    FrameArena arena_;      // 所有帧的数据区，按页对齐的一块连续内存
+    Page *pages_;           // buffer_pool中的Page对象数组，只保存每帧的元数据，数据指向arena_，大小为pool_size_
+    size_t num_shards_;     // 分片个数，为1时与不分片的缓冲池行为一致
+    std::vector<std::unique_ptr<BufferPoolShard>> shards_;  // 按PageIdHash划分的分片
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+
+    // 后台预读线程，第一次有预读请求时启动
+    std::thread prefetch_thread_;
+    std::mutex prefetch_latch_;
+    std::condition_variable prefetch_cv_;
+    std::deque<PrefetchRequest> prefetch_queue_;
+    int prefetch_active_fd_ = -1;   // 预读线程正在处理的文件
+    bool prefetch_stop_ = false;
+
+    // 后台写回线程，使每个分片中至少有BUFFER_FLUSH_CLEAN_RATIO的帧是干净且可淘汰的，调用start_flusher后才启动
+    std::thread flusher_thread_;
+    std::mutex flusher_latch_;
+    std::condition_variable flusher_cv_;
+    bool flusher_wakeup_ = false;
+    bool flusher_stop_ = false;
+
+    // 写回页面之前调用，保证页面page_lsn及之前的日志已经持久化(WAL)；为空时不保证WAL
+    std::function<void(lsn_t)> flush_log_;
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-        // 为buffer pool分配一块连续的内存空间
-        pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
+    /**
+     * @param {size_t} pool_size 缓冲池的帧数
+     * @param {DiskManager*} disk_manager
+     * @param {size_t} num_shards 分片个数，帧平均分配到各分片中；每个分片至少拥有一个帧
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_shards = 1)
+        : pool_size_(pool_size), arena_(pool_size), num_shards_(num_shards), disk_manager_(disk_manager) {
+        if (num_shards_ == 0 || num_shards_ > pool_size_) {
+            throw InternalError("BufferPoolManager: invalid number of shards " + std::to_string(num_shards_));
         }
-        // 初始化时，所有的page都在free_list_中
+        // 帧的元数据与数据分开存放，数据区是arena_中按页对齐的连续内存，初始为0
+        pages_ = new Page[pool_size_];
         for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+            pages_[i].data_ = arena_.get_frame(static_cast<frame_id_t>(i));
+        }
+        // 初始化时，所有的page都在各自分片的free_list_中
+        for (size_t i = 0; i < num_shards_; ++i) {
+            size_t begin = pool_size_ * i / num_shards_;
+            size_t end = pool_size_ * (i + 1) / num_shards_;
+            auto shard = std::make_unique<BufferPoolShard>(end - begin);
+            shard->replacer_.reset(create_replacer(end - begin));
+            shard->shard_no_ = i;
+            shard->frame_begin_ = static_cast<frame_id_t>(begin);
+            shard->frame_end_ = static_cast<frame_id_t>(end);
+            for (size_t frame_id = begin; frame_id < end; ++frame_id) {
+                shard->free_list_.emplace_back(static_cast<frame_id_t>(frame_id));  // static_cast转换数据类型
+                // 空闲帧的pin_count_为-1，不加锁的命中路径不能固定它
+                pages_[frame_id].pin_count_ = -1;
+            }
+            shards_.emplace_back(std::move(shard));
         }
     }
 
     ~BufferPoolManager() {
+        {
+            std::scoped_lock lock{prefetch_latch_};
+            prefetch_stop_ = true;
+        }
+        prefetch_cv_.notify_all();
+        if (prefetch_thread_.joinable()) {
+            prefetch_thread_.join();
+        }
+        {
+            std::scoped_lock lock{flusher_latch_};
+            flusher_stop_ = true;
+        }
+        flusher_cv_.notify_all();
+        if (flusher_thread_.joinable()) {
+            flusher_thread_.join();
+        }
         delete[] pages_;
-        delete replacer_;
     }
 
     /**
@@ -63,14 +275,53 @@ class BufferPoolManager {
      */
     static void mark_dirty(Page* page) { page->is_dirty_ = true; }
 
+    size_t get_pool_size() const { return pool_size_; }
+
+    size_t get_num_shards() const { return num_shards_; }
+
+    bool is_huge_tlb() const { return arena_.is_huge_tlb(); }
+
+    BufferPoolStats get_stats() const {
+        BufferPoolStats stats;
+        for (auto &shard : shards_) {
+            stats.merge(shard->stats_);
+        }
+        return stats;
+    }
+
+    ReplacerStats get_replacer_stats() const {
+        ReplacerStats stats;
+        for (auto &shard : shards_) {
+            stats.merge(shard->replacer_->get_stats());
+        }
+        return stats;
+    }
+
+    std::map<int, FileResidency> get_residency();
+
+    /**
+     * @description: 设置写回脏页前刷新日志的回调，未设置时不检查WAL
+     * @param {function<void(lsn_t)>} flush_log 保证lsn及之前的日志已经持久化
+     */
+    void set_flush_log(std::function<void(lsn_t)> flush_log) { flush_log_ = std::move(flush_log); }
+
+    /**
+     * @description: 启动后台写回线程。只给长期运行的缓冲池使用，测试和临时的缓冲池不启动，脏页在淘汰或flush时同步写回
+     */
+    void start_flusher() {
+        if (!flusher_thread_.joinable()) {
+            flusher_thread_ = std::thread(&BufferPoolManager::flusher_worker, this);
+        }
+    }
+
    public: 
-    Page* fetch_page(PageId page_id);
+    Page* fetch_page(PageId page_id, BufferAccessStrategy *strategy = nullptr);
 
     bool unpin_page(PageId page_id, bool is_dirty);
 
     bool flush_page(PageId page_id);
 
-    Page* new_page(PageId* page_id);
+    Page* new_page(PageId* page_id, BufferAccessStrategy *strategy = nullptr);
 
     bool delete_page(PageId page_id);
 
@@ -78,8 +329,65 @@ class BufferPoolManager {
 
     void delete_all_pages(int fd);
 
+    bool is_resident(PageId page_id);
+
+    void prefetch_pages(PrefetchRequest request);
+
+    void cancel_prefetch(int fd);
+
+    size_t flush_dirty_pages();
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    void prefetch_worker();
+
+    void flusher_worker();
+
+    void wake_flusher();
+
+    void read_ahead_contiguous(const PrefetchRequest &request);
+
+    /**
+     * @description: 按照REPLACER_TYPE创建置换策略
+     * @param {size_t} num_pages replacer最多需要存储的帧数
+     */
+    static Replacer *create_replacer(size_t num_pages) {
+        // 可以被Replacer改变
+        if (REPLACER_TYPE == "LRU")
+            return new LRUReplacer(num_pages);
+        else if (REPLACER_TYPE == "CLOCK")
+            return new ClockReplacer(num_pages);
+        else if (REPLACER_TYPE == "LRU-K")
+            return new LRUKReplacer(num_pages, LRUK_REPLACER_K);
+        else {
+            throw InternalError("BufferPoolManager: unknown replacer type " + REPLACER_TYPE);
+        }
+    }
+
+    inline BufferPoolShard *get_shard(const PageId &page_id) {
+        return shards_[PageIdHash()(page_id) % num_shards_].get();
+    }
+
+    bool find_victim_page(BufferPoolShard *shard, frame_id_t* frame_id, BufferAccessStrategy *strategy = nullptr);
+
+    void return_victim_page(BufferPoolShard *shard, frame_id_t frame_id);
+
+    void add_to_ring(BufferPoolShard *shard, frame_id_t frame_id, BufferAccessStrategy *strategy);
+
+    void update_page(BufferPoolShard *shard, Page* page, PageId new_page_id, frame_id_t new_frame_id);
+
+    void install_page(PageId page_id, const char *data, uint64_t write_epoch, BufferAccessStrategy *strategy);
+
+    void wait_write_back(BufferPoolShard *shard, PageId page_id);
+
+    void write_back(BufferPoolShard *shard, Page *page);
+
+    frame_id_t optimistic_pin(BufferPoolShard *shard, PageId page_id);
+
+    bool claim_frame(frame_id_t frame_id);
+
+    void release_pin(BufferPoolShard *shard, frame_id_t frame_id);
+
+    Page *fetch_page_async(BufferPoolShard *shard, PageId page_id, BufferAccessStrategy *strategy);
 
-    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
+    Page *wait_for_load(BufferPoolShard *shard, frame_id_t frame_id, std::shared_ptr<IoRequest> io);
 };
\ No newline at end of file
@@ -11,13 +11,19 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <limits.h>    // for IOV_MAX
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
+#include <sys/uio.h>   // for preadv, pwritev
 #include <unistd.h>    // for lseek
 
+#include <algorithm>
+
 #include "defs.h"
 
-DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
+DiskManager::DiskManager() : async_io_(AsyncIO::create(ASYNC_IO_TYPE)) {
+    memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char)));
+}
 
 /**
  * @description: 将数据写入文件的指定磁盘页面中
@@ -32,16 +38,27 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
     // 2.调用write()函数
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
 
+    if (is_compressed(fd)) {
+        int bytes;
+        {
+            LatencyTimer timer{stats_.write_latency};
+            bytes = compressed_files_[fd]->write_page(page_no, offset, num_bytes);
+        }
+        stats_.writes.add();
+        stats_.write_bytes.add(bytes);
+        return;
+    }
+
     // 计算偏移量 字节单位
     off_t off_bytes = static_cast<off_t>(page_no) * PAGE_SIZE;
 
-    // 文件指针移动到要写入的位置
-    if (lseek(fd, off_bytes, SEEK_SET) == -1) {
-        throw InternalError("DiskManager::write_page: Error writing page");
+    // 使用pwrite，多个线程写同一个文件时不共享文件指针
+    ssize_t bytes_written;
+    {
+        LatencyTimer timer{stats_.write_latency};
+        bytes_written = pwrite(fd, offset, num_bytes, off_bytes);
     }
-
-    // 写入数据offset
-    ssize_t bytes_written = write(fd, offset, num_bytes);
+    stats_.writes.add();
     if (bytes_written == -1) {
         throw InternalError("DiskManager::write_page: Error writing to disk");
     }
@@ -49,6 +66,7 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
     if (bytes_written != num_bytes) {
         throw InternalError("DiskManager::write_page Error");
     }
+    stats_.write_bytes.add(bytes_written);
 }
 
 /**
@@ -64,17 +82,27 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
     // 2.调用read()函数
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
 
+    if (is_compressed(fd)) {
+        int bytes;
+        {
+            LatencyTimer timer{stats_.read_latency};
+            bytes = compressed_files_[fd]->read_page(page_no, offset, num_bytes);
+        }
+        stats_.reads.add();
+        stats_.read_bytes.add(bytes);
+        return;
+    }
+
     // 计算偏移量 字节单位
     off_t off_bytes = static_cast<off_t>(page_no) * PAGE_SIZE;
 
-    // 文件指针移动到要读取的位置
-    if (lseek(fd, off_bytes, SEEK_SET) == -1) {
-        throw InternalError("DiskManager::read_page: Error read page");
+    // 使用pread，多个线程读同一个文件时不共享文件指针
+    ssize_t bytes_read;
+    {
+        LatencyTimer timer{stats_.read_latency};
+        bytes_read = pread(fd, offset, num_bytes, off_bytes);
     }
-
-    // 读取数据offset
-
-    ssize_t bytes_read = read(fd, offset, num_bytes);
+    stats_.reads.add();
     if (bytes_read == -1) {
         throw InternalError("DiskManager::read_page: Error read disk");
     }
@@ -82,6 +110,87 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
     if (bytes_read != num_bytes) {
         throw InternalError("DiskManager::write_page Error");
     }
+    stats_.read_bytes.add(bytes_read);
+}
+
+/**
+ * @description: 对同一文件中的多个页面做一次批量读或写。页面按页号排序后，页号相邻的页面合并为一段，
+ * 每段用一次preadv/pwritev完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {vector<DiskPage>&} pages 要读写的页面及其内存地址，会被按页号排序
+ * @param {bool} is_write true为写，false为读
+ */
+void DiskManager::page_vector_io(int fd, std::vector<DiskPage> &pages, bool is_write) {
+    if (is_compressed(fd)) {
+        // 压缩文件的页面在文件中不是定长排列的，逐页读写
+        for (auto &page : pages) {
+            is_write ? write_page(fd, page.page_no, page.data, PAGE_SIZE)
+                     : read_page(fd, page.page_no, page.data, PAGE_SIZE);
+        }
+        return;
+    }
+    std::sort(pages.begin(), pages.end(),
+              [](const DiskPage &a, const DiskPage &b) { return a.page_no < b.page_no; });
+    std::vector<struct iovec> iov;
+    size_t begin = 0;
+    while (begin < pages.size()) {
+        // [begin, end)为一段页号连续的页面
+        size_t end = begin + 1;
+        while (end < pages.size() && end - begin < IOV_MAX && pages[end].page_no == pages[end - 1].page_no + 1) {
+            end++;
+        }
+        iov.clear();
+        for (size_t i = begin; i < end; i++) {
+            iov.push_back({pages[i].data, PAGE_SIZE});
+        }
+        off_t off_bytes = static_cast<off_t>(pages[begin].page_no) * PAGE_SIZE;
+        ssize_t expect = static_cast<ssize_t>(end - begin) * PAGE_SIZE;
+        ssize_t bytes;
+        {
+            LatencyTimer timer{is_write ? stats_.write_latency : stats_.read_latency};
+            bytes = is_write ? pwritev(fd, iov.data(), iov.size(), off_bytes)
+                             : preadv(fd, iov.data(), iov.size(), off_bytes);
+        }
+        (is_write ? stats_.writes : stats_.reads).add();
+        if (bytes != expect) {
+            throw InternalError(is_write ? "DiskManager::write_pages Error" : "DiskManager::read_pages Error");
+        }
+        (is_write ? stats_.write_bytes : stats_.read_bytes).add(bytes);
+        begin = end;
+    }
+}
+
+/**
+ * @description: 批量读取同一文件中的多个页面，可以是多段不连续的页号范围
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {vector<DiskPage>&} pages 要读取的页面号及读入的内存地址
+ */
+void DiskManager::read_pages(int fd, std::vector<DiskPage> &pages) { page_vector_io(fd, pages, false); }
+
+/**
+ * @description: 批量写入同一文件中的多个页面，可以是多段不连续的页号范围
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {vector<DiskPage>&} pages 要写入的页面号及数据地址
+ */
+void DiskManager::write_pages(int fd, std::vector<DiskPage> &pages) { page_vector_io(fd, pages, true); }
+
+/**
+ * @description: 提示内核异步地把文件中连续的若干页面读入page cache，不等待读取完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} first_page 第一个页面的编号
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::readahead(int fd, page_id_t first_page, int num_pages) {
+    // 仅是提示，失败时不影响之后的read_page
+    if (is_compressed(fd)) {
+        auto range = compressed_files_[fd]->extent_range(first_page, num_pages);
+        if (range.second > 0) {
+            posix_fadvise(fd, range.first, range.second, POSIX_FADV_WILLNEED);
+        }
+        return;
+    }
+    posix_fadvise(fd, static_cast<off_t>(first_page) * PAGE_SIZE, static_cast<off_t>(num_pages) * PAGE_SIZE,
+                  POSIX_FADV_WILLNEED);
 }
 
 /**
@@ -95,6 +204,17 @@ page_id_t DiskManager::allocate_page(int fd) {
     return fd2pageno_[fd]++;
 }
 
+/**
+ * @description: 分配指定的页号，只有它恰好是下一个待分配的页号时才成功
+ * @return {bool} 成功分配返回true，其他线程已经分配了这个页号时返回false
+ * @param {int} fd 指定文件的文件句柄
+ * @param {page_id_t} page_no 期望分配的页号，一般由get_fd2pageno得到
+ */
+bool DiskManager::allocate_page(int fd, page_id_t page_no) {
+    assert(fd >= 0 && fd < MAX_FD);
+    return fd2pageno_[fd].compare_exchange_strong(page_no, page_no + 1);
+}
+
 void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
 
 bool DiskManager::is_dir(const std::string& path) {
@@ -158,8 +278,11 @@ void DiskManager::destroy_file(const std::string &path) {
     // 调用unlink()函数
     // 注意不能删除未关闭的文件
 
-    if (path2fd_.count(path)) {
-        throw FileNotClosedError(path);
+    {
+        std::shared_lock lock{path_latch_};
+        if (path2fd_.count(path)) {
+            throw FileNotClosedError(path);
+        }
     }
     if (!is_file(path)) {
         throw FileNotFoundError(path);
@@ -184,6 +307,7 @@ int DiskManager::open_file(const std::string &path) {
     if (!is_file(path)) {
         throw FileNotFoundError(path);
     }
+    std::unique_lock lock{path_latch_};
     if (path2fd_.count(path)) {
         return -1;
         // throw FileExistsError("DiskManager::open_file: File is already open");
@@ -206,12 +330,14 @@ void DiskManager::close_file(int fd) {
     // 调用close()函数
     // 注意不能关闭未打开的文件，并且需要更新文件打开列表
 
+    std::unique_lock lock{path_latch_};
     if (fd2path_.count(fd) == 0) {
         throw FileNotOpenError(fd);
     }
     std::string path = fd2path_[fd];
     path2fd_.erase(path);
     fd2path_.erase(fd);
+    compressed_files_[fd].reset();
     close(fd);
 }
 
@@ -233,10 +359,12 @@ int DiskManager::get_file_size(const std::string &file_name) {
  * @param {int} fd 文件句柄
  */
 std::string DiskManager::get_file_name(int fd) {
-    if (!fd2path_.count(fd)) {
+    std::shared_lock lock{path_latch_};
+    auto iter = fd2path_.find(fd);
+    if (iter == fd2path_.end()) {
         throw FileNotOpenError(fd);
     }
-    return fd2path_[fd];
+    return iter->second;
 }
 
 /**
@@ -245,10 +373,14 @@ std::string DiskManager::get_file_name(int fd) {
  * @param {string} &file_name 文件名
  */
 int DiskManager::get_file_fd(const std::string &file_name) {
-    if (!path2fd_.count(file_name)) {
-        return open_file(file_name);
+    {
+        std::shared_lock lock{path_latch_};
+        auto iter = path2fd_.find(file_name);
+        if (iter != path2fd_.end()) {
+            return iter->second;
+        }
     }
-    return path2fd_[file_name];
+    return open_file(file_name);
 }
 
 
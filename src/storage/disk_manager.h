@@ -14,15 +14,46 @@ See the Mulan PSL v2 for more details. */
 #include <sys/stat.h>  
 #include <unistd.h>    
 
+#include <assert.h>
+
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
+#include "common/stats.h"
+#include "storage/async_io.h"
+#include "storage/page_compression.h"
 #include "errors.h"  
 
+/**
+ * @description: 批量读写时的一个页面：页号及其在内存中的地址
+ */
+struct DiskPage {
+    page_id_t page_no;
+    char *data;
+};
+
+/**
+ * @description: 页面读写的统计。同步读写按系统调用计数并记录延迟，异步读写按提交的请求计数
+ */
+struct DiskStats {
+    StatCounter reads;
+    StatCounter writes;
+    StatCounter read_bytes;
+    StatCounter write_bytes;
+    StatCounter async_reads;
+    StatCounter async_writes;
+    LatencyHistogram read_latency;
+    LatencyHistogram write_latency;
+};
+
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
  */
@@ -36,8 +67,70 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void read_pages(int fd, std::vector<DiskPage> &pages);
+
+    void write_pages(int fd, std::vector<DiskPage> &pages);
+
+    void readahead(int fd, page_id_t first_page, int num_pages);
+
+    /**
+     * @description: 设置异步I/O后端
+     * @param {string&} type "NONE"、"IO_URING"或"THREAD_POOL"
+     */
+    void set_async_io(const std::string &type) { async_io_ = AsyncIO::create(type); }
+
+    bool has_async_io() const { return async_io_ != nullptr; }
+
+    /**
+     * @description: 提交一个异步读写请求，调用者需先确认has_async_io()
+     * @param {shared_ptr<IoRequest>} request 读写请求
+     */
+    void submit_io(std::shared_ptr<IoRequest> request) {
+        bool is_read = request->type_ == IoRequest::Type::READ;
+        if (is_compressed(request->fd_)) {
+            // 压缩文件的页面长度不定，在当前线程中同步地读写
+            ssize_t result = request->num_bytes_;
+            try {
+                if (is_read) {
+                    read_page(request->fd_, request->page_no_, request->data_, request->num_bytes_);
+                } else {
+                    write_page(request->fd_, request->page_no_, request->data_, request->num_bytes_);
+                }
+            } catch (RMDBError &) {
+                result = -EIO;
+            }
+            request->complete(result);
+            return;
+        }
+        (is_read ? stats_.async_reads : stats_.async_writes).add();
+        (is_read ? stats_.read_bytes : stats_.write_bytes).add(request->num_bytes_);
+        async_io_->submit(std::move(request));
+    }
+
+    /**
+     * @description: 把打开的数据文件切换为压缩存放，之后文件中除第0页外的页面都压缩后变长地存放
+     * @param {int} fd 数据文件的文件句柄
+     * @param {string&} map_path 页面映射文件的路径，必须已经存在，新文件的映射文件为空
+     */
+    void set_compressed(int fd, const std::string &map_path) {
+        assert(fd >= 0 && fd < MAX_FD);
+        compressed_files_[fd] = std::make_unique<CompressedFile>(fd, map_path);
+    }
+
+    bool is_compressed(int fd) const { return fd >= 0 && fd < MAX_FD && compressed_files_[fd] != nullptr; }
+
+    /**
+     * @description: 压缩文件中数据页面实际占用的磁盘空间
+     * @param {int} fd 数据文件的文件句柄，须是压缩文件
+     */
+    int64_t get_compressed_size(int fd) { return compressed_files_[fd]->disk_bytes(); }
+
+    const DiskStats &get_stats() const { return stats_; }
+
     page_id_t allocate_page(int fd);
 
+    bool allocate_page(int fd, page_id_t page_no);
+
     void deallocate_page(page_id_t page_id);
 
     /*目录操作*/
@@ -90,10 +183,20 @@ class DiskManager {
     static constexpr int MAX_FD = 8192;
 
    private:
+    void page_vector_io(int fd, std::vector<DiskPage> &pages, bool is_write);
+
+    std::shared_mutex path_latch_;  // 保护path2fd_和fd2path_
     // 文件打开列表，用于记录文件是否被打开
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
+
+    std::unique_ptr<AsyncIO> async_io_;           // 异步I/O后端，为空时只支持同步读写
+
+    DiskStats stats_;                             // 页面读写统计，不加锁地并发更新
+
+    // 压缩存放的文件，在打开和关闭文件时设置，期间其他线程只读取
+    std::unique_ptr<CompressedFile> compressed_files_[MAX_FD];
 };
\ No newline at end of file
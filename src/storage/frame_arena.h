@@ -0,0 +1,67 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/mman.h>
+
+#include "common/config.h"
+#include "errors.h"
+
+/**
+ * @description: 缓冲池所有帧的数据区，一块按页对齐的连续内存，第i帧的数据位于i * PAGE_SIZE处。
+ * 开启BUFFER_POOL_HUGE_PAGES时优先使用MAP_HUGETLB映射大页(需要系统预留大页)，失败时退回普通页并建议内核使用透明大页。
+ * 匿名映射的内存初始为0，物理页在第一次访问时才分配
+ */
+class FrameArena {
+   public:
+    /**
+     * @param {size_t} num_frames 帧的个数
+     */
+    explicit FrameArena(size_t num_frames) : size_(num_frames * PAGE_SIZE) {
+        if (BUFFER_POOL_HUGE_PAGES && size_ >= HUGE_PAGE_SIZE) {
+            mapped_size_ = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            void *data = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                              -1, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<char *>(data);
+                huge_tlb_ = true;
+                return;
+            }
+        }
+        mapped_size_ = size_;
+        void *data = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            throw UnixError();
+        }
+        data_ = static_cast<char *>(data);
+#ifdef MADV_HUGEPAGE
+        if (BUFFER_POOL_HUGE_PAGES) {
+            // 只是建议，内核不支持透明大页时忽略
+            madvise(data_, mapped_size_, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    ~FrameArena() { munmap(data_, mapped_size_); }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    inline char *get_frame(frame_id_t frame_id) { return data_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+    bool is_huge_tlb() const { return huge_tlb_; }
+
+   private:
+    char *data_ = nullptr;
+    size_t size_;           // 帧数据的总字节数
+    size_t mapped_size_;    // 实际映射的字节数，使用MAP_HUGETLB时向上取整到大页
+    bool huge_tlb_ = false;
+};
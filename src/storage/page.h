@@ -10,6 +10,10 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <cstring>
+#include <memory>
+
 #include "common/config.h"
 #include "common/rwlatch.h"
 
@@ -30,14 +34,26 @@ struct PageId {
         return "{fd: " + std::to_string(fd) + " page_no: " + std::to_string(page_no) + "}"; 
     }
 
+    // fd和page_no拼成的64位整数，不同的PageId互不相同
     inline int64_t Get() const {
-        return (static_cast<int64_t>(fd << 16) | page_no);
+        return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(fd)) << 32) |
+                                    static_cast<uint32_t>(page_no));
     }
 };
 
-// PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>
+// PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>、划分缓冲池分片和PageTable。
+// 对PageId::Get()做murmur3的64位混合，每一位输入都会影响所有输出位，page_no超过65535时也不会集中冲突
 struct PageIdHash {
-    size_t operator()(const PageId &x) const { return (x.fd << 16) | x.page_no; }
+    size_t operator()(const PageId &x) const { return mix(static_cast<uint64_t>(x.Get())); }
+
+    static inline uint64_t mix(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
 };
 
 template <>
@@ -45,6 +61,8 @@ struct std::hash<PageId> {
     size_t operator()(const PageId &obj) const { return std::hash<int64_t>()(obj.Get()); }
 };
 
+class IoRequest;
+
 /**
  * @description: Page类声明, Page是RMDB数据块的单位、是负责数据操作Record模块的操作对象，
  * Page对象在磁盘上有文件存储, 若在Buffer中则有帧偏移, 并非特指Buffer或Disk上的数据
@@ -54,7 +72,7 @@ class Page {
 
    public:
     
-    Page() { reset_memory(); }
+    Page() = default;
 
     ~Page() = default;
 
@@ -73,6 +91,9 @@ class Page {
     /** Acquire the page read latch. */
     inline void RLatch() { rwlatch_.RLock(); }
 
+    /** Try to acquire the page read latch without blocking. */
+    inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
     /** Release the page read latch. */
     inline void RUnlatch() { rwlatch_.RUnlock(); }
 
@@ -91,16 +112,23 @@ class Page {
     PageId id_;
 
     /** The actual data that is stored within a page.
-     *  该页面在bufferPool中的偏移地址
+     *  该页面在bufferPool中的偏移地址，指向FrameArena中该帧的数据区，由BufferPoolManager设置
      */
-    char data_[PAGE_SIZE] = {};
+    char *data_ = nullptr;
 
     /** 脏页判断 */
-    bool is_dirty_ = false;
+    std::atomic<bool> is_dirty_ = false;
 
-    /** The pin count of this page. */
-    int pin_count_ = 0;
+    /** The pin count of this page. 命中路径不持有分片写锁，因此使用原子变量。
+     *  空闲帧和正在被淘汰的帧为-1，不加锁的命中路径只能在pin_count_ >= 0时把它加一 */
+    std::atomic<int> pin_count_ = 0;
 
     /** Page latch. */
     ReaderWriterLatch rwlatch_;
+
+    /** 异步读入页面时未完成的读请求，不为空时data_还不可用，由分片锁保护 */
+    std::shared_ptr<IoRequest> io_;
+
+    /** io_是否不为空，供不加锁的命中路径判断是否需要加锁读取io_ */
+    std::atomic<bool> io_pending_ = false;
 };
\ No newline at end of file
@@ -0,0 +1,271 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/page_compression.h"
+
+#include <fcntl.h>     // for open
+#include <string.h>    // for memcpy
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for pread, pwrite
+
+#include <algorithm>
+
+#include "errors.h"
+
+namespace {
+
+inline uint32_t read32(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 写出长度的扩展字节：每个255表示还有后续字节，最后一个字节小于255
+inline bool write_length(int len, char *&op, const char *oend) {
+    for (; len >= 255; len -= 255) {
+        if (op >= oend) return false;
+        *op++ = static_cast<char>(255);
+    }
+    if (op >= oend) return false;
+    *op++ = static_cast<char>(len);
+    return true;
+}
+
+inline bool read_length(int &len, const char *&ip, const char *iend) {
+    unsigned char b;
+    do {
+        if (ip >= iend) return false;
+        b = static_cast<unsigned char>(*ip++);
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+// 写出一个序列，offset为0时是只有字面量的最后一个序列
+bool write_sequence(const char *literals, int lit_len, int offset, int match_len, char *&op, const char *oend) {
+    int match_code = offset == 0 ? 0 : match_len - 4;
+    if (op >= oend) return false;
+    char *token = op++;
+    *token = static_cast<char>((std::min(lit_len, 15) << 4) | std::min(match_code, 15));
+    if (lit_len >= 15 && !write_length(lit_len - 15, op, oend)) return false;
+    if (oend - op < lit_len) return false;
+    memcpy(op, literals, lit_len);
+    op += lit_len;
+    if (offset == 0) return true;
+    if (oend - op < 2) return false;
+    *op++ = static_cast<char>(offset & 0xff);
+    *op++ = static_cast<char>(offset >> 8);
+    return match_code < 15 || write_length(match_code - 15, op, oend);
+}
+
+}  // namespace
+
+int PageCompressor::compress(const char *src, int len, char *dst, int capacity) {
+    // 哈希表记录每个4字节序列最近出现的位置加一，0表示没有出现过
+    uint16_t table[1 << HASH_BITS] = {};
+    char *op = dst;
+    const char *oend = dst + capacity;
+    int anchor = 0;     // 还没有输出的字面量的起点
+    int ip = 0;
+    while (ip + MIN_MATCH <= len) {
+        uint32_t seq = read32(src + ip);
+        uint32_t h = (seq * 2654435761u) >> (32 - HASH_BITS);
+        int ref = static_cast<int>(table[h]) - 1;
+        table[h] = static_cast<uint16_t>(ip + 1);
+        if (ref < 0 || read32(src + ref) != seq) {
+            ip++;
+            continue;
+        }
+        int match_len = MIN_MATCH;
+        while (ip + match_len < len && src[ref + match_len] == src[ip + match_len]) {
+            match_len++;
+        }
+        if (!write_sequence(src + anchor, ip - anchor, ip - ref, match_len, op, oend)) {
+            return 0;
+        }
+        ip += match_len;
+        anchor = ip;
+    }
+    if (!write_sequence(src + anchor, len - anchor, 0, 0, op, oend)) {
+        return 0;
+    }
+    return static_cast<int>(op - dst);
+}
+
+bool PageCompressor::decompress(const char *src, int src_len, char *dst, int len) {
+    const char *ip = src;
+    const char *iend = src + src_len;
+    char *op = dst;
+    char *oend = dst + len;
+    bool last = false;
+    while (ip < iend) {
+        auto token = static_cast<unsigned char>(*ip++);
+        int lit_len = token >> 4;
+        if (lit_len == 15 && !read_length(lit_len, ip, iend)) return false;
+        if (iend - ip < lit_len || oend - op < lit_len) return false;
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == iend) {
+            last = true;    // 最后一个序列没有匹配
+            break;
+        }
+        if (iend - ip < 2) return false;
+        int offset = static_cast<unsigned char>(ip[0]) | (static_cast<unsigned char>(ip[1]) << 8);
+        ip += 2;
+        int match_len = token & 15;
+        if (match_len == 15 && !read_length(match_len, ip, iend)) return false;
+        match_len += MIN_MATCH;
+        if (offset == 0 || offset > op - dst || oend - op < match_len) return false;
+        // 匹配可能与输出重叠(例如连续的'\0')，逐字节复制
+        const char *match = op - offset;
+        for (int i = 0; i < match_len; i++) {
+            op[i] = match[i];
+        }
+        op += match_len;
+    }
+    return last && op == oend;
+}
+
+CompressedFile::CompressedFile(int fd, const std::string &map_path) : fd_(fd) {
+    map_fd_ = open(map_path.c_str(), O_RDWR);
+    if (map_fd_ == -1) {
+        throw FileNotFoundError(map_path);
+    }
+    struct stat st;
+    if (fstat(map_fd_, &st) == -1) {
+        throw UnixError();
+    }
+    extents_.resize(st.st_size / sizeof(PageExtent));
+    if (!extents_.empty() &&
+        pread(map_fd_, extents_.data(), extents_.size() * sizeof(PageExtent), 0) !=
+            static_cast<ssize_t>(extents_.size() * sizeof(PageExtent))) {
+        throw InternalError("CompressedFile: Error reading page map");
+    }
+    // 第0页不压缩，占用文件开头的一个页面
+    end_ = PAGE_SIZE;
+    for (auto &extent : extents_) {
+        end_ = std::max(end_, extent.offset + extent.cap);
+    }
+}
+
+CompressedFile::~CompressedFile() { close(map_fd_); }
+
+int CompressedFile::write_page(page_id_t page_no, const char *data, int num_bytes) {
+    if (page_no == HEADER_PAGE_ID) {
+        ssize_t bytes = pwrite(fd_, data, num_bytes, 0);
+        if (bytes != num_bytes) {
+            throw InternalError("CompressedFile::write_page Error");
+        }
+        return num_bytes;
+    }
+    if (num_bytes != PAGE_SIZE) {
+        throw InternalError("CompressedFile::write_page: Partial page write");
+    }
+    // 压不到一个扇区以下的页面原样存放，读取时不必解压
+    char buf[PAGE_SIZE];
+    int len = PageCompressor::compress(data, PAGE_SIZE, buf, PAGE_SIZE - COMPRESSED_SECTOR_SIZE);
+    const char *image = buf;
+    if (len == 0) {
+        len = PAGE_SIZE;
+        image = data;
+    }
+
+    // 需要换位置时只在锁内分配空间，数据写完后才发布新的存放位置，并发的read_page要么读到旧位置上的旧页面，
+    // 要么读到新位置上完整的新页面
+    PageExtent extent;
+    {
+        std::scoped_lock lock{latch_};
+        if (static_cast<size_t>(page_no) < extents_.size()) {
+            extent = extents_[page_no];
+        } else {
+            extent = PageExtent{0, 0, 0};
+        }
+        if (len > extent.cap) {
+            extent.offset = end_;
+            extent.cap = (len + COMPRESSED_SECTOR_SIZE - 1) / COMPRESSED_SECTOR_SIZE * COMPRESSED_SECTOR_SIZE;
+            end_ += extent.cap;
+        }
+        extent.len = len;
+    }
+    if (pwrite(fd_, image, len, extent.offset) != len) {
+        throw InternalError("CompressedFile::write_page Error");
+    }
+    {
+        std::scoped_lock lock{latch_};
+        if (static_cast<size_t>(page_no) >= extents_.size()) {
+            extents_.resize(page_no + 1, PageExtent{0, 0, 0});
+        }
+        extents_[page_no] = extent;
+    }
+    // 先写数据再写映射，映射项总是指向完整写入的页面
+    if (pwrite(map_fd_, &extent, sizeof(extent), static_cast<off_t>(page_no) * sizeof(PageExtent)) !=
+        static_cast<ssize_t>(sizeof(extent))) {
+        throw InternalError("CompressedFile::write_page: Error writing page map");
+    }
+    return len;
+}
+
+int CompressedFile::read_page(page_id_t page_no, char *data, int num_bytes) {
+    if (page_no == HEADER_PAGE_ID) {
+        ssize_t bytes = pread(fd_, data, num_bytes, 0);
+        if (bytes != num_bytes) {
+            throw InternalError("CompressedFile::read_page Error");
+        }
+        return num_bytes;
+    }
+    PageExtent extent{0, 0, 0};
+    {
+        std::scoped_lock lock{latch_};
+        if (static_cast<size_t>(page_no) < extents_.size()) {
+            extent = extents_[page_no];
+        }
+    }
+    if (extent.len == 0) {
+        throw InternalError("CompressedFile::read_page: Page not written");
+    }
+    // 只读取页面的一部分时先解压到临时页面
+    char buf[PAGE_SIZE];
+    char page[PAGE_SIZE];
+    char *out = num_bytes == PAGE_SIZE ? data : page;
+    if (pread(fd_, extent.len == PAGE_SIZE ? out : buf, extent.len, extent.offset) != extent.len) {
+        throw InternalError("CompressedFile::read_page Error");
+    }
+    if (extent.len != PAGE_SIZE && !PageCompressor::decompress(buf, extent.len, out, PAGE_SIZE)) {
+        throw InternalError("CompressedFile::read_page: Corrupted page");
+    }
+    if (out != data) {
+        memcpy(data, page, num_bytes);
+    }
+    return extent.len;
+}
+
+std::pair<int64_t, int64_t> CompressedFile::extent_range(page_id_t first_page, int num_pages) {
+    std::scoped_lock lock{latch_};
+    int64_t begin = INT64_MAX;
+    int64_t end = 0;
+    for (page_id_t page_no = std::max(first_page, 1);
+         page_no < first_page + num_pages && static_cast<size_t>(page_no) < extents_.size(); page_no++) {
+        if (extents_[page_no].len > 0) {
+            begin = std::min(begin, extents_[page_no].offset);
+            end = std::max(end, extents_[page_no].offset + extents_[page_no].len);
+        }
+    }
+    return end == 0 ? std::make_pair<int64_t, int64_t>(0, 0) : std::make_pair(begin, end - begin);
+}
+
+int64_t CompressedFile::disk_bytes() {
+    std::scoped_lock lock{latch_};
+    int64_t bytes = 0;
+    for (auto &extent : extents_) {
+        bytes += extent.cap;
+    }
+    return bytes;
+}
@@ -0,0 +1,107 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 页面压缩算法，LZ77的一种简单实现，块格式与LZ4相同：
+ * 压缩数据由若干序列组成，每个序列是1字节的token(高4位为字面量长度，低4位为匹配长度减4)、
+ * 长度不小于15时的扩展字节、字面量、2字节的匹配偏移和匹配长度的扩展字节，最后一个序列只有字面量。
+ * 表页面中定长字符串末尾的'\0'、空闲slot和重复的列值都能压缩掉
+ */
+class PageCompressor {
+   public:
+    /**
+     * @description: 压缩一块数据
+     * @return {int} 压缩后的长度，超过capacity时返回0
+     * @param {char*} src 原始数据
+     * @param {int} len 原始数据的长度，不超过65535
+     * @param {char*} dst 存放压缩后的数据
+     * @param {int} capacity dst的大小
+     */
+    static int compress(const char *src, int len, char *dst, int capacity);
+
+    /**
+     * @description: 解压一块数据
+     * @return {bool} 数据完整且解压后的长度恰为len时返回true
+     * @param {char*} src 压缩后的数据
+     * @param {int} src_len 压缩后的长度
+     * @param {char*} dst 存放解压后的数据
+     * @param {int} len 解压后的长度
+     */
+    static bool decompress(const char *src, int src_len, char *dst, int len);
+
+   private:
+    static constexpr int MIN_MATCH = 4;
+    static constexpr int HASH_BITS = 12;
+};
+
+/* 压缩文件中一个页面的存放位置，len为0表示页面还没有写过 */
+struct PageExtent {
+    int64_t offset;     // 在数据文件中的偏移量
+    int32_t len;        // 压缩后的长度，等于PAGE_SIZE时页面没有压缩
+    int32_t cap;        // 占用的空间，按COMPRESSED_SECTOR_SIZE向上取整，重写时不超过cap就原地覆盖
+};
+
+/**
+ * @description: 压缩存放的数据文件。第0页(文件头)仍然不压缩地存放在文件开头，其余页面压缩后变长地存放在
+ * 文件头之后，页号到存放位置的映射保存在与数据文件同名、后缀为COMPRESSED_PAGE_MAP_SUFFIX的页面映射文件中。
+ * 重写的页面压缩后仍放得下时原地覆盖，否则追加到文件末尾，原来的空间不再使用。
+ * 映射文件每次写页面后立即更新对应的项；追加的页面先写数据再写映射，不会因为崩溃丢失旧的页面
+ */
+class CompressedFile {
+   public:
+    /**
+     * @param {int} fd 数据文件的文件句柄
+     * @param {string&} map_path 页面映射文件的路径
+     */
+    CompressedFile(int fd, const std::string &map_path);
+
+    ~CompressedFile();
+
+    CompressedFile(const CompressedFile &) = delete;
+    CompressedFile &operator=(const CompressedFile &) = delete;
+
+    /**
+     * @description: 压缩并写入一个页面
+     * @return {int} 实际写入的字节数
+     */
+    int write_page(page_id_t page_no, const char *data, int num_bytes);
+
+    /**
+     * @description: 读取并解压一个页面
+     * @return {int} 实际读取的字节数
+     */
+    int read_page(page_id_t page_no, char *data, int num_bytes);
+
+    /**
+     * @description: 页号连续的若干页面在文件中占用的范围，用于预读提示
+     * @return {pair<int64_t, int64_t>} 起始偏移量和长度，页面都没有写过时长度为0
+     */
+    std::pair<int64_t, int64_t> extent_range(page_id_t first_page, int num_pages);
+
+    // 数据页面实际占用的磁盘空间，不含文件头和不再使用的空间
+    int64_t disk_bytes();
+
+   private:
+    int fd_;
+    int map_fd_;
+    std::mutex latch_;                  // 保护extents_和end_
+    std::vector<PageExtent> extents_;   // 按页号索引的存放位置
+    int64_t end_;                       // 文件末尾，新的存放位置从这里分配
+};
@@ -0,0 +1,162 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "page.h"
+
+/**
+ * @description: 缓冲池分片的页表，PageId到帧号的开放寻址哈希表(线性探测，删除时向前移动后继元素，不使用墓碑)。
+ * 容量是最大元素个数的两倍以上并取2的幂，装载因子不超过0.5。
+ * 修改操作需要持有分片写锁；find可以不加锁与修改并发执行，此时可能读到错误的结果，
+ * 调用者需要用分片的版本号校验(见BufferPoolShard::version_)
+ */
+class PageTable {
+   public:
+    /**
+     * @param {size_t} max_entries 表中最多同时存放的元素个数，即分片的帧数
+     */
+    explicit PageTable(size_t max_entries) {
+        int bits = 1;
+        while ((static_cast<size_t>(1) << bits) < max_entries * 2) {
+            bits++;
+        }
+        capacity_ = static_cast<size_t>(1) << bits;
+        mask_ = capacity_ - 1;
+        shift_ = 64 - bits;
+        slots_ = std::make_unique<Slot[]>(capacity_);
+    }
+
+    /**
+     * @description: 查找页面所在的帧
+     * @return {frame_id_t} 帧号，页面不在表中时返回INVALID_FRAME_ID
+     * @param {PageId&} page_id 目标页面
+     */
+    frame_id_t find(const PageId &page_id) const {
+        uint64_t key = make_key(page_id);
+        for (size_t i = home_of(key), n = 0; n < capacity_; i = (i + 1) & mask_, n++) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_acquire);
+            if (slot_key == key) {
+                return slots_[i].frame_id_.load(std::memory_order_relaxed);
+            }
+            if (slot_key == EMPTY_KEY) {
+                break;
+            }
+        }
+        return INVALID_FRAME_ID;
+    }
+
+    size_t count(const PageId &page_id) const { return find(page_id) == INVALID_FRAME_ID ? 0 : 1; }
+
+    /**
+     * @description: 插入或更新页面所在的帧
+     * @param {PageId&} page_id 页面
+     * @param {frame_id_t} frame_id 帧号
+     */
+    void insert(const PageId &page_id, frame_id_t frame_id) {
+        uint64_t key = make_key(page_id);
+        size_t i = home_of(key);
+        while (true) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_relaxed);
+            if (slot_key == key) {
+                slots_[i].frame_id_.store(frame_id, std::memory_order_relaxed);
+                return;
+            }
+            if (slot_key == EMPTY_KEY) {
+                // 先写帧号再发布键，不加锁的读者看到键时帧号已经有效
+                slots_[i].frame_id_.store(frame_id, std::memory_order_relaxed);
+                slots_[i].key_.store(key, std::memory_order_release);
+                size_++;
+                return;
+            }
+            i = (i + 1) & mask_;
+        }
+    }
+
+    /**
+     * @description: 删除页面，之后探测序列中的元素向前移动填补空位
+     * @return {bool} 页面是否在表中
+     * @param {PageId&} page_id 页面
+     */
+    bool erase(const PageId &page_id) {
+        uint64_t key = make_key(page_id);
+        size_t i = home_of(key);
+        while (true) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_relaxed);
+            if (slot_key == key) {
+                break;
+            }
+            if (slot_key == EMPTY_KEY) {
+                return false;
+            }
+            i = (i + 1) & mask_;
+        }
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & mask_;
+            uint64_t slot_key = slots_[j].key_.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) {
+                break;
+            }
+            // j处元素的初始位置不在(i, j]之间时，移动到空位i不会破坏它的探测序列
+            size_t home = home_of(slot_key);
+            if (((j - home) & mask_) >= ((j - i) & mask_)) {
+                slots_[i].frame_id_.store(slots_[j].frame_id_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                slots_[i].key_.store(slot_key, std::memory_order_release);
+                i = j;
+            }
+        }
+        slots_[i].key_.store(EMPTY_KEY, std::memory_order_release);
+        size_--;
+        return true;
+    }
+
+    /**
+     * @description: 遍历表中的所有元素，遍历期间不能修改页表
+     * @param {F&&} f 对每个元素调用f(PageId, frame_id_t)
+     */
+    template <typename F>
+    void for_each(F &&f) const {
+        for (size_t i = 0; i < capacity_; i++) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_relaxed);
+            if (slot_key != EMPTY_KEY) {
+                f(PageId{static_cast<int>(slot_key >> 32), static_cast<page_id_t>(slot_key & 0xffffffff)},
+                  slots_[i].frame_id_.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    size_t size() const { return size_; }
+
+   private:
+    // {fd: -1, page_no: -1}不是合法的页面，用作空槽的键
+    static constexpr uint64_t EMPTY_KEY = ~static_cast<uint64_t>(0);
+
+    struct Slot {
+        std::atomic<uint64_t> key_{EMPTY_KEY};
+        std::atomic<frame_id_t> frame_id_{INVALID_FRAME_ID};
+    };
+
+    static inline uint64_t make_key(const PageId &page_id) { return static_cast<uint64_t>(page_id.Get()); }
+
+    // 分片由哈希值的低位决定，这里使用高位，避免同一分片的页面集中在表的一部分
+    inline size_t home_of(uint64_t key) const { return static_cast<size_t>(PageIdHash::mix(key) >> shift_); }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t capacity_;
+    size_t mask_;
+    int shift_;
+    size_t size_ = 0;
+};
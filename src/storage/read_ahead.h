@@ -0,0 +1,81 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "buffer_pool_manager.h"
+
+/**
+ * @description: 顺序访问检测器。扫描每访问一个新页面调用一次access，检测到顺序访问后，
+ * 通过缓冲池的后台预读线程提前把之后的window个页面读入缓冲池，预读的页面放在私有的帧环中，不冲刷缓冲池
+ */
+class ReadAhead {
+   private:
+    BufferPoolManager *bpm_;
+    int fd_;
+    int window_;                    // 预读窗口，为0时不预读
+    std::shared_ptr<BufferAccessStrategy> strategy_;    // 预读页面使用的帧环
+    page_id_t last_page_ = INVALID_PAGE_ID;     // 上一次访问的页面
+    page_id_t prefetched_until_ = INVALID_PAGE_ID;  // 已经提交预读的页面范围的右端(不包含)
+    int num_accesses_ = 0;          // 沿链表访问的页面数
+
+   public:
+    ReadAhead(BufferPoolManager *bpm, int fd, int window = READ_AHEAD_PAGES)
+        : bpm_(bpm), fd_(fd), window_(window) {
+        if (window_ > 0) {
+            // 预读领先扫描至多一个窗口，帧环留出两个窗口，保证被复用的帧已经被扫描用完
+            strategy_ = std::make_shared<BufferAccessStrategy>(2 * window_);
+        }
+    }
+
+    /**
+     * @description: 访问页号连续的文件(如表的数据文件)中的一个页面，连续两次访问相邻页面后开始预读
+     * @param {page_id_t} page_no 访问的页面
+     * @param {page_id_t} num_pages 文件的页面个数，预读不会越过文件末尾
+     */
+    void access(page_id_t page_no, page_id_t num_pages) {
+        if (window_ <= 0) {
+            return;
+        }
+        bool sequential = last_page_ != INVALID_PAGE_ID && page_no == last_page_ + 1;
+        last_page_ = page_no;
+        if (!sequential) {
+            prefetched_until_ = page_no + 1;
+            return;
+        }
+        // 扫描进入已预读范围的后半段时提交下一批
+        if (page_no + window_ / 2 < prefetched_until_) {
+            return;
+        }
+        page_id_t first = std::max(prefetched_until_, page_no + 1);
+        page_id_t last = std::min(page_no + 1 + window_, num_pages);
+        if (first < last) {
+            bpm_->prefetch_pages({fd_, first, last - first, nullptr, strategy_});
+            prefetched_until_ = last;
+        }
+    }
+
+    /**
+     * @description: 沿链表访问一个页面(如B+树的叶子结点)，每访问半个窗口的页面提交一次沿链表的预读
+     * @param {page_id_t} page_no 访问的页面
+     * @param {function} next_page_no 根据页面内容返回链表中下一个页号，没有时返回INVALID_PAGE_ID
+     */
+    void access_chain(page_id_t page_no, const std::function<page_id_t(Page *)> &next_page_no) {
+        if (window_ <= 0) {
+            return;
+        }
+        if (num_accesses_++ % std::max(window_ / 2, 1) == 0) {
+            bpm_->prefetch_pages({fd_, page_no, window_, next_page_no, strategy_});
+        }
+    }
+};
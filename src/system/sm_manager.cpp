@@ -13,7 +13,14 @@ See the Mulan PSL v2 for more details. */
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <strings.h>
+
+#include <cerrno>
+#include <climits>
 #include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
 
 #include "index/ix.h"
 #include "record/rm.h"
@@ -113,7 +120,7 @@ void SmManager::open_db(const std::string& db_name) {
     for (auto& tab : db_.tabs_) {
         const std::string& tab_name = tab.first;
         auto& tab_meta = tab.second;
-        fhs_[tab_name] = rm_manager_->open_file(tab_name);
+        fhs_[tab_name] = rm_manager_->open_file(tab_name, zone_map_cols(tab_meta));
         // 打开表上的所有索引并读入
         for (auto& index : tab_meta.indexes) {
             const std::string index_name = ix_manager_->get_index_name(tab_name, index.cols);
@@ -122,6 +129,19 @@ void SmManager::open_db(const std::string& db_name) {
     }
 }
 
+/**
+ * @description: 表中建立区域映射的列，即所有定长的数值和时间类型的列
+ */
+std::vector<RmZoneCol> SmManager::zone_map_cols(const TabMeta& tab) {
+    std::vector<RmZoneCol> cols;
+    for (auto& col : tab.cols) {
+        if (RmZoneMap::is_supported(col.type)) {
+            cols.push_back({col.offset, col.type});
+        }
+    }
+    return cols;
+}
+
 /**
  * @description: 把数据库相关的元数据刷入磁盘中
  */
@@ -213,6 +233,80 @@ void SmManager::show_index(const std::string& tab_name, Context* context) {
     outfile.close();
 }
 
+/**
+ * @description: 显示缓冲池、置换策略和磁盘读写的统计，以及每个文件在缓冲池中的页面个数
+ * @param {Context*} context
+ */
+void SmManager::show_buffer_stats(Context* context) {
+    BufferPoolStats buffer = buffer_pool_manager_->get_stats();
+    ReplacerStats replacer = buffer_pool_manager_->get_replacer_stats();
+    const DiskStats& disk = disk_manager_->get_stats();
+    auto residency = buffer_pool_manager_->get_residency();
+
+    size_t resident_pages = 0;
+    size_t dirty_pages = 0;
+    for (auto& entry : residency) {
+        resident_pages += entry.second.resident_pages;
+        dirty_pages += entry.second.dirty_pages;
+    }
+    uint64_t fetches = buffer.hits.get() + buffer.misses.get();
+    std::stringstream hit_ratio;
+    hit_ratio << std::fixed << std::setprecision(4)
+              << (fetches == 0 ? 0.0 : static_cast<double>(buffer.hits.get()) / fetches);
+
+    std::vector<std::vector<std::string>> rows = {
+        {"buffer", "pool_size", std::to_string(buffer_pool_manager_->get_pool_size())},
+        {"buffer", "shards", std::to_string(buffer_pool_manager_->get_num_shards())},
+        {"buffer", "hits", std::to_string(buffer.hits.get())},
+        {"buffer", "misses", std::to_string(buffer.misses.get())},
+        {"buffer", "hit_ratio", hit_ratio.str()},
+        {"buffer", "evictions", std::to_string(buffer.evictions.get())},
+        {"buffer", "dirty_evictions", std::to_string(buffer.dirty_evictions.get())},
+        {"buffer", "flushed_pages", std::to_string(buffer.flushed_pages.get())},
+        {"buffer", "prefetched_pages", std::to_string(buffer.prefetched_pages.get())},
+        {"buffer", "io_waits", std::to_string(buffer.io_waits.get())},
+        {"buffer", "resident_pages", std::to_string(resident_pages)},
+        {"buffer", "dirty_pages", std::to_string(dirty_pages)},
+        {"replacer", "type", REPLACER_TYPE},
+        {"replacer", "victims", std::to_string(replacer.victims.get())},
+        {"replacer", "pins", std::to_string(replacer.pins.get())},
+        {"replacer", "unpins", std::to_string(replacer.unpins.get())},
+        {"disk", "reads", std::to_string(disk.reads.get())},
+        {"disk", "read_bytes", std::to_string(disk.read_bytes.get())},
+        {"disk", "read_avg_ns", std::to_string(disk.read_latency.average())},
+        {"disk", "read_p50_ns", std::to_string(disk.read_latency.percentile(0.5))},
+        {"disk", "read_p99_ns", std::to_string(disk.read_latency.percentile(0.99))},
+        {"disk", "writes", std::to_string(disk.writes.get())},
+        {"disk", "write_bytes", std::to_string(disk.write_bytes.get())},
+        {"disk", "write_avg_ns", std::to_string(disk.write_latency.average())},
+        {"disk", "write_p50_ns", std::to_string(disk.write_latency.percentile(0.5))},
+        {"disk", "write_p99_ns", std::to_string(disk.write_latency.percentile(0.99))},
+        {"disk", "async_reads", std::to_string(disk.async_reads.get())},
+        {"disk", "async_writes", std::to_string(disk.async_writes.get())},
+    };
+    for (auto& entry : residency) {
+        std::string file_name;
+        try {
+            file_name = disk_manager_->get_file_name(entry.first);
+        } catch (FileNotOpenError&) {
+            // 文件已关闭但页面还没有被淘汰
+            file_name = "fd " + std::to_string(entry.first);
+        }
+        rows.push_back({file_name, "resident_pages", std::to_string(entry.second.resident_pages)});
+        rows.push_back({file_name, "dirty_pages", std::to_string(entry.second.dirty_pages)});
+    }
+
+    std::vector<std::string> captions = {"Component", "Statistic", "Value"};
+    RecordPrinter printer(captions.size());
+    printer.print_separator(context);
+    printer.print_record(captions, context);
+    printer.print_separator(context);
+    for (auto& row : rows) {
+        printer.print_record(row, context);
+    }
+    printer.print_separator(context);
+}
+
 /**
  * @description: 显示表的元数据
  * @param {string&} tab_name 表名称
@@ -241,8 +335,11 @@ void SmManager::desc_table(const std::string& tab_name, Context* context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<ColDef>&} col_defs 表的字段
  * @param {Context*} context 
+ * @param {RmPageFormat} format 数据文件的页面格式，变长格式中字符串字段按实际长度存放，PAX格式中每一列单独存放
+ * @param {bool} compressed 数据页面是否压缩存放
  */
-void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context) {
+void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                             RmPageFormat format, bool compressed) {
     if (db_.is_table(tab_name)) {
         throw TableExistsError(tab_name);
     }
@@ -250,7 +347,11 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     int curr_offset = 0;
     TabMeta tab;
     tab.name = tab_name;
+    std::vector<RmField> fields;
     for (auto &col_def : col_defs) {
+        if ((format == RM_FORMAT_SLOTTED && col_def.type == TYPE_STRING) || format == RM_FORMAT_PAX) {
+            fields.push_back({curr_offset, col_def.len});
+        }
         ColMeta col = {.tab_name = tab_name,
                        .name = col_def.name,
                        .type = col_def.type,
@@ -262,10 +363,10 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     }
     // Create & open record file
     int record_size = curr_offset;  // record_size就是col meta所占的大小（表的元数据也是以记录的形式进行存储的）
-    rm_manager_->create_file(tab_name, record_size);
+    rm_manager_->create_file(tab_name, record_size, format, fields, compressed);
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
-    fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
+    fhs_.emplace(tab_name, rm_manager_->open_file(tab_name, zone_map_cols(tab)));
 
     // 申请表级写锁
     context->lock_mgr_->lock_exclusive_on_table(context->txn_, fhs_[tab_name]->GetFd());
@@ -315,8 +416,10 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {int} fill_percent 自底向上建树时结点的填充率
  */
-void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                             int fill_percent) {
     // 先获取表元数据
     TabMeta& tab = db_.get_table(tab_name);
     if (tab.is_index(col_names)) {
@@ -333,30 +436,58 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
         tot_col_len += cols.back().len;
     }
 
-    // 进行唯一性检查
-    // 用不了哈希，试插法
     auto fh = fhs_[tab_name].get();
     ix_manager_->create_index(tab_name, cols);
     auto ih = ix_manager_->open_index(tab_name, cols);
-    int idx = -1;
-    for (RmScan rmScan(fh); !rmScan.is_end(); rmScan.next()) {
-        auto rec = fh->get_record(rmScan.rid(), context);
-        char* insert_data = new char[tot_col_len + 4];
-        memcpy(insert_data + tot_col_len, &idx, 4);
-        int offset = 0;
-        for (auto& col : cols) {
-            memcpy(insert_data + offset, rec->data + col.offset, col.len);
-            offset += col.len;
+
+    // 抽取所有记录的键，排序后在有序的键中检查唯一性，再自底向上建树；键超过内存上限时外部排序
+    std::vector<ColType> col_types;
+    std::vector<int> col_lens;
+    for (auto& col : cols) {
+        col_types.push_back(col.type);
+        col_lens.push_back(col.len);
+    }
+    IxSorter sorter(disk_manager_, ix_manager_->get_index_name(tab_name, col_names) + IX_SORT_RUN_SUFFIX, col_types,
+                    col_lens);
+    {
+        // 读全表时使用私有的帧环，避免冲刷缓冲池；表级读锁已覆盖所有记录，按页扫描不逐条申请行锁
+        BufferAccessStrategy strategy(BUFFER_SCAN_RING_SIZE);
+        std::vector<char> key(tot_col_len);
+        for (RmScan scan(fh, &strategy, READ_AHEAD_PAGES, true); !scan.is_end(); scan.next()) {
+            int offset = 0;
+            for (auto& col : cols) {
+                memcpy(key.data() + offset, scan.tuple() + col.offset, col.len);
+                offset += col.len;
+            }
+            sorter.add(key.data(), scan.rid());
         }
-        std::vector<Rid> rid;
-        if (ih->get_value(insert_data, &rid, context->txn_)) {
+    }
+    sorter.finish();
+    bool unique = true;
+    {
+        auto loader = ih->begin_bulk_load(sorter.size(), fill_percent);
+        if (loader == nullptr) {
+            // 新建的索引应当为空，不为空时说明索引文件已被其他索引占用
             ix_manager_->close_index(ih.get());
             ix_manager_->destroy_index(ih.get(), tab_name, col_names);
-            throw InternalError("Non-Unique Index!");
+            throw InternalError("SmManager::create_index: new index is not empty");
+        }
+        std::vector<char> prev(tot_col_len);
+        const char* key;
+        Rid rid;
+        for (size_t i = 0; sorter.next(key, rid); i++) {
+            if (i > 0 && ix_compare_keys(prev.data(), key, col_types, col_lens) == 0) {
+                unique = false;
+                break;
+            }
+            memcpy(prev.data(), key, tot_col_len);
+            loader->append(key, rid);
         }
-        // assert(ih->insert_entry(insert_data, rmScan.rid(), context->txn_) > 0);
-        ih->insert_entry(insert_data, rmScan.rid(), context->txn_);
-        delete[] insert_data;
+    }
+    if (!unique) {
+        ix_manager_->close_index(ih.get());
+        ix_manager_->destroy_index(ih.get(), tab_name, col_names);
+        throw InternalError("Non-Unique Index!");
     }
 
     auto index_name = ix_manager_->get_index_name(tab_name, col_names);
@@ -439,3 +570,252 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<ColMet
     // 更新元数据
     flush_meta();
 }
+
+/**
+ * @description: 按CSV格式拆分一行，支持用双引号包围含逗号的字段，字段内的两个双引号表示一个双引号
+ * @param {string&} line 去掉换行符的一行
+ * @param {vector<string>&} fields 拆分出的字段
+ */
+static void split_csv_line(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quoted) {
+            if (c != '"') {
+                field += c;
+            } else if (i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                i++;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back(std::move(field));
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.emplace_back(std::move(field));
+}
+
+/**
+ * @description: 把CSV中的一个字段转换为列的存储格式
+ * @param {string&} field 字段的文本
+ * @param {ColMeta&} col 字段对应的列
+ * @param {char*} dest 记录中该列的位置
+ * @return {bool} 文本不是合法的该类型的值时返回false
+ */
+static bool parse_csv_field(const std::string& field, const ColMeta& col, char* dest) {
+    const char* begin = field.c_str();
+    char* end = nullptr;
+    errno = 0;
+    switch (col.type) {
+        case TYPE_INT: {
+            long val = strtol(begin, &end, 10);
+            if (end == begin || *end != '\0' || errno != 0 || val < INT_MIN || val > INT_MAX) {
+                return false;
+            }
+            *(int*)dest = static_cast<int>(val);
+            return true;
+        }
+        case TYPE_BIGINT: {
+            long long val = strtoll(begin, &end, 10);
+            if (end == begin || *end != '\0' || errno != 0) {
+                return false;
+            }
+            *(long long*)dest = val;
+            return true;
+        }
+        case TYPE_FLOAT: {
+            double val = strtod(begin, &end);
+            if (end == begin || *end != '\0' || errno != 0) {
+                return false;
+            }
+            *(double*)dest = val;
+            return true;
+        }
+        case TYPE_STRING: {
+            if (static_cast<int>(field.size()) > col.len) {
+                return false;
+            }
+            memset(dest, 0, col.len);
+            memcpy(dest, field.data(), field.size());
+            return true;
+        }
+        case TYPE_DATETIME: {
+            uint16_t y;
+            uint8_t month, d, h, m, s;
+            char extra;
+            if (sscanf(begin, "%hu-%hhu-%hhu %hhu:%hhu:%hhu%c", &y, &month, &d, &h, &m, &s, &extra) != 6 ||
+                month < 1 || month > 12 || d < 1 || h > 23 || m > 59 || s > 59) {
+                return false;
+            }
+            DateTime date_time(y, month, d, h, m, s);
+            if (!date_time.valid()) {
+                return false;
+            }
+            *(DateTime*)dest = date_time;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @description: 把一个索引的键值对按键排序，排序后检查唯一性
+ * @param {IndexMeta&} index 索引的元数据
+ * @param {vector<char>&} keys 各记录的键，每个键长col_tot_len，排序后原地替换
+ * @param {vector<Rid>&} rids 与keys一一对应的记录号，排序后原地替换
+ * @return {bool} 存在重复的键时返回false
+ */
+bool SmManager::sort_index_entries(const IndexMeta& index, std::vector<char>& keys, std::vector<Rid>& rids) {
+    std::vector<ColType> col_types;
+    std::vector<int> col_lens;
+    for (auto& col : index.cols) {
+        col_types.push_back(col.type);
+        col_lens.push_back(col.len);
+    }
+    size_t key_len = index.col_tot_len;
+    std::vector<int> order(rids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return ix_compare_keys(&keys[a * key_len], &keys[b * key_len], col_types, col_lens) < 0;
+    });
+    std::vector<char> sorted_keys(keys.size());
+    std::vector<Rid> sorted_rids(rids.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        memcpy(&sorted_keys[i * key_len], &keys[order[i] * key_len], key_len);
+        sorted_rids[i] = rids[order[i]];
+        if (i > 0 && ix_compare_keys(&sorted_keys[(i - 1) * key_len], &sorted_keys[i * key_len], col_types,
+                                     col_lens) == 0) {
+            return false;
+        }
+    }
+    keys = std::move(sorted_keys);
+    rids = std::move(sorted_rids);
+    return true;
+}
+
+/**
+ * @description: 把排好序的键值对写入索引，空索引自底向上建树，否则逐条插入
+ * @param {IxIndexHandle*} ih 索引
+ * @param {IndexMeta&} index 索引的元数据
+ * @param {vector<char>&} keys 已排序的键，每个键长col_tot_len
+ * @param {vector<Rid>&} rids 与keys一一对应的记录号
+ * @param {Context*} context
+ */
+void SmManager::load_index_entries(IxIndexHandle* ih, const IndexMeta& index, const std::vector<char>& keys,
+                                   const std::vector<Rid>& rids, Context* context) {
+    if (ih->bulk_load(keys.data(), rids.data(), static_cast<int>(rids.size()))) {
+        return;
+    }
+    for (size_t i = 0; i < rids.size(); i++) {
+        ih->insert_entry(&keys[i * index.col_tot_len], rids[i], context->txn_);
+    }
+}
+
+/**
+ * @description: 从CSV文件批量导入记录。逐行读取并解析，记录直接写入新分配的页面；全部写入后，
+ * 每个索引的键排序并检查唯一性，空索引自底向上建树。导入不写事务的写记录，失败时自行删除已导入的记录，
+ * 因此不能在显式事务中执行
+ * @param {string&} file_name CSV文件的路径，第一行是列名时跳过
+ * @param {string&} tab_name 表名
+ * @param {Context*} context
+ */
+void SmManager::load_data(const std::string& file_name, const std::string& tab_name, Context* context) {
+    TabMeta& tab = db_.get_table(tab_name);
+    if (context->txn_->get_txn_mode()) {
+        throw LoadDataError(file_name, "LOAD cannot run inside a transaction");
+    }
+    std::ifstream in(file_name);
+    if (!in.is_open()) {
+        throw FileNotFoundError(file_name);
+    }
+    auto fh = fhs_.at(tab_name).get();
+    context->lock_mgr_->lock_exclusive_on_table(context->txn_, fh->GetFd());
+
+    std::vector<IxIndexHandle*> ihs;
+    for (auto& index : tab.indexes) {
+        ihs.push_back(ihs_.at(ix_manager_->get_index_name(tab_name, index.cols)).get());
+    }
+    // 导入过程中收集每个索引的键，记录全部写入后再排序建树
+    std::vector<std::vector<char>> keys(tab.indexes.size());
+    std::vector<Rid> rids;
+    // 出错时删除已导入的记录，表恢复原状
+    auto remove_loaded = [&]() {
+        for (auto& rid : rids) {
+            fh->delete_record(rid, nullptr);
+        }
+    };
+
+    RmRecord rec(fh->get_file_hdr().record_size);
+    std::string line;
+    std::vector<std::string> fields;
+    int line_no = 0;
+    try {
+        RmBulkInserter inserter(fh);
+        while (std::getline(in, line)) {
+            line_no++;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            split_csv_line(line, fields);
+            if (fields.size() != tab.cols.size()) {
+                throw LoadDataError(file_name, line_no, "expected " + std::to_string(tab.cols.size()) + " fields, got " +
+                                                            std::to_string(fields.size()));
+            }
+            if (line_no == 1 && std::equal(fields.begin(), fields.end(), tab.cols.begin(),
+                                           [](const std::string& field, const ColMeta& col) {
+                                               return strcasecmp(field.c_str(), col.name.c_str()) == 0;
+                                           })) {
+                continue;
+            }
+            for (size_t i = 0; i < fields.size(); i++) {
+                if (!parse_csv_field(fields[i], tab.cols[i], rec.data + tab.cols[i].offset)) {
+                    throw LoadDataError(file_name, line_no,
+                                        "invalid value '" + fields[i] + "' for column " + tab.cols[i].name);
+                }
+            }
+            rids.push_back(inserter.insert(rec.data));
+            for (size_t i = 0; i < tab.indexes.size(); i++) {
+                for (auto& col : tab.indexes[i].cols) {
+                    keys[i].insert(keys[i].end(), rec.data + col.offset, rec.data + col.offset + col.len);
+                }
+            }
+        }
+    } catch (...) {
+        remove_loaded();
+        throw;
+    }
+
+    // 先检查所有索引的唯一性，都通过后才修改索引，出错时只需删除记录
+    std::vector<std::vector<Rid>> index_rids(tab.indexes.size(), rids);
+    for (size_t i = 0; i < tab.indexes.size(); i++) {
+        auto& index = tab.indexes[i];
+        bool unique = sort_index_entries(index, keys[i], index_rids[i]);
+        if (unique && !ihs[i]->is_empty_tree()) {
+            std::vector<Rid> result;
+            for (size_t j = 0; unique && j < rids.size(); j++) {
+                unique = !ihs[i]->get_value(&keys[i][j * index.col_tot_len], &result, context->txn_);
+            }
+        }
+        if (!unique) {
+            remove_loaded();
+            throw InternalError("Non-Unique Index!");
+        }
+    }
+    for (size_t i = 0; i < tab.indexes.size(); i++) {
+        load_index_entries(ihs[i], tab.indexes[i], keys[i], index_rids[i], context);
+        std::vector<char>().swap(keys[i]);
+        std::vector<Rid>().swap(index_rids[i]);
+    }
+}
@@ -68,15 +68,29 @@ class SmManager {
 
     void desc_table(const std::string& tab_name, Context* context);
 
-    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
+    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                      RmPageFormat format = RM_FORMAT_FIXED, bool compressed = false);
 
     void drop_table(const std::string& tab_name, Context* context);
 
     void show_index(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void show_buffer_stats(Context* context);
+
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      int fill_percent = IX_BULK_LOAD_FILL_PERCENT);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+    void load_data(const std::string& file_name, const std::string& tab_name, Context* context);
+
+   private:
+    static std::vector<RmZoneCol> zone_map_cols(const TabMeta& tab);
+
+    bool sort_index_entries(const IndexMeta& index, std::vector<char>& keys, std::vector<Rid>& rids);
+
+    void load_index_entries(IxIndexHandle* ih, const IndexMeta& index, const std::vector<char>& keys,
+                            const std::vector<Rid>& rids, Context* context);
 };
\ No newline at end of file
@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <map>
 #include <string>
@@ -46,6 +47,15 @@ struct IndexMeta {
     int col_num;                    // 索引字段数量
     std::vector<ColMeta> cols;      // 索引包含的字段
 
+    /* 按索引字段的顺序从记录rec中取出各字段，拼成长度为col_tot_len的键写入key */
+    void get_key(const char *rec, char *key) const {
+        int offset = 0;
+        for (auto &col : cols) {
+            memcpy(key + offset, rec + col.offset, col.len);
+            offset += col.len;
+        }
+    }
+
     friend std::ostream &operator<<(std::ostream &os, const IndexMeta &index) {
         os << index.tab_name << " " << index.col_tot_len << " " << index.col_num;
         for(auto& col: index.cols) {